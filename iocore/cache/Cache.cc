@@ -38,6 +38,7 @@
 #include "ts/hugepages.h"
 
 const VersionNumber CACHE_DB_VERSION(CACHE_DB_MAJOR_VERSION, CACHE_DB_MINOR_VERSION);
+const VersionNumber CACHE_DOC_VERSION(CACHE_DB_MAJOR_VERSION, CACHE_DOC_MINOR_VERSION);
 
 // Compilation Options
 #define USELESS_REENABLES // allow them for now
@@ -80,6 +81,11 @@ int cache_config_read_while_writer             = 0;
 int cache_config_mutex_retry_delay             = 2;
 int cache_read_while_writer_retry_delay        = 50;
 int cache_config_read_while_writer_max_retries = 10;
+int cache_config_admission_min_hits            = 0;
+int cache_config_admission_sketch_entries      = 262144;
+int cache_config_incremental_open              = 0;
+int cache_config_agg_write_size                = AGG_HIGH_WATER;
+int cache_config_read_ahead_fragments          = 0;
 static int enable_cache_empty_http_doc         = 0;
 /// Fix up a specific known problem with the 4.2.0 release.
 /// Not used for stripes with a cache version later than 4.2.0.
@@ -93,6 +99,7 @@ Cache *theCache                     = nullptr;
 CacheDisk **gdisks                  = nullptr;
 int gndisks                         = 0;
 static volatile int initialize_disk = 0;
+static ink_mutex vol_init_mutex     = PTHREAD_MUTEX_INITIALIZER;
 Cache *caches[NUM_CACHE_FRAG_TYPES] = {nullptr};
 CacheSync *cacheDirSync             = nullptr;
 Store theCacheStore;
@@ -118,11 +125,23 @@ struct VolInitInfo {
   off_t recover_pos;
   AIOCallbackInternal vol_aio[4];
   char *vol_h_f;
+  // directory read pipeline, see Vol::read_dir
+  AIOCallbackInternal dir_aio[DIR_READ_CHUNKS_IN_FLIGHT];
+  off_t dir_pos;
+  int dir_chunks;
+  volatile int dir_next_chunk;
+  volatile int dir_reads_pending;
+  volatile int dir_read_error;
 
   VolInitInfo()
   {
-    recover_pos = 0;
-    vol_h_f     = (char *)ats_memalign(ats_pagesize(), 4 * STORE_BLOCK_SIZE);
+    recover_pos       = 0;
+    vol_h_f           = (char *)ats_memalign(ats_pagesize(), 4 * STORE_BLOCK_SIZE);
+    dir_pos           = 0;
+    dir_chunks        = 0;
+    dir_next_chunk    = 0;
+    dir_reads_pending = 0;
+    dir_read_error    = 0;
     memset(vol_h_f, 0, 4 * STORE_BLOCK_SIZE);
   }
 
@@ -132,11 +151,14 @@ struct VolInitInfo {
       i.action = nullptr;
       i.mutex.clear();
     }
+    for (auto &i : dir_aio) {
+      i.action = nullptr;
+      i.mutex.clear();
+    }
     free(vol_h_f);
   }
 };
 
-#if AIO_MODE == AIO_MODE_NATIVE
 struct VolInit : public Continuation {
   Vol *vol;
   char *path;
@@ -159,6 +181,7 @@ struct VolInit : public Continuation {
   }
 };
 
+#if AIO_MODE == AIO_MODE_NATIVE
 struct DiskInit : public Continuation {
   CacheDisk *disk;
   char *s;
@@ -461,6 +484,12 @@ CacheVC::set_http_info(CacheHTTPInfo *ainfo)
   } else {
     f.allow_empty_doc = 0;
   }
+  // Readers share the alternate's heaps once it is in the write vector,
+  // compact them while the writer is the only user.
+  ainfo->compact_str_heaps();
+  if (ainfo->request_get()->valid() && ainfo->response_get()->valid()) {
+    ainfo->vary_signature_set(HttpTransactCache::calculate_vary_signature(ainfo->request_get(), ainfo->response_get()));
+  }
   alternate.copy_shallow(ainfo);
   ainfo->clear();
 }
@@ -679,6 +708,7 @@ CacheProcessor::start_internal(int flags)
           gdisks[gndisks]->read_only_p = true;
         }
         gdisks[gndisks]->forced_volume_num = sd->forced_volume_num;
+        gdisks[gndisks]->io_size           = sd->io_size;
         if (sd->hash_base_string) {
           gdisks[gndisks]->hash_base_string = ats_strdup(sd->hash_base_string);
         }
@@ -868,6 +898,21 @@ CacheProcessor::diskInitialized()
   }
 }
 
+// A RAM cache using the configured algorithm
+static RamCache *
+new_RamCache_from_config()
+{
+  switch (cache_config_ram_cache_algorithm) {
+  default:
+  case RAM_CACHE_ALGORITHM_CLFUS:
+    return new_RamCacheCLFUS();
+  case RAM_CACHE_ALGORITHM_LRU:
+    return new_RamCacheLRU();
+  case RAM_CACHE_ALGORITHM_TINYLFU:
+    return new_RamCacheTinyLFU();
+  }
+}
+
 void
 CacheProcessor::cacheInitialized()
 {
@@ -944,17 +989,14 @@ CacheProcessor::cacheInitialized()
     int64_t ram_cache_bytes = 0;
 
     if (gnvol) {
+      cache_tier_init();
       // new ram_caches, with algorithm from the config
       for (i = 0; i < gnvol; i++) {
-        switch (cache_config_ram_cache_algorithm) {
-        default:
-        case RAM_CACHE_ALGORITHM_CLFUS:
-          gvol[i]->ram_cache = new_RamCacheCLFUS();
-          break;
-        case RAM_CACHE_ALGORITHM_LRU:
-          gvol[i]->ram_cache = new_RamCacheLRU();
-          break;
+        if (cache_config_admission_min_hits > 1 || gvol[i]->tier_vol) {
+          gvol[i]->sketch = new CacheFrequencySketch;
+          gvol[i]->sketch->init(cache_config_admission_sketch_entries);
         }
+        gvol[i]->ram_cache = new_RamCache_from_config();
       }
       // let us calculate the Size
       if (cache_config_ram_cache_size == AUTO_SIZE_RAM_CACHE) {
@@ -1218,7 +1260,12 @@ vol_clear_init(Vol *d)
 {
   size_t dir_len = vol_dirlen(d);
   memset(d->raw_dir, 0, dir_len);
+  memset(d->dir_dirty, DIR_DIRTY_BOTH, d->segments);
   vol_init_dir(d);
+  cache_l0_invalidate_all();
+  if (d->tier_keys) {
+    memset(d->tier_keys, 0, (d->tier_mask + 1) * sizeof(uint64_t));
+  }
   d->header->magic             = VOL_MAGIC;
   d->header->version.ink_major = CACHE_DB_MAJOR_VERSION;
   d->header->version.ink_minor = CACHE_DB_MINOR_VERSION;
@@ -1310,8 +1357,30 @@ Vol::init(char *s, off_t blocks, off_t dir_skip, bool clear)
   header = (VolHeaderFooter *)raw_dir;
   footer = (VolHeaderFooter *)(raw_dir + vol_dirlen(this) - ROUND_TO_STORE_BLOCK(sizeof(VolHeaderFooter)));
 
+  // Write the aggregation buffer once it holds this much, rounded up to the
+  // device's optimal write size and no more than AGG_SIZE.
+  agg_write_size = cache_config_agg_write_size;
+  for (ConfigVol *cv = config_volumes.cp_queue.head; cv && cache_vol; cv = cv->link.next) {
+    if (cv->number == cache_vol->vol_number && cv->agg_write_size) {
+      agg_write_size = cv->agg_write_size;
+    }
+  }
+  if (disk->io_size > 0 && disk->io_size <= AGG_SIZE) {
+    agg_write_size = ((agg_write_size + disk->io_size - 1) / disk->io_size) * disk->io_size;
+  }
+  agg_write_size = std::max(std::min(agg_write_size, AGG_SIZE), STORE_BLOCK_SIZE);
+  Debug("cache_init", "stripe %s writes %d byte aggregation buffers", hash_text.get(), agg_write_size);
+
+  // neither copy on disk is known to match until it has been written once
+  ats_free(dir_dirty);
+  dir_dirty = (uint8_t *)ats_malloc(segments);
+  memset(dir_dirty, DIR_DIRTY_BOTH, segments);
+  ats_free(dir_seq);
+  dir_seq = (uint32_t *)ats_calloc(segments, sizeof(uint32_t));
+
   if (clear) {
     Note("clearing cache directory '%s'", hash_text.get());
+    cache->vol_header_read(CACHE_DB_VERSION);
     return clear_dir();
   }
 
@@ -1378,6 +1447,58 @@ Vol::handle_dir_clear(int event, void *data)
   return EVENT_DONE;
 }
 
+/* The directory is read in DIR_READ_CHUNK_SIZE pieces, with up to
+   DIR_READ_CHUNKS_IN_FLIGHT of them queued at once so that all the AIO
+   threads of the disk work on it, rather than one of them reading a
+   multi-gigabyte directory with a single pread. Completions may run
+   concurrently (native AIO doesn't take the volume lock), so the chunks
+   are handed out and counted atomically. The reader holds one reference
+   on dir_reads_pending until every read has been issued. */
+int
+Vol::read_dir(off_t pos)
+{
+  init_info->dir_pos           = pos;
+  init_info->dir_chunks        = (vol_dirlen(this) + DIR_READ_CHUNK_SIZE - 1) / DIR_READ_CHUNK_SIZE;
+  init_info->dir_next_chunk    = 0;
+  init_info->dir_reads_pending = 1;
+  init_info->dir_read_error    = 0;
+
+  SET_HANDLER(&Vol::handle_dir_read);
+  for (auto &i : init_info->dir_aio) {
+    AIOCallback *op      = &i;
+    op->aiocb.aio_fildes = fd;
+    op->action           = this;
+    op->thread           = AIO_CALLBACK_THREAD_ANY;
+    op->then             = nullptr;
+    ink_atomic_increment(&init_info->dir_reads_pending, 1);
+    if (!read_dir_chunk(op)) {
+      ink_atomic_increment(&init_info->dir_reads_pending, -1);
+      break;
+    }
+  }
+  if (ink_atomic_increment(&init_info->dir_reads_pending, -1) == 1) {
+    return handle_dir_read(EVENT_IMMEDIATE, nullptr);
+  }
+  return EVENT_DONE;
+}
+
+// Issue the next unread chunk of the directory on op, false if there is none.
+bool
+Vol::read_dir_chunk(AIOCallback *op)
+{
+  int chunk = ink_atomic_increment(&init_info->dir_next_chunk, 1);
+
+  if (chunk >= init_info->dir_chunks) {
+    return false;
+  }
+  off_t offset         = (off_t)chunk * DIR_READ_CHUNK_SIZE;
+  op->aiocb.aio_buf    = raw_dir + offset;
+  op->aiocb.aio_nbytes = std::min((size_t)DIR_READ_CHUNK_SIZE, vol_dirlen(this) - offset);
+  op->aiocb.aio_offset = init_info->dir_pos + offset;
+  ink_assert(ink_aio_read(op));
+  return true;
+}
+
 int
 Vol::handle_dir_read(int event, void *data)
 {
@@ -1385,10 +1506,18 @@ Vol::handle_dir_read(int event, void *data)
 
   if (event == AIO_EVENT_DONE) {
     if ((size_t)op->aio_result != (size_t)op->aiocb.aio_nbytes) {
-      clear_dir();
+      init_info->dir_read_error = 1;
+    } else if (!init_info->dir_read_error && read_dir_chunk(op)) {
+      return EVENT_DONE;
+    }
+    if (ink_atomic_increment(&init_info->dir_reads_pending, -1) != 1) {
       return EVENT_DONE;
     }
   }
+  if (init_info->dir_read_error) {
+    clear_dir();
+    return EVENT_DONE;
+  }
 
   if (!(header->magic == VOL_MAGIC && footer->magic == VOL_MAGIC &&
         CACHE_DB_MAJOR_VERSION_COMPATIBLE <= header->version.ink_major && header->version.ink_major <= CACHE_DB_MAJOR_VERSION)) {
@@ -1737,6 +1866,7 @@ Vol::handle_header_read(int event, void *data)
       ink_assert(op != nullptr);
       i = (VolHeaderFooter *)(op->aiocb.aio_buf);
       if ((size_t)op->aio_result != (size_t)op->aiocb.aio_nbytes) {
+        cache->vol_header_read(CACHE_DB_VERSION);
         clear_dir();
         return EVENT_DONE;
       }
@@ -1744,31 +1874,28 @@ Vol::handle_header_read(int event, void *data)
     }
 
     io.aiocb.aio_fildes = fd;
-    io.aiocb.aio_nbytes = vol_dirlen(this);
-    io.aiocb.aio_buf    = raw_dir;
     io.action           = this;
     io.thread           = AIO_CALLBACK_THREAD_ANY;
     io.then             = nullptr;
 
     if (hf[0]->sync_serial == hf[1]->sync_serial &&
         (hf[0]->sync_serial >= hf[2]->sync_serial || hf[2]->sync_serial != hf[3]->sync_serial)) {
-      SET_HANDLER(&Vol::handle_dir_read);
       if (is_debug_tag_set("cache_init")) {
         Note("using directory A for '%s'", hash_text.get());
       }
-      io.aiocb.aio_offset = skip;
-      ink_assert(ink_aio_read(&io));
+      cache->vol_header_read(hf[0]->version);
+      return read_dir(skip);
     }
     // try B
     else if (hf[2]->sync_serial == hf[3]->sync_serial) {
-      SET_HANDLER(&Vol::handle_dir_read);
       if (is_debug_tag_set("cache_init")) {
         Note("using directory B for '%s'", hash_text.get());
       }
-      io.aiocb.aio_offset = skip + vol_dirlen(this);
-      ink_assert(ink_aio_read(&io));
+      cache->vol_header_read(hf[2]->version);
+      return read_dir(skip + vol_dirlen(this));
     } else {
       Note("no good directory, clearing '%s'", hash_text.get());
+      cache->vol_header_read(CACHE_DB_VERSION);
       clear_dir();
       delete init_info;
       init_info = nullptr;
@@ -1787,15 +1914,8 @@ Vol::dir_init_done(int /* event ATS_UNUSED */, void * /* data ATS_UNUSED */)
     eventProcessor.schedule_in(this, HRTIME_MSECONDS(5), ET_CALL);
     return EVENT_CONT;
   } else {
-    int vol_no = ink_atomic_increment(&gnvol, 1);
-    ink_assert(!gvol[vol_no]);
-    gvol[vol_no] = this;
     SET_HANDLER(&Vol::aggWrite);
-    if (fd == -1) {
-      cache->vol_initialized(false);
-    } else {
-      cache->vol_initialized(true);
-    }
+    cache->vol_initialized(this, fd != -1);
     return EVENT_DONE;
   }
 }
@@ -1837,7 +1957,7 @@ build_vol_hash_table(CacheHostRecord *cp)
   uint64_t used  = 0;
   // initialize number of elements per vol
   for (int i = 0; i < num_vols; i++) {
-    if (DISK_BAD(cp->vols[i]->disk)) {
+    if (DISK_BAD(cp->vols[i]->disk) || cp->vols[i]->recovering) {
       bad_vols++;
       continue;
     }
@@ -1930,14 +2050,109 @@ build_vol_hash_table(CacheHostRecord *cp)
   ats_free(rtable);
 }
 
+// Set up a stripe that finished recovery after its cache was opened, the way
+// CacheProcessor::cacheInitialized does for the others, and give it its
+// share of the volume hash.
+static void
+vol_open_late(Vol *vol)
+{
+  ProxyMutex *mutex  = this_ethread()->mutex.get();
+  int64_t total_size = (theCache ? theCache->cache_size : 0) + (theStreamCache ? theStreamCache->cache_size : 0);
+  int64_t ram_bytes  = vol_dirlen(vol);
+  int64_t disk_bytes = vol->len - vol_dirlen(vol);
+  int64_t direntries = vol->buckets * vol->segments * DIR_DEPTH;
+  int64_t used       = dir_entries_used(vol);
+
+  if (cache_config_admission_min_hits > 1) {
+    vol->sketch = new CacheFrequencySketch;
+    vol->sketch->init(cache_config_admission_sketch_entries);
+  }
+  vol->ram_cache = new_RamCache_from_config();
+  if (cache_config_ram_cache_size == AUTO_SIZE_RAM_CACHE) {
+    vol->ram_cache->init(ram_bytes * DEFAULT_RAM_CACHE_MULTIPLIER, vol);
+  } else {
+    ram_bytes = (int64_t)(cache_config_ram_cache_size * ((double)(vol->len >> STORE_BLOCK_SHIFT) / total_size));
+    vol->ram_cache->init(ram_bytes, vol);
+  }
+
+  CACHE_VOL_SUM_DYN_STAT(cache_ram_cache_bytes_total_stat, ram_bytes);
+  CACHE_VOL_SUM_DYN_STAT(cache_bytes_total_stat, disk_bytes);
+  CACHE_VOL_SUM_DYN_STAT(cache_direntries_total_stat, direntries);
+  CACHE_VOL_SUM_DYN_STAT(cache_direntries_used_stat, used);
+  RecIncrGlobalRawStat(cache_rsb, cache_ram_cache_bytes_total_stat, ram_bytes);
+  RecIncrGlobalRawStat(cache_rsb, cache_bytes_total_stat, disk_bytes);
+  RecIncrGlobalRawStat(cache_rsb, cache_direntries_total_stat, direntries);
+  RecIncrGlobalRawStat(cache_rsb, cache_direntries_used_stat, used);
+
+  rebuild_host_table(vol->cache);
+  Debug("cache_init", "stripe '%s' recovered, now serving from %d of %d stripes", vol->hash_text.get(), vol->cache->total_good_nvol,
+        vol->cache->total_nvol);
+}
+
+/* Called by each stripe once it knows the version of its directory, before
+   reading the rest of it. The URL hash is chosen once for the whole cache
+   from the oldest stripe version, so the cache can only open before every
+   stripe is recovered if none of them needs an older hash. */
 void
-Cache::vol_initialized(bool result)
+Cache::vol_header_read(VersionNumber version)
 {
+  ink_scoped_mutex_lock lock(vol_init_mutex);
+
+  if (version < CACHE_DB_VERSION) {
+    older_stripes = true;
+  }
+  ++total_header_vol;
+}
+
+/* Called by each stripe once its directory has been read and recovered, or
+   cleared. Normally the cache opens when the last stripe is done. With
+   proxy.config.cache.incremental_open it opens as soon as one stripe is
+   usable and the others are added to the volume hash as they come up, so a
+   large cache starts serving hits from its first recovered disks instead of
+   waiting for the slowest one. That needs every stripe header read and all
+   of them current, otherwise the cache still waits for the last stripe.
+   Until the last stripe is up a key can map to a different stripe than it
+   will afterwards, so writes fail and removes are applied to every stripe,
+   see all_stripes_up(). */
+void
+Cache::vol_initialized(Vol *vol, bool result)
+{
+  ink_scoped_mutex_lock lock(vol_init_mutex);
+  int vol_no = gnvol;
+
+  // gvol[0..gnvol) is walked without the lock, fill the slot before
+  // publishing it.
+  ink_assert(!gvol[vol_no]);
+  gvol[vol_no] = vol;
+  __atomic_store_n(&gnvol, vol_no + 1, __ATOMIC_RELEASE);
+  vol->recovering = false;
   if (result) {
     ink_atomic_increment(&total_good_nvol, 1);
   }
-  if (total_nvol == ink_atomic_increment(&total_initialized_vol, 1) + 1) {
-    open_done();
+  int done = ink_atomic_increment(&total_initialized_vol, 1) + 1;
+
+  if (done == total_nvol) {
+    recovered_time = Thread::get_hrtime();
+    Note("%d of %d cache stripes recovered in %" PRId64 " ms", total_good_nvol, total_nvol,
+         (int64_t)ink_hrtime_to_msec(recovered_time - open_time));
+  }
+  if (ready == CACHE_INITIALIZING) {
+    if (done == total_nvol || (cache_config_incremental_open && result && total_header_vol == total_nvol && !older_stripes)) {
+      open_done();
+    }
+  } else if (ready == CACHE_INITIALIZED && result) {
+    // We are on the stripe's own handler, its lock is held.
+    for (const CacheKey &key : recovering_removes) {
+      Dir dir, *last_collision = nullptr;
+      while (dir_probe(&key, vol, &dir, &last_collision)) {
+        dir_delete(&key, vol, &dir);
+        last_collision = nullptr;
+      }
+    }
+    vol_open_late(vol);
+  }
+  if (done == total_nvol) {
+    std::vector<CacheKey>().swap(recovering_removes);
   }
 }
 
@@ -2064,6 +2279,17 @@ AIO_Callback_handler::handle_disk_failure(int /* event ATS_UNUSED */, void *data
 int
 Cache::open_done()
 {
+  CacheHostTable *table = nullptr;
+
+  // Opening early, wait until a stripe of the generic volumes is up.
+  if (total_good_nvol && total_initialized_vol < total_nvol) {
+    table = new CacheHostTable(this, scheme);
+    if (!table->gen_host_rec.vol_hash_table) {
+      delete table;
+      return 0;
+    }
+  }
+
   Action *register_ShowCache(Continuation * c, HTTPHdr * h);
   Action *register_ShowCacheInternal(Continuation * c, HTTPHdr * h);
   statPagesManager.register_http("cache", register_ShowCache);
@@ -2075,7 +2301,7 @@ Cache::open_done()
     return 0;
   }
 
-  hosttable = new CacheHostTable(this, scheme);
+  hosttable = table ? table : new CacheHostTable(this, scheme);
   hosttable->register_config_callback(&hosttable);
 
   if (hosttable->gen_host_rec.num_cachevols == 0) {
@@ -2083,6 +2309,7 @@ Cache::open_done()
   } else {
     ready = CACHE_INITIALIZED;
   }
+  ready_time = Thread::get_hrtime();
 
   // TS-3848
   if (ready == CACHE_INIT_FAILED && cacheProcessor.waitForCache() >= 2) {
@@ -2103,12 +2330,30 @@ Cache::open(bool clear, bool /* fix ATS_UNUSED */)
   total_initialized_vol = 0;
   total_nvol            = 0;
   total_good_nvol       = 0;
+  total_header_vol      = 0;
+  older_stripes         = false;
+  open_time             = Thread::get_hrtime();
 
   REC_EstablishStaticConfigInt32(cache_config_min_average_object_size, "proxy.config.cache.min_average_object_size");
   Debug("cache_init", "Cache::open - proxy.config.cache.min_average_object_size = %d", (int)cache_config_min_average_object_size);
 
+  // Count every stripe before initializing any of them. vol_initialized()
+  // compares against the total, and the first stripes can finish before the
+  // loop below does.
   CacheVol *cp = cp_list.head;
   for (; cp; cp = cp->link.next) {
+    if (cp->scheme == scheme) {
+      for (i = 0; i < gndisks; i++) {
+        if (cp->disk_vols[i] && !DISK_BAD(cp->disk_vols[i]->disk)) {
+          for (DiskVolBlockQueue *q = cp->disk_vols[i]->dpb_queue.head; q; q = q->link.next) {
+            ++total_nvol;
+          }
+        }
+      }
+    }
+  }
+
+  for (cp = cp_list.head; cp; cp = cp->link.next) {
     if (cp->scheme == scheme) {
       cp->vols   = (Vol **)ats_malloc(cp->num_vols * sizeof(Vol *));
       int vol_no = 0;
@@ -2116,26 +2361,24 @@ Cache::open(bool clear, bool /* fix ATS_UNUSED */)
         if (cp->disk_vols[i] && !DISK_BAD(cp->disk_vols[i]->disk)) {
           DiskVolBlockQueue *q = cp->disk_vols[i]->dpb_queue.head;
           for (; q; q = q->link.next) {
-            cp->vols[vol_no]            = new Vol();
-            CacheDisk *d                = cp->disk_vols[i]->disk;
-            cp->vols[vol_no]->disk      = d;
-            cp->vols[vol_no]->fd        = d->fd;
-            cp->vols[vol_no]->cache     = this;
-            cp->vols[vol_no]->cache_vol = cp;
-            blocks                      = q->b->len;
-
+            cp->vols[vol_no]             = new Vol();
+            CacheDisk *d                 = cp->disk_vols[i]->disk;
+            cp->vols[vol_no]->disk       = d;
+            cp->vols[vol_no]->fd         = d->fd;
+            cp->vols[vol_no]->cache      = this;
+            cp->vols[vol_no]->cache_vol  = cp;
+            cp->vols[vol_no]->recovering = true;
+            blocks                       = q->b->len;
+
+            // Each stripe is initialized on an event thread, so stripes
+            // clear or recover their directories in parallel.
             bool vol_clear = clear || d->cleared || q->new_block;
-#if AIO_MODE == AIO_MODE_NATIVE
             eventProcessor.schedule_imm(new VolInit(cp->vols[vol_no], d->path, blocks, q->b->offset, vol_clear));
-#else
-            cp->vols[vol_no]->init(d->path, blocks, q->b->offset, vol_clear);
-#endif
             vol_no++;
             cache_size += blocks;
           }
         }
       }
-      total_nvol += vol_no;
     }
   }
   if (total_nvol == 0) {
@@ -2442,9 +2685,10 @@ CacheVC::handleRead(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
   if (dir_agg_buf_valid(vol, &dir)) {
     int agg_offset = vol_offset(vol, &dir) - vol->header->write_pos;
     buf            = new_IOBufferData(iobuffer_size_to_index(io.aiocb.aio_nbytes, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
-    ink_assert((agg_offset + io.aiocb.aio_nbytes) <= (unsigned)vol->agg_buf_pos);
+    ink_assert((agg_offset + io.aiocb.aio_nbytes) <= (unsigned)(vol->agg_write_len + vol->agg_buf_pos));
     char *doc = buf->data();
-    char *agg = vol->agg_buffer + agg_offset;
+    char *agg = agg_offset < vol->agg_write_len ? vol->agg_write_buffer + agg_offset :
+                                                  vol->agg_buffer + agg_offset - vol->agg_write_len;
     memcpy(doc, agg, io.aiocb.aio_nbytes);
     io.aio_result = io.aiocb.aio_nbytes;
     SET_HANDLER(&CacheVC::handleReadDone);
@@ -2591,24 +2835,14 @@ Lfree:
   return free_CacheVC(this);
 }
 
-Action *
-Cache::remove(Continuation *cont, const CacheKey *key, CacheFragType type, const char *hostname, int host_len)
+// Start removing key from vol, cont gets the result.
+static Action *
+vol_remove(Continuation *cont, const CacheKey *key, CacheFragType type, Vol *vol)
 {
-  if (!CacheProcessor::IsCacheReady(type)) {
-    if (cont) {
-      cont->handleEvent(CACHE_EVENT_REMOVE_FAILED, nullptr);
-    }
-    return ACTION_RESULT_DONE;
-  }
-
   Ptr<ProxyMutex> mutex;
-  if (!cont) {
-    cont = new_CacheRemoveCont();
-  }
 
   CACHE_TRY_LOCK(lock, cont->mutex, this_ethread());
   ink_assert(lock.is_locked());
-  Vol *vol = key_to_vol(key, hostname, host_len);
   // coverity[var_decl]
   Dir result;
   dir_clear(&result); // initialized here, set result empty so we can recognize missed lock
@@ -2632,6 +2866,56 @@ Cache::remove(Continuation *cont, const CacheKey *key, CacheFragType type, const
     return &c->_action;
   }
 }
+
+Action *
+Cache::remove(Continuation *cont, const CacheKey *key, CacheFragType type, const char *hostname, int host_len)
+{
+  if (!CacheProcessor::IsCacheReady(type)) {
+    if (cont) {
+      cont->handleEvent(CACHE_EVENT_REMOVE_FAILED, nullptr);
+    }
+    return ACTION_RESULT_DONE;
+  }
+
+  if (!cont) {
+    cont = new_CacheRemoveCont();
+  }
+
+  // Checked before the lookup, a stripe joining in between must be covered.
+  bool recovering = !all_stripes_up();
+  Vol *vol        = key_to_vol(key, hostname, host_len);
+  if (recovering) {
+    remove_recovering(key, type, vol);
+  }
+  return vol_remove(cont, key, type, vol);
+}
+
+/* A remove while some stripes are still recovering. Once they are up the key
+   may map to any other stripe, and the copy from before the restart there
+   would be served again. So also remove it from every other stripe that is
+   up, and have the ones still recovering drop it before they join, see
+   vol_initialized(). Nothing new can have been written to another stripe in
+   the meantime, open_write() fails until all stripes are up. */
+void
+Cache::remove_recovering(const CacheKey *key, CacheFragType type, Vol *skip)
+{
+  int nvol;
+
+  {
+    ink_scoped_mutex_lock lock(vol_init_mutex);
+    if (!all_stripes_up()) {
+      recovering_removes.push_back(*key);
+    }
+    nvol = gnvol;
+  }
+
+  for (int i = 0; i < nvol; i++) {
+    Vol *vol = gvol[i];
+    if (vol != skip && vol->cache == this && vol->fd != -1) {
+      vol_remove(new_CacheRemoveCont(), key, type, vol);
+    }
+  }
+}
 // CacheVConnection
 
 CacheVConnection::CacheVConnection() : VConnection(nullptr)
@@ -3135,6 +3419,11 @@ register_cache_stats(RecRawStatBlock *rsb, const char *prefix)
   REG_INT("ram_cache.bytes_used", cache_ram_cache_bytes_stat);
   REG_INT("ram_cache.hits", cache_ram_cache_hits_stat);
   REG_INT("ram_cache.misses", cache_ram_cache_misses_stat);
+  REG_INT("ram_cache.l0_hits", cache_l0_hits_stat);
+  REG_INT("ram_cache.l0_misses", cache_l0_misses_stat);
+  REG_INT("tier.promotions", cache_tier_promotions_stat);
+  REG_INT("tier.reads", cache_tier_reads_stat);
+  REG_INT("tier.fallbacks", cache_tier_fallbacks_stat);
   REG_INT("pread_count", cache_pread_count_stat);
   REG_INT("percent_full", cache_percent_full_stat);
   REG_INT("lookup.active", cache_lookup_active_stat);
@@ -3147,6 +3436,7 @@ register_cache_stats(RecRawStatBlock *rsb, const char *prefix)
   REG_INT("write.success", cache_write_success_stat);
   REG_INT("write.failure", cache_write_failure_stat);
   REG_INT("write.backlog.failure", cache_write_backlog_failure_stat);
+  REG_INT("write.not_admitted", cache_write_not_admitted_stat);
   REG_INT("update.active", cache_update_active_stat);
   REG_INT("update.success", cache_update_success_stat);
   REG_INT("update.failure", cache_update_failure_stat);
@@ -3159,6 +3449,9 @@ register_cache_stats(RecRawStatBlock *rsb, const char *prefix)
   REG_INT("scan.active", cache_scan_active_stat);
   REG_INT("scan.success", cache_scan_success_stat);
   REG_INT("scan.failure", cache_scan_failure_stat);
+  REG_INT("read_ahead.active", cache_read_ahead_active_stat);
+  REG_INT("read_ahead.success", cache_read_ahead_success_stat);
+  REG_INT("read_ahead.failure", cache_read_ahead_failure_stat);
   REG_INT("direntries.total", cache_direntries_total_stat);
   REG_INT("direntries.used", cache_direntries_used_stat);
   REG_INT("directory_collision", cache_directory_collision_count_stat);
@@ -3167,6 +3460,7 @@ register_cache_stats(RecRawStatBlock *rsb, const char *prefix)
   REG_INT("frags_per_doc.3+", cache_three_plus_plus_fragment_document_count_stat);
   REG_INT("read_busy.success", cache_read_busy_success_stat);
   REG_INT("read_busy.failure", cache_read_busy_failure_stat);
+  REG_INT("read.lockless_misses", cache_read_lockless_miss_stat);
   REG_INT("write_bytes_stat", cache_write_bytes_stat);
   REG_INT("vector_marshals", cache_hdr_vector_marshal_stat);
   REG_INT("hdr_marshals", cache_hdr_marshal_stat);
@@ -3177,6 +3471,9 @@ register_cache_stats(RecRawStatBlock *rsb, const char *prefix)
   REG_INT("sync.count", cache_directory_sync_count_stat);
   REG_INT("sync.bytes", cache_directory_sync_bytes_stat);
   REG_INT("sync.time", cache_directory_sync_time_stat);
+  REG_INT("agg_write.count", cache_agg_write_count_stat);
+  REG_INT("agg_write.bytes", cache_agg_write_bytes_stat);
+  REG_INT("agg_write.stalls", cache_agg_write_stall_stat);
   REG_INT("span.errors.read", cache_span_errors_read_stat);
   REG_INT("span.errors.write", cache_span_errors_write_stat);
   REG_INT("span.failing", cache_span_failing_stat);
@@ -3199,6 +3496,16 @@ ink_cache_init(ModuleVersion v)
   REC_EstablishStaticConfigInt32(cache_config_ram_cache_compress, "proxy.config.cache.ram_cache.compress");
   REC_EstablishStaticConfigInt32(cache_config_ram_cache_compress_percent, "proxy.config.cache.ram_cache.compress_percent");
   REC_ReadConfigInt32(cache_config_ram_cache_use_seen_filter, "proxy.config.cache.ram_cache.use_seen_filter");
+  REC_ReadConfigInt32(cache_config_ram_cache_l0_entries, "proxy.config.cache.ram_cache.l0_entries");
+  REC_ReadConfigInt32(cache_config_ram_cache_l0_cutoff, "proxy.config.cache.ram_cache.l0_cutoff");
+  cache_l0_init();
+
+  REC_ReadConfigInt32(cache_config_admission_min_hits, "proxy.config.cache.admission.min_hits");
+  REC_ReadConfigInt32(cache_config_admission_sketch_entries, "proxy.config.cache.admission.sketch_entries");
+  REC_ReadConfigInt32(cache_config_tier_volume, "proxy.config.cache.tier.volume");
+  REC_ReadConfigInt32(cache_config_tier_promote_hits, "proxy.config.cache.tier.promote_hits");
+  REC_ReadConfigInt32(cache_config_incremental_open, "proxy.config.cache.incremental_open");
+  REC_ReadConfigInt32(cache_config_agg_write_size, "proxy.config.cache.agg_write_size");
 
   REC_EstablishStaticConfigInt32(cache_config_http_max_alts, "proxy.config.cache.limits.http.max_alts");
   Debug("cache_init", "proxy.config.cache.limits.http.max_alts = %d", cache_config_http_max_alts);
@@ -3229,6 +3536,9 @@ ink_cache_init(ModuleVersion v)
   REC_EstablishStaticConfigInt32(cache_read_while_writer_retry_delay, "proxy.config.cache.read_while_writer_retry.delay");
   Debug("cache_init", "proxy.config.cache.read_while_writer_retry.delay = %dms", cache_read_while_writer_retry_delay);
 
+  REC_EstablishStaticConfigInt32(cache_config_read_ahead_fragments, "proxy.config.cache.read_ahead_fragments");
+  Debug("cache_init", "proxy.config.cache.read_ahead_fragments = %d", cache_config_read_ahead_fragments);
+
   REC_EstablishStaticConfigInt32(cache_config_hit_evacuate_percent, "proxy.config.cache.hit_evacuate_percent");
   Debug("cache_init", "proxy.config.cache.hit_evacuate_percent = %d", cache_config_hit_evacuate_percent);
 
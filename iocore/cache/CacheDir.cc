@@ -209,15 +209,47 @@ dir_bucket_loop_check(Dir *start_dir, Dir *seg)
   return 1;
 }
 
+// Segment s changed, so both directory copies on disk need it rewritten.
+static inline void
+dir_segment_dirty(int s, Vol *d)
+{
+  d->dir_dirty[s] = DIR_DIRTY_BOTH;
+}
+
+// Keeps Vol::dir_seq of segment s odd while in scope, so a dir_may_contain
+// that read the segment meanwhile doesn't trust what it saw. Only the
+// outermost of nested guards counts.
+struct DirSegmentWrite {
+  uint32_t *seq = nullptr;
+
+  DirSegmentWrite(int s, Vol *d)
+  {
+    uint32_t v = d->dir_seq[s];
+    if (!(v & 1)) {
+      seq = &d->dir_seq[s];
+      __atomic_store_n(seq, v + 1, __ATOMIC_RELAXED);
+      __atomic_thread_fence(__ATOMIC_RELEASE);
+    }
+  }
+  ~DirSegmentWrite()
+  {
+    if (seq) {
+      __atomic_store_n(seq, *seq + 1, __ATOMIC_RELEASE);
+    }
+  }
+};
+
 // adds all the directory entries
 // in a segment to the segment freelist
 void
 dir_init_segment(int s, Vol *d)
 {
+  DirSegmentWrite guard(s, d);
   d->header->freelist[s] = 0;
   Dir *seg               = dir_segment(s, d);
   int l, b;
   memset(seg, 0, SIZEOF_DIR * DIR_DEPTH * d->buckets);
+  dir_segment_dirty(s, d);
   for (l = 1; l < DIR_DEPTH; l++) {
     for (b = 0; b < d->buckets; b++) {
       Dir *bucket = dir_bucket(b, seg);
@@ -317,9 +349,11 @@ unlink_from_freelist(Dir *e, int s, Vol *d)
 inline Dir *
 dir_delete_entry(Dir *e, Dir *p, int s, Vol *d)
 {
+  DirSegmentWrite guard(s, d);
   Dir *seg         = dir_segment(s, d);
   int no           = dir_next(e);
   d->header->dirty = 1;
+  dir_segment_dirty(s, d);
   if (p) {
     unsigned int fo = d->header->freelist[s];
     unsigned int eo = dir_to_offset(e, seg);
@@ -401,6 +435,7 @@ dir_clear_range(off_t start, off_t end, Vol *vol)
   for (off_t i = 0; i < vol->buckets * DIR_DEPTH * vol->segments; i++) {
     Dir *e = dir_index(vol, i);
     if (!dir_token(e) && dir_offset(e) >= (int64_t)start && dir_offset(e) < (int64_t)end) {
+      DirSegmentWrite guard(i / (vol->buckets * DIR_DEPTH), vol);
       CACHE_DEC_DIR_USED(vol->mutex);
       dir_set_offset(e, 0); // delete
     }
@@ -429,6 +464,7 @@ freelist_clean(int s, Vol *vol)
     return;
   }
   Warning("cache directory overflow on '%s' segment %d, purging...", vol->path, s);
+  DirSegmentWrite guard(s, vol);
   int n    = 0;
   Dir *seg = dir_segment(s, vol);
   for (int bi = 0; bi < vol->buckets; bi++) {
@@ -522,6 +558,7 @@ dir_segment_accounted(int s, Vol *d, int offby, int *f, int *u, int *et, int *v,
 void
 dir_free_entry(Dir *e, int s, Vol *d)
 {
+  DirSegmentWrite guard(s, d);
   Dir *seg        = dir_segment(s, d);
   unsigned int fo = d->header->freelist[s];
   unsigned int eo = dir_to_offset(e, seg);
@@ -530,6 +567,7 @@ dir_free_entry(Dir *e, int s, Vol *d)
     dir_set_prev(dir_from_offset(fo, seg), eo);
   }
   d->header->freelist[s] = eo;
+  dir_segment_dirty(s, d);
 }
 
 int
@@ -599,10 +637,80 @@ Lagain:
   return 0;
 }
 
+// Lets a reader that couldn't get the volume lock answer a miss without
+// waiting for it. The bucket chain is walked against Vol::dir_seq (a
+// seqlock), and anything that might need the locked path counts as a
+// possible hit: a writer of the key's open directory bucket, a matching tag
+// (valid or not), a chain that is too long or leads out of the segment, and
+// a segment that changed during the walk.
+bool
+dir_may_contain(const CacheKey *key, Vol *d)
+{
+  int s         = key->slice32(0) % d->segments;
+  int b         = key->slice32(1) % d->buckets;
+  Dir *seg      = dir_segment(s, d);
+  uint32_t *seq = &d->dir_seq[s];
+  bool found    = false;
+
+  if (__atomic_load_n(&d->open_dir.bucket[key->slice32(0) % OPEN_DIR_BUCKETS].head, __ATOMIC_ACQUIRE)) {
+    return true;
+  }
+  uint32_t v = __atomic_load_n(seq, __ATOMIC_ACQUIRE);
+  if (v & 1) {
+    return true;
+  }
+  Dir *e = dir_bucket(b, seg);
+  if (dir_offset(e)) {
+    for (int n = 0; e; n++) {
+      if (n >= DIR_MAY_CONTAIN_LINKS || dir_compare_tag(e, key) || dir_next(e) >= d->buckets * DIR_DEPTH) {
+        found = true;
+        break;
+      }
+      e = next_dir(e, seg);
+    }
+  }
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  return found || __atomic_load_n(seq, __ATOMIC_RELAXED) != v;
+}
+
+// The opposite question for a reader holding a copy of what dir pointed at:
+// is key's entry at that offset and phase still in the directory? Walked
+// the same way as dir_may_contain, but here any doubt counts as no.
+bool
+dir_lookup_lockless(const CacheKey *key, Vol *d, const Dir *dir)
+{
+  int s         = key->slice32(0) % d->segments;
+  int b         = key->slice32(1) % d->buckets;
+  Dir *seg      = dir_segment(s, d);
+  uint32_t *seq = &d->dir_seq[s];
+  bool found    = false;
+
+  uint32_t v = __atomic_load_n(seq, __ATOMIC_ACQUIRE);
+  if (v & 1) {
+    return false;
+  }
+  Dir *e = dir_bucket(b, seg);
+  if (dir_offset(e)) {
+    for (int n = 0; e && n < DIR_MAY_CONTAIN_LINKS; n++) {
+      if (dir_compare_tag(e, key) && dir_offset(e) == dir_offset(dir) && dir_phase(e) == dir_phase(dir)) {
+        found = true;
+        break;
+      }
+      if (dir_next(e) >= d->buckets * DIR_DEPTH) {
+        break;
+      }
+      e = next_dir(e, seg);
+    }
+  }
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  return found && __atomic_load_n(seq, __ATOMIC_RELAXED) == v;
+}
+
 int
 dir_insert(const CacheKey *key, Vol *d, Dir *to_part)
 {
   ink_assert(d->mutex->thread_holding == this_ethread());
+  cache_tier_invalidate(d, key);
   int s  = key->slice32(0) % d->segments, l;
   int bi = key->slice32(1) % d->buckets;
   ink_assert(dir_approx_size(to_part) <= MAX_FRAG_SIZE + sizeof(Doc));
@@ -610,6 +718,7 @@ dir_insert(const CacheKey *key, Vol *d, Dir *to_part)
   Dir *e   = nullptr;
   Dir *b   = dir_bucket(bi, seg);
   Vol *vol = d;
+  DirSegmentWrite guard(s, d);
 #if defined(DEBUG) && defined(DO_CHECK_DIR_FAST)
   unsigned int t = DIR_MASK_TAG(key->slice32(2));
   Dir *col       = b;
@@ -649,6 +758,7 @@ Lfill:
          key->slice32(1), dir_tag(e), dir_offset(e));
   CHECK_DIR(d);
   d->header->dirty = 1;
+  dir_segment_dirty(s, d);
   CACHE_INC_DIR_USED(d->mutex);
   return 1;
 }
@@ -657,6 +767,7 @@ int
 dir_overwrite(const CacheKey *key, Vol *d, Dir *dir, Dir *overwrite, bool must_overwrite)
 {
   ink_assert(d->mutex->thread_holding == this_ethread());
+  cache_tier_invalidate(d, key);
   int s          = key->slice32(0) % d->segments, l;
   int bi         = key->slice32(1) % d->buckets;
   Dir *seg       = dir_segment(s, d);
@@ -669,6 +780,7 @@ dir_overwrite(const CacheKey *key, Vol *d, Dir *dir, Dir *overwrite, bool must_o
   bool loop_possible = true;
 #endif
   Vol *vol = d;
+  DirSegmentWrite guard(s, d);
   CHECK_DIR(d);
 
   ink_assert((unsigned int)dir_approx_size(dir) <= (unsigned int)(MAX_FRAG_SIZE + sizeof(Doc))); // XXX - size should be unsigned
@@ -726,6 +838,7 @@ Lfill:
          bi, e, t, dir_tag(e), dir_offset(e));
   CHECK_DIR(d);
   d->header->dirty = 1;
+  dir_segment_dirty(s, d);
   return res;
 }
 
@@ -733,6 +846,7 @@ int
 dir_delete(const CacheKey *key, Vol *d, Dir *del)
 {
   ink_assert(d->mutex->thread_holding == this_ethread());
+  cache_tier_invalidate(d, key);
   int s    = key->slice32(0) % d->segments;
   int b    = key->slice32(1) % d->buckets;
   Dir *seg = dir_segment(s, d);
@@ -962,24 +1076,25 @@ sync_cache_dir_on_shutdown()
     // recompute hit_evacuate_window
     d->hit_evacuate_window = (d->data_blocks * cache_config_hit_evacuate_percent) / 100;
 
-    // check if we have data in the agg buffer
+    // check if we have data in the agg buffers, the one being written
+    // goes first as the other one follows it on disk
     // dont worry about the cachevc s in the agg queue
     // directories have not been inserted for these writes
-    if (d->agg_buf_pos) {
+    if (d->agg_write_len || d->agg_buf_pos) {
       Debug("cache_dir_sync", "Dir %s: flushing agg buffer first", d->hash_text.get());
 
       // set write limit
-      d->header->agg_pos = d->header->write_pos + d->agg_buf_pos;
+      d->header->agg_pos = d->header->write_pos + d->agg_write_len + d->agg_buf_pos;
 
-      int r = pwrite(d->fd, d->agg_buffer, d->agg_buf_pos, d->header->write_pos);
-      if (r != d->agg_buf_pos) {
+      if (pwrite(d->fd, d->agg_write_buffer, d->agg_write_len, d->header->write_pos) != d->agg_write_len ||
+          pwrite(d->fd, d->agg_buffer, d->agg_buf_pos, d->header->write_pos + d->agg_write_len) != d->agg_buf_pos) {
         ink_assert(!"flusing agg buffer failed");
         continue;
       }
       d->header->last_write_pos = d->header->write_pos;
-      d->header->write_pos += d->agg_buf_pos;
-      ink_assert(d->header->write_pos == d->header->agg_pos);
-      d->agg_buf_pos = 0;
+      d->header->write_pos      = d->header->agg_pos;
+      d->agg_write_len          = 0;
+      d->agg_buf_pos            = 0;
       d->header->write_serial++;
     }
 
@@ -1050,6 +1165,9 @@ Lrestart:
       buf      = nullptr;
       buf_huge = false;
     }
+    ats_free(segments);
+    segments  = nullptr;
+    nsegments = 0;
     Debug("cache_dir_sync", "sync done");
     if (event == EVENT_INTERVAL) {
       trigger = e->ethread->schedule_in(this, HRTIME_SECONDS(cache_config_dir_sync_frequency));
@@ -1065,6 +1183,11 @@ Lrestart:
     // AIO Thread
     if (io.aio_result != (int64_t)io.aiocb.aio_nbytes) {
       Warning("vol write error during directory sync '%s'", gvol[vol_idx]->hash_text.get());
+      // this copy is now incomplete, write all of what it was missing next time
+      SCOPED_MUTEX_LOCK(lock, vol->mutex, mutex->thread_holding);
+      for (int s = 0; s < vol->segments; s++) {
+        vol->dir_dirty[s] |= segments[s] << (vol->header->sync_serial & 1);
+      }
       event = EVENT_NONE;
       goto Ldone;
     }
@@ -1093,6 +1216,7 @@ Lrestart:
 
     int headerlen = ROUND_TO_STORE_BLOCK(sizeof(VolHeaderFooter));
     size_t dirlen = vol_dirlen(vol);
+    int l;
     if (!writepos) {
       // start
       Debug("cache_dir_sync", "sync started");
@@ -1138,7 +1262,29 @@ Lrestart:
       vol->header->sync_serial++;
       vol->footer->sync_serial = vol->header->sync_serial;
       CHECK_DIR(d);
-      memcpy(buf, vol->raw_dir, dirlen);
+
+      // Only the segments changed since this copy was last written go out,
+      // snapshot them with the header and footer.
+      int B = vol->header->sync_serial & 1;
+      if (nsegments < vol->segments) {
+        ats_free(segments);
+        segments  = (uint8_t *)ats_malloc(vol->segments);
+        nsegments = vol->segments;
+      }
+      int changed = 0;
+      for (int s = 0; s < vol->segments; s++) {
+        segments[s] = (vol->dir_dirty[s] >> B) & 1;
+        vol->dir_dirty[s] &= ~(1 << B);
+        changed += segments[s];
+      }
+      Debug("cache_dir_sync", "Dir %s: %d of %d segments changed since copy %d was written", vol->hash_text.get(), changed,
+            vol->segments, B);
+      while ((l = next_write(vol)) > 0) {
+        memcpy(buf + writepos, vol->raw_dir + writepos, l);
+        writepos += l;
+      }
+      memcpy(buf + dirlen - headerlen, vol->raw_dir + dirlen - headerlen, headerlen);
+      writepos                  = 0;
       vol->dir_sync_in_progress = true;
     }
     size_t B    = vol->header->sync_serial & 1;
@@ -1148,12 +1294,8 @@ Lrestart:
       // write header
       aio_write(vol->fd, buf + writepos, headerlen, start + writepos);
       writepos += headerlen;
-    } else if (writepos < (off_t)dirlen - headerlen) {
+    } else if (writepos < (off_t)dirlen - headerlen && (l = next_write(vol)) > 0) {
       // write part of body
-      int l = SYNC_MAX_WRITE;
-      if (writepos + l > (off_t)dirlen - headerlen) {
-        l = dirlen - headerlen - writepos;
-      }
       aio_write(vol->fd, buf + writepos, l, start + writepos);
       writepos += l;
     } else if (writepos < (off_t)dirlen) {
@@ -1177,6 +1319,44 @@ Ldone:
   goto Lrestart;
 }
 
+/* The part of the directory copy being synced to write next, at or after
+   writepos, which is moved to its start: the rest of the header, then the
+   store blocks covering the segments that changed since this copy was last
+   written, SYNC_MAX_WRITE at a time. Returns 0 with writepos at the footer
+   once there is nothing else.
+
+   The copy is only valid once its footer matches the header written first,
+   so a crash in the middle leaves the other copy to recover from, as with a
+   full write. */
+int
+CacheSync::next_write(Vol *vol)
+{
+  off_t hl       = vol_headerlen(vol);
+  off_t seglen   = (off_t)vol->buckets * DIR_DEPTH * SIZEOF_DIR;
+  off_t body_end = vol_dirlen(vol) - ROUND_TO_STORE_BLOCK(sizeof(VolHeaderFooter));
+  off_t end;
+
+  if (writepos < hl) {
+    end = hl;
+  } else {
+    int s = (writepos - hl) / seglen;
+    while (s < vol->segments && !segments[s]) {
+      s++;
+    }
+    if (s >= vol->segments) {
+      writepos = body_end;
+      return 0;
+    }
+    writepos = std::max(writepos, (off_t)ROUND_DOWN_TO_STORE_BLOCK(hl + s * seglen));
+    while (s < vol->segments && segments[s] && hl + s * seglen < writepos + SYNC_MAX_WRITE) {
+      s++;
+    }
+    end = ROUND_TO_STORE_BLOCK(hl + s * seglen);
+  }
+  end = std::min(end, std::min(writepos + SYNC_MAX_WRITE, body_end));
+  return end - writepos;
+}
+
 namespace
 {
 int
@@ -420,7 +420,8 @@ CacheHostRecord::Init(CacheType typ)
   num_cachevols    = 0;
   CacheVol *cachep = cp_list.head;
   for (; cachep; cachep = cachep->link.next) {
-    if (cachep->scheme == type) {
+    // the fast tier is only reached through promotion, see P_CacheTier.h
+    if (cachep->scheme == type && (cache_config_tier_volume <= 0 || cachep->vol_number != cache_config_tier_volume)) {
       Debug("cache_hosting", "Host Record: %p, Volume: %d, size: %" PRId64, this, cachep->vol_number, (int64_t)cachep->size);
       cp[num_cachevols] = cachep;
       num_cachevols++;
@@ -635,6 +636,7 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
     CacheType scheme  = CACHE_NONE_TYPE;
     int size          = 0;
     int in_percent    = 0;
+    int agg_size      = 0;
 
     while (true) {
       // skip all blank spaces at beginning of line
@@ -722,6 +724,18 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
         } else {
           in_percent = 0;
         }
+      } else if (strcasecmp(tmp, "agg_write_size") == 0) { // match agg_write_size
+        tmp += 15;
+        agg_size = atoi(tmp);
+
+        while (ParseRules::is_digit(*tmp)) {
+          tmp++;
+        }
+
+        if (agg_size <= 0) {
+          err = "Bad agg_write_size";
+          break;
+        }
       }
 
       // ends here
@@ -744,9 +758,10 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
       } else {
         configp->in_percent = false;
       }
-      configp->scheme = scheme;
-      configp->size   = size;
-      configp->cachep = nullptr;
+      configp->scheme         = scheme;
+      configp->size           = size;
+      configp->agg_write_size = agg_size;
+      configp->cachep         = nullptr;
       cp_queue.enqueue(configp);
       num_volumes++;
       if (scheme == CACHE_HTTP_TYPE) {
@@ -0,0 +1,149 @@
+/** @file
+
+  Per thread cache of hot objects in front of the volume RAM cache
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "P_Cache.h"
+
+// An entry that keeps being hit survives this many conflicting inserts
+#define CACHE_L0_MAX_HITS 3
+
+int cache_config_ram_cache_l0_entries = 0;
+int cache_config_ram_cache_l0_cutoff  = 16384;
+static uint32_t cache_l0_generation;
+
+struct CacheL0Entry {
+  CacheKey key;
+  Vol *vol;
+  Dir dir;
+  uint32_t generation;
+  uint32_t hits;
+  Ptr<IOBufferData> data;
+};
+
+static off_t cache_l0_offset = -1;
+static uint32_t cache_l0_mask;
+
+void
+cache_l0_init()
+{
+  int n = 1;
+
+  if (cache_config_ram_cache_l0_entries <= 0) {
+    cache_config_ram_cache_l0_entries = 0;
+    return;
+  }
+  while (n < cache_config_ram_cache_l0_entries) {
+    n <<= 1;
+  }
+  cache_config_ram_cache_l0_entries = n;
+  cache_l0_mask                     = n - 1;
+
+  if ((cache_l0_offset = eventProcessor.allocate(sizeof(CacheL0Entry *))) == -1) {
+    Warning("no per thread space left for the L0 cache, disabling it");
+    cache_config_ram_cache_l0_entries = 0;
+  }
+}
+
+// The slot for key in the calling thread's table, allocating the table on
+// first use. Returns nullptr if the L0 cache is off.
+static CacheL0Entry *
+cache_l0_slot(const CacheKey *key)
+{
+  EThread *t = this_ethread();
+
+  if (cache_l0_offset < 0 || t == nullptr) {
+    return nullptr;
+  }
+
+  CacheL0Entry **table = static_cast<CacheL0Entry **>(ETHREAD_GET_PTR(t, cache_l0_offset));
+  if (*table == nullptr) {
+    *table = new CacheL0Entry[cache_config_ram_cache_l0_entries];
+  }
+  return &(*table)[key->slice32(1) & cache_l0_mask];
+}
+
+// Whether the directory still holds the entry e was read through. For a
+// promoted object e->vol is the fast tier stripe, which must also still be
+// where home sends the key.
+static bool
+cache_l0_valid(CacheL0Entry *e, Vol *home)
+{
+  if (e->generation != __atomic_load_n(&cache_l0_generation, __ATOMIC_ACQUIRE)) {
+    return false;
+  }
+  if (e->vol != home && (!home->tier_keys || __atomic_load_n(cache_tier_slot(home, &e->key), __ATOMIC_ACQUIRE) != e->key.u64[0])) {
+    return false;
+  }
+  return dir_lookup_lockless(&e->key, e->vol, &e->dir);
+}
+
+bool
+cache_l0_get(const CacheKey *key, Vol *vol, Ptr<IOBufferData> &data)
+{
+  CacheL0Entry *e = cache_l0_slot(key);
+
+  // A promoted object is put by its fast tier stripe but looked up by its home
+  if (e == nullptr || !e->data || (e->vol != vol && e->vol != vol->tier_vol) || !(e->key == *key)) {
+    return false;
+  }
+  if (!cache_l0_valid(e, vol)) {
+    e->data = nullptr;
+    return false;
+  }
+  if (e->hits < CACHE_L0_MAX_HITS) {
+    ++e->hits;
+  }
+  data = e->data;
+  return true;
+}
+
+void
+cache_l0_put(const CacheKey *key, Vol *vol, const Dir *dir, IOBufferData *data)
+{
+  CacheL0Entry *e = cache_l0_slot(key);
+
+  if (e == nullptr) {
+    return;
+  }
+  ink_assert(vol->mutex->thread_holding == this_ethread());
+
+  // A resident entry still being hit is aged instead of replaced, so one
+  // pass of cold objects can't flush the hot ones.
+  if (e->data && !(e->key == *key) && e->hits > 0 &&
+      e->generation == __atomic_load_n(&cache_l0_generation, __ATOMIC_ACQUIRE)) {
+    --e->hits;
+    return;
+  }
+
+  e->key        = *key;
+  e->vol        = vol;
+  e->dir        = *dir;
+  e->generation = __atomic_load_n(&cache_l0_generation, __ATOMIC_ACQUIRE);
+  e->hits       = 0;
+  e->data       = data;
+}
+
+void
+cache_l0_invalidate_all()
+{
+  __atomic_add_fetch(&cache_l0_generation, 1, __ATOMIC_RELEASE);
+}
@@ -26,7 +26,7 @@
 Action *
 Cache::link(Continuation *cont, const CacheKey *from, const CacheKey *to, CacheFragType type, const char *hostname, int host_len)
 {
-  if (!CacheProcessor::IsCacheReady(type)) {
+  if (!CacheProcessor::IsCacheReady(type) || !all_stripes_up()) {
     cont->handleEvent(CACHE_EVENT_LINK_FAILED, nullptr);
     return ACTION_RESULT_DONE;
   }
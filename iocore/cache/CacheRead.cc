@@ -43,7 +43,9 @@ Cache::open_read(Continuation *cont, const CacheKey *key, CacheFragType type, co
   CacheVC *c        = nullptr;
   {
     CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
-    if (!lock.is_locked() || (od = vol->open_read(key)) || dir_probe(key, vol, &result, &last_collision)) {
+    // without the lock, only wait for it if the key might be there
+    if (lock.is_locked() ? (od = vol->open_read(key)) || dir_probe(key, vol, &result, &last_collision) :
+                           dir_may_contain(key, vol)) {
       c = new_CacheVC(cont);
       SET_CONTINUATION_HANDLER(c, &CacheVC::openReadStartHead);
       c->vio.op    = VIO::READ;
@@ -55,6 +57,9 @@ Cache::open_read(Continuation *cont, const CacheKey *key, CacheFragType type, co
       c->od                                   = od;
     }
     if (!c) {
+      if (!lock.is_locked()) {
+        CACHE_INCREMENT_DYN_STAT(cache_read_lockless_miss_stat);
+      }
       goto Lmiss;
     }
     if (!lock.is_locked()) {
@@ -102,15 +107,16 @@ Cache::open_read(Continuation *cont, const CacheKey *key, CacheHTTPHdr *request,
   }
   ink_assert(caches[type] == this);
 
-  Vol *vol = key_to_vol(key, hostname, host_len);
+  Vol *vol  = key_to_vol(key, hostname, host_len);
+  Vol *home = vol; // vol is switched to the fast tier if the key was promoted
   Dir result, *last_collision = nullptr;
   ProxyMutex *mutex = cont->mutex.get();
   OpenDirEntry *od  = nullptr;
   CacheVC *c        = nullptr;
 
-  {
-    CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
-    if (!lock.is_locked() || (od = vol->open_read(key)) || dir_probe(key, vol, &result, &last_collision)) {
+  if (cache_config_ram_cache_l0_entries) {
+    Ptr<IOBufferData> data;
+    if (cache_l0_get(key, vol, data)) {
       c            = new_CacheVC(cont);
       c->first_key = c->key = c->earliest_key = *key;
       c->vol                                  = vol;
@@ -120,32 +126,69 @@ Cache::open_read(Continuation *cont, const CacheKey *key, CacheHTTPHdr *request,
       c->request.copy_shallow(request);
       c->frag_type = CACHE_FRAG_TYPE_HTTP;
       c->params    = params;
-      c->od        = od;
-    }
-    if (!lock.is_locked()) {
-      SET_CONTINUATION_HANDLER(c, &CacheVC::openReadStartHead);
-      CONT_SCHED_LOCK_RETRY(c);
-      return &c->_action;
-    }
-    if (!c) {
-      goto Lmiss;
-    }
-    if (c->od) {
-      goto Lwriter;
+      if (c->openReadFromL0(data)) {
+        CACHE_INCREMENT_DYN_STAT(cache_l0_hits_stat);
+        SET_CONTINUATION_HANDLER(c, &CacheVC::openReadMain);
+        c->callcont(CACHE_EVENT_OPEN_READ);
+        return ACTION_RESULT_DONE;
+      }
+      // e.g. an alternate that isn't in the head, take the long way
+      free_CacheVC(c);
+      c = nullptr;
     }
-    // hit
-    c->dir = c->first_dir = result;
-    c->last_collision     = last_collision;
+    CACHE_INCREMENT_DYN_STAT(cache_l0_misses_stat);
+  }
+  vol = cache_tier_lookup(vol, key, mutex);
+Lprobe : {
+  CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+  // without the lock, only wait for it if the key might be there
+  if (lock.is_locked() ? (od = vol->open_read(key)) || dir_probe(key, vol, &result, &last_collision) :
+                         dir_may_contain(key, vol)) {
+    c            = new_CacheVC(cont);
+    c->first_key = c->key = c->earliest_key = *key;
+    c->vol                                  = vol;
+    c->vio.op                               = VIO::READ;
+    c->base_stat                            = cache_read_active_stat;
+    CACHE_INCREMENT_DYN_STAT(c->base_stat + CACHE_STAT_ACTIVE);
+    c->request.copy_shallow(request);
+    c->frag_type = CACHE_FRAG_TYPE_HTTP;
+    c->params    = params;
+    c->od        = od;
+  }
+  if (c && !lock.is_locked()) {
     SET_CONTINUATION_HANDLER(c, &CacheVC::openReadStartHead);
-    switch (c->do_read_call(&c->key)) {
-    case EVENT_DONE:
-      return ACTION_RESULT_DONE;
-    case EVENT_RETURN:
-      goto Lcallreturn;
-    default:
-      return &c->_action;
+    CONT_SCHED_LOCK_RETRY(c);
+    return &c->_action;
+  }
+  if (!c) {
+    if (vol != home) {
+      // the promoted copy has been overwritten, the home stripe still has it
+      cache_tier_forget(home, key, mutex);
+      vol            = home;
+      last_collision = nullptr;
+      goto Lprobe;
+    }
+    if (!lock.is_locked()) {
+      CACHE_INCREMENT_DYN_STAT(cache_read_lockless_miss_stat);
     }
+    goto Lmiss;
   }
+  if (c->od) {
+    goto Lwriter;
+  }
+  // hit
+  c->dir = c->first_dir = result;
+  c->last_collision     = last_collision;
+  SET_CONTINUATION_HANDLER(c, &CacheVC::openReadStartHead);
+  switch (c->do_read_call(&c->key)) {
+  case EVENT_DONE:
+    return ACTION_RESULT_DONE;
+  case EVENT_RETURN:
+    goto Lcallreturn;
+  default:
+    return &c->_action;
+  }
+}
 Lmiss:
   CACHE_INCREMENT_DYN_STAT(cache_read_failure_stat);
   cont->handleEvent(CACHE_EVENT_OPEN_READ_FAILED, (void *)-ECACHE_NO_DOC);
@@ -172,7 +215,7 @@ CacheVC::load_http_info(CacheHTTPInfoVector *info, Doc *doc, RefCountObj *block_
   if (!this->f.doc_from_ram_cache && // ram cache is always already fixed up.
       // If this is an old object, the object version will be old or 0, in either case this is correct.
       // Forget the 4.2 compatibility, always update older versioned objects.
-      VersionNumber(doc->v_major, doc->v_minor) < CACHE_DB_VERSION) {
+      VersionNumber(doc->v_major, doc->v_minor) < CACHE_DOC_VERSION) {
     for (int i = info->xcount - 1; i >= 0; --i) {
       info->data(i).alternate.m_alt->m_response_hdr.m_mime->recompute_accelerators_and_presence_bits();
       info->data(i).alternate.m_alt->m_request_hdr.m_mime->recompute_accelerators_and_presence_bits();
@@ -534,6 +577,11 @@ CacheVC::openReadClose(int event, Event * /* e ATS_UNUSED */)
     }
     set_io_not_in_progress();
   }
+  read_ahead_cancel();
+  if (f.l0_hit) {
+    // never registered with the Vol
+    return free_CacheVC(this);
+  }
   CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
   if (!lock.is_locked()) {
     VC_SCHED_LOCK_RETRY();
@@ -771,8 +819,24 @@ Lread : {
     SET_HANDLER(&CacheVC::openReadMain);
     VC_SCHED_LOCK_RETRY();
   }
+  if (read_ahead && !(read_ahead->key == key)) {
+    read_ahead_cancel(); // moved, e.g. by a seek
+  }
+  if (read_ahead) {
+    SET_HANDLER(&CacheVC::openReadReadDone);
+    if (!read_ahead->f.read_ahead_done) {
+      PUSH_HANDLER(&CacheVC::readAheadWait);
+      io.aiocb.aio_fildes = AIO_READ_AHEAD_IN_PROGRESS;
+      read_ahead_start();
+      return EVENT_CONT;
+    }
+    read_ahead_take();
+    read_ahead_start();
+    goto Lcallreturn;
+  }
   if (dir_probe(&key, vol, &dir, &last_collision)) {
     SET_HANDLER(&CacheVC::openReadReadDone);
+    read_ahead_start();
     int ret = do_read_call(&key);
     if (ret == EVENT_RETURN) {
       goto Lcallreturn;
@@ -811,6 +875,137 @@ Lcallreturn:
   return handleEvent(AIO_EVENT_DONE, nullptr);
 }
 
+// Issue reads for the fragments after the one being read, as many as
+// proxy.config.cache.read_ahead_fragments allows and no further than the
+// reader asked for. Only called as the reader goes for the next fragment,
+// so read ahead stops as well when the consumer falls behind its water mark.
+void
+CacheVC::read_ahead_start()
+{
+  ink_assert(vol->mutex->thread_holding == this_ethread());
+  if (cache_config_read_ahead_fragments <= 0 || write_vc || !alternate.valid() || !alternate.get_frag_table()) {
+    return;
+  }
+  HTTPInfo::FragOffset *frags = alternate.get_frag_table();
+  int last                    = static_cast<int>(alternate.get_frag_offset_count()); // index of the last fragment
+  if (fragment >= last) {
+    return;
+  }
+  // where the reader is: the seek target, or else the start of fragment + 1
+  int64_t start = seek_to ? (int64_t)seek_to : fragment >= 0 ? (int64_t)frags[fragment] : 0;
+  int64_t end   = start + std::min(vio.ntodo(), (int64_t)doc_len);
+  CacheVC *tail = nullptr;
+  int n         = 0;
+
+  for (CacheVC *c = read_ahead; c; c = c->read_ahead) {
+    tail = c;
+    n++;
+  }
+  CacheKey k = tail ? tail->key : key;
+  int i      = tail ? tail->fragment : fragment + 1;
+  // frags[i] is where fragment i + 1 starts
+  while (n < cache_config_read_ahead_fragments && i < last && (int64_t)frags[i] < end) {
+    Dir *probe_collision = nullptr;
+    Dir probe_dir;
+    next_CacheKey(&k, &k);
+    i++;
+    if (!dir_probe(&k, vol, &probe_dir, &probe_collision)) {
+      break; // let the reader deal with it
+    }
+    CacheVC *c           = new_CacheVC(this);
+    c->vio.op            = VIO::READ;
+    c->base_stat         = cache_read_ahead_active_stat;
+    c->vol               = vol;
+    c->first_key         = first_key;
+    c->earliest_key      = earliest_key;
+    c->key               = k;
+    c->fragment          = i;
+    c->doc_len           = doc_len;
+    c->dir               = probe_dir;
+    c->last_collision    = probe_collision;
+    c->read_ahead_parent = this;
+    CACHE_INCREMENT_DYN_STAT(c->base_stat + CACHE_STAT_ACTIVE);
+    if (tail) {
+      tail->read_ahead = c;
+    } else {
+      read_ahead = c;
+    }
+    tail = c;
+    n++;
+    SET_CONTINUATION_HANDLER(c, &CacheVC::readAheadDone);
+    if (c->do_read_call(&c->key) == EVENT_RETURN) {
+      c->handleEvent(AIO_EVENT_DONE, nullptr);
+    }
+  }
+}
+
+// Make the first fragment read ahead the one just read.
+void
+CacheVC::read_ahead_take()
+{
+  CacheVC *c = read_ahead;
+
+  ink_assert(c->f.read_ahead_done && c->key == key);
+  read_ahead            = c->read_ahead;
+  buf                   = c->buf;
+  dir                   = c->dir;
+  last_collision        = c->last_collision;
+  doc_pos               = 0;
+  io.aiocb.aio_nbytes   = c->io.aiocb.aio_nbytes;
+  io.aio_result         = c->io.aio_result;
+  f.doc_from_ram_cache  = c->f.doc_from_ram_cache;
+  f.not_from_ram_cache |= c->f.not_from_ram_cache;
+  c->closed             = 1;
+  free_CacheVC(c);
+}
+
+// Drop what has been read ahead, reads still in progress free themselves.
+void
+CacheVC::read_ahead_cancel()
+{
+  while (read_ahead) {
+    CacheVC *c = read_ahead;
+    read_ahead = c->read_ahead;
+    CACHE_INCREMENT_DYN_STAT(cache_read_ahead_failure_stat);
+    if (c->f.read_ahead_done) {
+      free_CacheVC(c);
+    } else {
+      c->read_ahead_parent = nullptr;
+    }
+  }
+}
+
+// A fragment read ahead is in, hand it over if the reader is waiting for it.
+int
+CacheVC::readAheadDone(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  CacheVC *reader = read_ahead_parent;
+
+  cancel_trigger();
+  f.read_ahead_done = 1;
+  if (!reader) {
+    return free_CacheVC(this);
+  }
+  if (reader->read_ahead == this && reader->io.aiocb.aio_fildes == AIO_READ_AHEAD_IN_PROGRESS) {
+    reader->read_ahead_take();
+    return reader->handleEvent(AIO_EVENT_DONE, nullptr);
+  }
+  return EVENT_CONT;
+}
+
+// The reader waits here for a fragment read ahead as it would in
+// handleReadDone for its own read.
+int
+CacheVC::readAheadWait(int event, Event * /* e ATS_UNUSED */)
+{
+  cancel_trigger();
+  if (event != AIO_EVENT_DONE) {
+    return EVENT_CONT;
+  }
+  POP_HANDLER;
+  return handleEvent(AIO_EVENT_DONE, nullptr);
+}
+
 /*
   This code follows CacheVC::openReadStartHead closely,
   if you change this you might have to change that.
@@ -1013,6 +1208,49 @@ Lrestart:
   return openReadStartHead(EVENT_IMMEDIATE, nullptr);
 }
 
+/*
+  The lock free part of CacheVC::openReadStartHead for a head found in the
+  thread's L0 cache. Only single fragment objects are put there, so this
+  either sets up the whole read or gives up and leaves the VC unused.
+*/
+bool
+CacheVC::openReadFromL0(Ptr<IOBufferData> &data)
+{
+  Doc *doc = (Doc *)data->data();
+  CacheHTTPInfo *alternate_tmp;
+  CacheKey data_key;
+
+  f.doc_from_ram_cache = true; // already fixed up
+  if (this->load_http_info(&vector, doc) != doc->hlen) {
+    return false;
+  }
+  if (cache_config_select_alternate) {
+    alternate_index = HttpTransactCache::SelectFromAlternates(&vector, &request, params);
+    if (alternate_index < 0) {
+      return false;
+    }
+  } else {
+    alternate_index = 0;
+  }
+  alternate_tmp = vector.get(alternate_index);
+  if (!alternate_tmp->valid()) {
+    return false;
+  }
+  alternate_tmp->object_key_get(&data_key);
+  if (!(data_key == doc->key) || !doc->single_fragment()) {
+    return false;
+  }
+
+  alternate.copy_shallow(alternate_tmp);
+  buf = first_buf   = data;
+  doc_len           = alternate.object_size_get();
+  doc_pos           = doc->prefix_len();
+  f.single_fragment = true;
+  f.l0_hit          = true;
+  next_CacheKey(&key, &doc->key);
+  return true;
+}
+
 /*
   This code follows CacheVC::openReadStartEarliest closely,
   if you change this you might have to change that.
@@ -1163,6 +1401,14 @@ CacheVC::openReadStartHead(int event, Event *e)
       f.hit_evacuate = 1;
     }
 
+    if (f.doc_from_ram_cache && frag_type == CACHE_FRAG_TYPE_HTTP && cache_config_ram_cache_l0_entries &&
+        doc->len <= (uint32_t)cache_config_ram_cache_l0_cutoff) {
+      cache_l0_put(&first_key, vol, &dir, buf.get());
+    }
+    if (vol->tier_vol && frag_type == CACHE_FRAG_TYPE_HTTP) {
+      cache_tier_promote(this);
+    }
+
     first_buf = buf;
     vol->begin_read(this);
 
@@ -24,6 +24,7 @@
 
 #include "P_Cache.h"
 #include "P_CacheTest.h"
+#include "ts/TestBox.h"
 #include <vector>
 #include <cmath>
 #include <cstdlib>
@@ -666,8 +667,603 @@ REGRESSION_TEST(ram_cache)(RegressionTest *t, int level, int *pstatus)
   for (int s = 20; s <= 28; s += 4) {
     int64_t cache_size = 1LL << s;
     *pstatus           = REGRESSION_TEST_PASSED;
-    if (!test_RamCache(t, new_RamCacheLRU(), "LRU", cache_size) || !test_RamCache(t, new_RamCacheCLFUS(), "CLFUS", cache_size)) {
+    if (!test_RamCache(t, new_RamCacheLRU(), "LRU", cache_size) || !test_RamCache(t, new_RamCacheCLFUS(), "CLFUS", cache_size) ||
+        !test_RamCache(t, new_RamCacheTinyLFU(), "TinyLFU", cache_size)) {
       *pstatus = REGRESSION_TEST_FAILED;
     }
   }
 }
+
+struct RamCacheTraceRecord {
+  CacheKey key;
+  int64_t len;
+};
+
+// Replay trace through cache, fragmenting objects the way the disk cache
+// does, and report the object and byte hit ratios over the second half.
+static void
+replay_RamCache(RegressionTest *t, RamCache *cache, const char *name, int64_t cache_size, vector<RamCacheTraceRecord> &trace)
+{
+  CacheKey key;
+  Vol *vol              = theCache->key_to_vol(&key, "example.com", sizeof("example.com") - 1);
+  int64_t frag_size     = cache_config_target_fragment_size - sizeof(Doc);
+  int64_t requests      = 0;
+  int64_t hits          = 0;
+  int64_t bytes         = 0;
+  int64_t hit_bytes     = 0;
+  ink_hrtime start_time = Thread::get_hrtime();
+
+  cache->init(cache_size, vol);
+  for (size_t i = 0; i < trace.size(); i++) {
+    bool sampled = i >= trace.size() / 2;
+    bool hit     = true;
+
+    key = trace[i].key;
+    for (int64_t left = trace[i].len; left > 0 || key == trace[i].key; left -= frag_size) {
+      int64_t len = left < frag_size ? left : frag_size;
+      Ptr<IOBufferData> data;
+
+      if (cache->get(&key, &data)) {
+        hit_bytes += sampled ? len : 0;
+      } else {
+        hit  = false;
+        data = make_ptr(new_IOBufferData(iobuffer_size_to_index(len + sizeof(Doc), MAX_BUFFER_SIZE_INDEX), MEMALIGNED));
+        cache->put(&key, data.get(), len + sizeof(Doc));
+      }
+      bytes += sampled ? len : 0;
+      next_CacheKey(&key, &key);
+    }
+    if (sampled) {
+      requests++;
+      hits += hit;
+    }
+  }
+
+  rprintf(t, "RamCache %s Size %" PRId64 " Hit Ratio %f Byte Hit Ratio %f (%" PRId64 " ms)\n", name, cache_size,
+          requests ? (double)hits / requests : 0.0, bytes ? (double)hit_bytes / bytes : 0.0,
+          ink_hrtime_to_msec(Thread::get_hrtime() - start_time));
+  delete cache;
+}
+
+// Compare the RAM cache policies on a recorded workload. The trace named by
+// TS_RAM_CACHE_TRACE has one request per line, a cache key (typically the URL)
+// and the object size in bytes separated by whitespace, for instance from a
+// log format of "%<cquuc> %<pscl>". TS_RAM_CACHE_TRACE_SIZE sets the RAM cache
+// size to replay with, 64MB by default.
+REGRESSION_TEST(ram_cache_replay)(RegressionTest *t, int level, int *pstatus)
+{
+  const char *path   = getenv("TS_RAM_CACHE_TRACE");
+  const char *size   = getenv("TS_RAM_CACHE_TRACE_SIZE");
+  int64_t cache_size = size ? ink_atoi64(size) : 64 * 1024 * 1024;
+  vector<RamCacheTraceRecord> trace;
+  char line[4096];
+  FILE *fp;
+
+  *pstatus = REGRESSION_TEST_PASSED;
+  if (REGRESSION_TEST_EXTENDED > level || path == nullptr) {
+    return;
+  }
+  if (cacheProcessor.IsCacheEnabled() != CACHE_INITIALIZED) {
+    rprintf(t, "cache not initialized");
+    *pstatus = REGRESSION_TEST_FAILED;
+    return;
+  }
+  if ((fp = fopen(path, "r")) == nullptr) {
+    rprintf(t, "unable to open %s: %s\n", path, strerror(errno));
+    *pstatus = REGRESSION_TEST_FAILED;
+    return;
+  }
+  while (fgets(line, sizeof(line), fp)) {
+    RamCacheTraceRecord r;
+    char *sep = strpbrk(line, " \t");
+
+    if (sep == nullptr || (r.len = strtoll(sep + 1, nullptr, 10)) < 0) {
+      continue;
+    }
+    MD5Context().hash_immediate(r.key, line, sep - line);
+    trace.push_back(r);
+  }
+  fclose(fp);
+  rprintf(t, "RamCache replaying %zu requests from %s\n", trace.size(), path);
+
+  replay_RamCache(t, new_RamCacheLRU(), "LRU", cache_size, trace);
+  replay_RamCache(t, new_RamCacheCLFUS(), "CLFUS", cache_size, trace);
+  replay_RamCache(t, new_RamCacheTinyLFU(), "TinyLFU", cache_size, trace);
+}
+
+// Reports how long the cache took to come up. Waits for any stripe still
+// recovering with proxy.config.cache.incremental_open.
+struct CacheStartupReport : public Continuation {
+  RegressionTest *t;
+  int *pstatus;
+
+  int
+  mainEvent(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+  {
+    int64_t dir_bytes = 0;
+
+    if (theCache->total_initialized_vol < theCache->total_nvol) {
+      eventProcessor.schedule_in(this, HRTIME_MSECONDS(100));
+      return EVENT_CONT;
+    }
+    for (int i = 0; i < gnvol; i++) {
+      if (gvol[i]->cache == theCache) {
+        dir_bytes += vol_dirlen(gvol[i]);
+      }
+    }
+    rprintf(t, "%d of %d stripes, %" PRId64 " GB of storage, %" PRId64 " MB of directory\n", theCache->total_good_nvol,
+            theCache->total_nvol, (theCache->cache_size * STORE_BLOCK_SIZE) >> 30, dir_bytes >> 20);
+    rprintf(t, "serving after %" PRId64 " ms, all stripes recovered after %" PRId64 " ms\n",
+            (int64_t)ink_hrtime_to_msec(theCache->ready_time - theCache->open_time),
+            (int64_t)ink_hrtime_to_msec(theCache->recovered_time - theCache->open_time));
+    *pstatus = theCache->total_good_nvol == theCache->total_nvol ? REGRESSION_TEST_PASSED : REGRESSION_TEST_FAILED;
+    delete this;
+    return EVENT_DONE;
+  }
+
+  CacheStartupReport(RegressionTest *at, int *ast) : Continuation(new_ProxyMutex()), t(at), pstatus(ast)
+  {
+    SET_HANDLER(&CacheStartupReport::mainEvent);
+  }
+};
+
+// Startup time benchmark. To measure a synthetic 1TB cache, back it with a
+// sparse file, for instance "truncate -s 1T /tmp/cache.db" and the line
+// "/tmp/cache.db 1T" in storage.config. The first run clears and writes the
+// directories, time a second one with -R 3 -r cache_startup.
+REGRESSION_TEST(cache_startup)(RegressionTest *t, int level, int *pstatus)
+{
+  if (REGRESSION_TEST_EXTENDED > level) {
+    *pstatus = REGRESSION_TEST_PASSED;
+    return;
+  }
+  if (cacheProcessor.IsCacheEnabled() != CACHE_INITIALIZED || !theCache) {
+    rprintf(t, "cache not initialized");
+    *pstatus = REGRESSION_TEST_FAILED;
+    return;
+  }
+  *pstatus = REGRESSION_TEST_INPROGRESS;
+  eventProcessor.schedule_imm(new CacheStartupReport(t, pstatus));
+}
+
+#define CACHE_READ_BENCH_OBJECTS 1000
+#define CACHE_READ_BENCH_OBJECT_SIZE 4096
+#define CACHE_READ_BENCH_READERS 8 // per thread
+#define CACHE_READ_BENCH_TIME HRTIME_SECONDS(2)
+
+struct CacheReadBench;
+
+// Reads random objects one after the other until the round is over. Half of
+// the keys were never written, so there are misses as well.
+struct CacheReadBenchReader : public Continuation {
+  CacheReadBench *bench;
+  unsigned int seed;
+  int64_t hits           = 0;
+  int64_t misses         = 0;
+  int64_t errors         = 0;
+  CacheVConnection *vc   = nullptr;
+  MIOBuffer *buffer      = nullptr;
+  IOBufferReader *reader = nullptr;
+
+  int mainEvent(int event, void *data);
+
+  CacheReadBenchReader(CacheReadBench *b, unsigned int s) : Continuation(new_ProxyMutex()), bench(b), seed(s)
+  {
+    buffer = new_empty_MIOBuffer();
+    reader = buffer->alloc_reader();
+    SET_HANDLER(&CacheReadBenchReader::mainEvent);
+  }
+  ~CacheReadBenchReader() { free_MIOBuffer(buffer); }
+};
+
+// Writes the objects, then measures hits/sec with readers on 1, 2, 4, ... of
+// the ET_CALL threads.
+struct CacheReadBench : public Continuation {
+  RegressionTest *t;
+  int *pstatus;
+  int written            = 0;
+  int nthreads           = 0;
+  int active             = 0;
+  int64_t hits           = 0;
+  int64_t misses         = 0;
+  int64_t errors         = 0;
+  ink_hrtime end         = 0;
+  CacheVConnection *vc   = nullptr;
+  MIOBuffer *buffer      = nullptr;
+  IOBufferReader *reader = nullptr;
+  char data[CACHE_READ_BENCH_OBJECT_SIZE];
+
+  static void
+  make_key(CacheKey *key, int i)
+  {
+    MD5Context().hash_immediate(*key, &i, sizeof(i));
+  }
+
+  // Called by each reader as it stops.
+  void
+  reader_done(CacheReadBenchReader *r)
+  {
+    ink_atomic_increment(&hits, r->hits);
+    ink_atomic_increment(&misses, r->misses);
+    ink_atomic_increment(&errors, r->errors);
+    if (ink_atomic_increment(&active, -1) == 1) {
+      eventProcessor.schedule_imm(this);
+    }
+  }
+
+  void
+  start_round()
+  {
+    hits = misses = 0;
+    active        = nthreads * CACHE_READ_BENCH_READERS;
+    end           = Thread::get_hrtime() + CACHE_READ_BENCH_TIME;
+    for (int i = 0; i < nthreads; i++) {
+      EThread *thread = eventProcessor.thread_group[ET_CALL]._thread[i];
+      for (int r = 0; r < CACHE_READ_BENCH_READERS; r++) {
+        thread->schedule_imm(new CacheReadBenchReader(this, i * CACHE_READ_BENCH_READERS + r));
+      }
+    }
+  }
+
+  int
+  readEvent(int /* event ATS_UNUSED */, void * /* data ATS_UNUSED */)
+  {
+    double secs = (double)CACHE_READ_BENCH_TIME / HRTIME_SECOND;
+
+    rprintf(t, "%d threads: %.0f hits/sec, %.0f misses/sec\n", nthreads, hits / secs, misses / secs);
+    if (nthreads < eventProcessor.thread_group[ET_CALL]._count) {
+      nthreads = std::min(nthreads * 2, eventProcessor.thread_group[ET_CALL]._count);
+      start_round();
+      return EVENT_DONE;
+    }
+    *pstatus = errors ? REGRESSION_TEST_FAILED : REGRESSION_TEST_PASSED;
+    delete this;
+    return EVENT_DONE;
+  }
+
+  int
+  writeEvent(int event, void *edata)
+  {
+    CacheKey key;
+
+    switch (event) {
+    case EVENT_IMMEDIATE:
+      if (written == CACHE_READ_BENCH_OBJECTS) {
+        rprintf(t, "reading %d byte objects, %d readers per thread\n", CACHE_READ_BENCH_OBJECT_SIZE, CACHE_READ_BENCH_READERS);
+        SET_HANDLER(&CacheReadBench::readEvent);
+        nthreads = 1;
+        start_round();
+        return EVENT_DONE;
+      }
+      make_key(&key, written);
+      cacheProcessor.open_write(this, &key);
+      return EVENT_DONE;
+
+    case CACHE_EVENT_OPEN_WRITE:
+      vc = (CacheVConnection *)edata;
+      buffer->write(data, sizeof(data));
+      vc->do_io_write(this, sizeof(data), reader);
+      return EVENT_DONE;
+
+    case VC_EVENT_WRITE_READY:
+      ((VIO *)edata)->reenable();
+      return EVENT_CONT;
+
+    case VC_EVENT_WRITE_COMPLETE:
+      vc->do_io_close();
+      break;
+
+    default:
+      if (vc) {
+        vc->do_io_close(1);
+      }
+      errors++;
+      break;
+    }
+    vc = nullptr;
+    reader->consume(reader->read_avail());
+    written++;
+    eventProcessor.schedule_imm(this);
+    return EVENT_DONE;
+  }
+
+  CacheReadBench(RegressionTest *at, int *ast) : Continuation(new_ProxyMutex()), t(at), pstatus(ast)
+  {
+    buffer = new_empty_MIOBuffer();
+    reader = buffer->alloc_reader();
+    memset(data, 'x', sizeof(data));
+    SET_HANDLER(&CacheReadBench::writeEvent);
+  }
+  ~CacheReadBench() { free_MIOBuffer(buffer); }
+};
+
+int
+CacheReadBenchReader::mainEvent(int event, void *edata)
+{
+  CacheKey key;
+
+  switch (event) {
+  case EVENT_IMMEDIATE:
+    if (Thread::get_hrtime() >= bench->end) {
+      bench->reader_done(this);
+      delete this;
+      return EVENT_DONE;
+    }
+    CacheReadBench::make_key(&key, rand_r(&seed) % (2 * CACHE_READ_BENCH_OBJECTS));
+    cacheProcessor.open_read(this, &key);
+    return EVENT_DONE;
+
+  case CACHE_EVENT_OPEN_READ:
+    vc = (CacheVConnection *)edata;
+    vc->do_io_read(this, vc->get_object_size(), buffer);
+    return EVENT_DONE;
+
+  case VC_EVENT_READ_READY:
+    reader->consume(reader->read_avail());
+    ((VIO *)edata)->reenable();
+    return EVENT_CONT;
+
+  case VC_EVENT_READ_COMPLETE:
+    vc->do_io_close();
+    hits++;
+    break;
+
+  case CACHE_EVENT_OPEN_READ_FAILED:
+    misses++;
+    break;
+
+  default:
+    if (vc) {
+      vc->do_io_close(1);
+    }
+    errors++;
+    break;
+  }
+  vc = nullptr;
+  reader->consume(reader->read_avail());
+  this_ethread()->schedule_imm_local(this);
+  return EVENT_DONE;
+}
+
+// Read throughput benchmark, run with -R 3 -r cache_read_scaling. Reports
+// hits/sec for a growing number of threads reading the same stripes.
+REGRESSION_TEST(cache_read_scaling)(RegressionTest *t, int level, int *pstatus)
+{
+  if (REGRESSION_TEST_EXTENDED > level) {
+    *pstatus = REGRESSION_TEST_PASSED;
+    return;
+  }
+  if (cacheProcessor.IsCacheEnabled() != CACHE_INITIALIZED) {
+    rprintf(t, "cache not initialized");
+    *pstatus = REGRESSION_TEST_FAILED;
+    return;
+  }
+  *pstatus = REGRESSION_TEST_INPROGRESS;
+  eventProcessor.schedule_imm(new CacheReadBench(t, pstatus));
+}
+
+// Promotion table of a home stripe, through the states a promotion goes
+// through. The stripes are not initialized, only their tables are used and
+// their stats go to the first volume.
+REGRESSION_TEST(cache_tier)(RegressionTest *t, int /* level ATS_UNUSED */, int *pstatus)
+{
+  if (cacheProcessor.IsCacheEnabled() != CACHE_INITIALIZED || !gnvol) {
+    rprintf(t, "cache not initialized");
+    *pstatus = REGRESSION_TEST_FAILED;
+    return;
+  }
+
+  TestBox box(t, pstatus);
+  EThread *thread   = this_ethread();
+  ProxyMutex *mutex = thread->mutex.get();
+  Vol *home         = new Vol();
+  Vol *fast         = new Vol();
+  CacheKey key, other;
+
+  *pstatus        = REGRESSION_TEST_PASSED;
+  home->cache_vol = fast->cache_vol = gvol[0]->cache_vol;
+  home->tier_vol  = fast;
+  home->tier_keys = (uint64_t *)ats_calloc(64, sizeof(uint64_t));
+  home->tier_mask = 63;
+  key.u64[0]      = 0x0123456789abcdefULL;
+  key.u64[1]      = 1;
+  other.u64[0]    = key.u64[0] + 1; // same slot
+  other.u64[1]    = 1;
+
+  {
+    SCOPED_MUTEX_LOCK(lock, home->mutex, thread);
+
+    box.check(cache_tier_lookup(home, &key, mutex) == home, "unknown key is read from its home");
+    box.check(cache_tier_begin(home, &key), "promotion starts");
+    box.check(!cache_tier_begin(home, &key), "a pending promotion isn't started again");
+    box.check(cache_tier_lookup(home, &key, mutex) == home, "pending promotion is read from its home");
+    box.check(cache_tier_publish(home, &key), "copy is published");
+    box.check(cache_tier_lookup(home, &key, mutex) == fast, "promoted key is read from the fast stripe");
+    box.check(!cache_tier_begin(home, &key), "a promoted key isn't promoted again");
+
+    cache_tier_invalidate(home, &other);
+    box.check(cache_tier_lookup(home, &key, mutex) == fast, "another key's change leaves the slot alone");
+    cache_tier_forget(home, &key, mutex);
+    box.check(cache_tier_lookup(home, &key, mutex) == home, "a lost copy is read from its home");
+
+    // the home entry changes while the copy is queued
+    cache_tier_begin(home, &key);
+    cache_tier_invalidate(home, &key);
+    box.check(!cache_tier_publish(home, &key), "a copy of a changed entry isn't published");
+    box.check(cache_tier_lookup(home, &key, mutex) == home, "a changed entry is read from its home");
+
+    // another promotion takes the slot while the copy is queued
+    cache_tier_begin(home, &key);
+    cache_tier_begin(home, &other);
+    box.check(!cache_tier_publish(home, &key), "a displaced promotion isn't published");
+    box.check(cache_tier_publish(home, &other), "the displacing promotion is published");
+    box.check(cache_tier_lookup(home, &key, mutex) == home, "a displaced key is read from its home");
+  }
+
+  ats_free(home->tier_keys);
+  home->tier_keys = nullptr;
+  delete home;
+  delete fast;
+}
+
+REGRESSION_TEST(cache_l0)(RegressionTest *t, int /* level ATS_UNUSED */, int *pstatus)
+{
+  if (cacheProcessor.IsCacheEnabled() != CACHE_INITIALIZED || !gnvol) {
+    rprintf(t, "cache not initialized");
+    *pstatus = REGRESSION_TEST_FAILED;
+    return;
+  }
+
+  TestBox box(t, pstatus);
+  EThread *thread = this_ethread();
+  Vol *vol        = gvol[0];
+  int entries     = cache_config_ram_cache_l0_entries;
+  Ptr<IOBufferData> data(new_IOBufferData(BUFFER_SIZE_INDEX_4K)), got;
+  CacheKey key, other;
+  Dir dir, moved, other_dir;
+
+  *pstatus = REGRESSION_TEST_PASSED;
+  if (!entries) {
+    cache_config_ram_cache_l0_entries = 16;
+    cache_l0_init();
+  }
+  if (!box.check(cache_config_ram_cache_l0_entries > 0, "L0 cache is enabled")) {
+    return;
+  }
+
+  rand_CacheKey(&key, thread->mutex);
+  other = key;
+  other.u32[2] ^= 1; // same bucket, different tag
+  dir_clear(&dir);
+  dir_set_phase(&dir, 0);
+  dir_set_head(&dir, true);
+  dir_set_offset(&dir, 1);
+  moved = other_dir = dir;
+  dir_set_offset(&moved, 2);
+  dir_set_offset(&other_dir, 3);
+
+  {
+    SCOPED_MUTEX_LOCK(lock, vol->mutex, thread);
+
+    box.check(!cache_l0_get(&key, vol, got), "unknown key misses");
+    dir_insert(&key, vol, &dir);
+    cache_l0_put(&key, vol, &dir, data.get());
+    box.check(cache_l0_get(&key, vol, got) && got == data, "cached key hits");
+    box.check(cache_l0_get(&key, vol, got) && got == data, "cached key hits again");
+
+    dir_insert(&other, vol, &other_dir);
+    box.check(cache_l0_get(&key, vol, got), "a write of another key in the bucket leaves the entry alone");
+
+    dir_overwrite(&key, vol, &moved, &dir);
+    box.check(!cache_l0_get(&key, vol, got), "a rewritten key misses");
+    cache_l0_put(&key, vol, &moved, data.get());
+    box.check(cache_l0_get(&key, vol, got), "the new copy hits");
+
+    cache_l0_invalidate_all();
+    box.check(!cache_l0_get(&key, vol, got), "a cleared directory drops every entry");
+    cache_l0_put(&key, vol, &moved, data.get());
+    box.check(cache_l0_get(&key, vol, got), "entries put after a clear hit");
+
+    dir_delete(&key, vol, &moved);
+    box.check(!cache_l0_get(&key, vol, got), "a deleted key misses");
+    dir_delete(&other, vol, &other_dir);
+  }
+
+  cache_config_ram_cache_l0_entries = entries;
+}
+
+// The frequency sketch on its own, then the admission decision built on it.
+REGRESSION_TEST(cache_admission)(RegressionTest *t, int /* level ATS_UNUSED */, int *pstatus)
+{
+  if (cacheProcessor.IsCacheEnabled() != CACHE_INITIALIZED || !gnvol) {
+    rprintf(t, "cache not initialized");
+    *pstatus = REGRESSION_TEST_FAILED;
+    return;
+  }
+
+  TestBox box(t, pstatus);
+  EThread *thread = this_ethread();
+  int min_hits    = cache_config_admission_min_hits;
+  CacheFrequencySketch sketch;
+  CacheKey key, other;
+  bool ok;
+
+  *pstatus   = REGRESSION_TEST_PASSED;
+  key.u64[0] = 0x0123456789abcdefULL;
+  key.u64[1] = 0xfedcba9876543210ULL;
+  sketch.init(CACHE_SKETCH_MIN_WORDS);
+
+  box.check(sketch.frequency(&key) == 0, "an unseen key has no history");
+  for (int i = 0; i < 3; i++) {
+    sketch.increment(&key);
+  }
+  box.check(sketch.frequency(&key) == 3, "a key alone in the sketch is counted exactly");
+  for (int i = 0; i < 2 * CACHE_SKETCH_MAX_COUNT; i++) {
+    sketch.increment(&key);
+  }
+  box.check(sketch.frequency(&key) == CACHE_SKETCH_MAX_COUNT, "counts saturate");
+
+  // Collisions can only over count.
+  sketch.init(CACHE_SKETCH_MIN_WORDS);
+  other = key;
+  for (int k = 0; k < 100; k++) {
+    other.u64[0] = key.u64[0] + k * 0x9e3779b97f4a7c15ULL;
+    for (int i = 0; i < 3; i++) {
+      sketch.increment(&other);
+    }
+  }
+  ok = true;
+  for (int k = 0; k < 100; k++) {
+    other.u64[0] = key.u64[0] + k * 0x9e3779b97f4a7c15ULL;
+    ok       = ok && sketch.frequency(&other) >= 3;
+  }
+  box.check(ok, "estimates are never below the true count");
+
+  // Aging halves every counter once enough increments were seen.
+  sketch.init(CACHE_SKETCH_MIN_WORDS);
+  for (int i = 0; i < 8; i++) {
+    sketch.increment(&key);
+  }
+  for (int64_t k = 1; sketch.additions < sketch.sample_size - 1; k++) {
+    other.u64[0] = key.u64[0] + k * 0x9e3779b97f4a7c15ULL;
+    sketch.increment(&other);
+  }
+  int before = sketch.frequency(&key);
+  box.check(before >= 8, "history is kept until the sample is full");
+  do {
+    other.u64[0] += 0x9e3779b97f4a7c15ULL;
+    sketch.increment(&other);
+  } while (sketch.additions == sketch.sample_size - 1);
+  box.check(sketch.additions == sketch.sample_size / 2, "aging halves the addition count");
+  // the increment that triggered it may have landed on the key's counters
+  box.check(sketch.frequency(&key) >= before / 2 && sketch.frequency(&key) <= (before + 1) / 2, "aging halves the counts");
+  ats_free(sketch.table);
+
+  // Admission, on a stripe of its own so the real ones keep their history.
+  // Its stats go to the first volume.
+  Vol *vol       = new Vol();
+  vol->cache_vol = gvol[0]->cache_vol;
+  vol->sketch    = new CacheFrequencySketch;
+  vol->sketch->init(CACHE_SKETCH_MIN_WORDS);
+
+  cache_config_admission_min_hits = 3;
+  box.check(!cache_admit(vol, &key, thread->mutex.get()), "a first request is not admitted");
+  box.check(!cache_admit(vol, &key, thread->mutex.get()), "a second request is not admitted");
+  box.check(cache_admit(vol, &key, thread->mutex.get()), "the third request is admitted");
+  box.check(cache_admit(vol, &key, thread->mutex.get()), "later requests are admitted");
+  other.u64[0] = key.u64[0] + 1;
+  box.check(!cache_admit(vol, &other, thread->mutex.get()), "other keys keep their own count");
+
+  cache_config_admission_min_hits = 1;
+  other.u64[0]++;
+  box.check(cache_admit(vol, &other, thread->mutex.get()), "everything is admitted with the filter off");
+
+  cache_config_admission_min_hits = 3;
+  ats_free(vol->sketch->table);
+  delete vol->sketch;
+  vol->sketch = nullptr;
+  box.check(cache_admit(vol, &other, thread->mutex.get()), "a volume without a sketch admits everything");
+
+  cache_config_admission_min_hits = min_hits;
+  delete vol;
+}
@@ -0,0 +1,207 @@
+/** @file
+
+  Promotion of popular objects to a fast storage tier
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "P_Cache.h"
+
+#define CACHE_TIER_MIN_ENTRIES 64
+
+int cache_config_tier_volume       = 0;
+int cache_config_tier_promote_hits = 3;
+
+static bool
+is_tier_vol(Vol *vol)
+{
+  return vol->cache_vol && vol->cache_vol->vol_number == cache_config_tier_volume;
+}
+
+void
+cache_tier_init()
+{
+  int nfast = 0, nhome = 0;
+
+  if (cache_config_tier_volume <= 0) {
+    return;
+  }
+
+  Vol **fast = (Vol **)ats_malloc(gnvol * sizeof(Vol *));
+  for (int i = 0; i < gnvol; i++) {
+    if (is_tier_vol(gvol[i])) {
+      fast[nfast++] = gvol[i];
+    }
+  }
+  if (!nfast) {
+    Warning("cache tier volume %d has no stripes, tiering disabled", cache_config_tier_volume);
+    ats_free(fast);
+    return;
+  }
+
+  for (int i = 0; i < gnvol; i++) {
+    Vol *vol = gvol[i];
+    if (!is_tier_vol(vol) && vol->cache_vol && vol->cache_vol->scheme == CACHE_HTTP_TYPE) {
+      vol->tier_vol = fast[nhome++ % nfast];
+    }
+  }
+
+  // Each home stripe gets a share of the directory of its fast stripe, which
+  // bounds how many of its objects can be promoted at once anyway.
+  int homes_per_fast = (nhome + nfast - 1) / nfast;
+  for (int i = 0; i < gnvol; i++) {
+    Vol *vol = gvol[i];
+    if (!vol->tier_vol) {
+      continue;
+    }
+    uint32_t n = CACHE_TIER_MIN_ENTRIES;
+    while (n < (uint32_t)(vol_direntries(vol->tier_vol) / homes_per_fast)) {
+      n <<= 1;
+    }
+    vol->tier_keys = (uint64_t *)ats_calloc(n, sizeof(uint64_t));
+    vol->tier_mask = n - 1;
+    Debug("cache_tier", "stripe %s promotes up to %u objects to %s", vol->hash_text.get(), n, vol->tier_vol->hash_text.get());
+  }
+  Note("cache tier: %d stripes promote to %d stripes of volume %d", nhome, nfast, cache_config_tier_volume);
+  ats_free(fast);
+}
+
+// A read racing a slot change goes to either stripe, as it would have by
+// starting a moment earlier or later.
+Vol *
+cache_tier_lookup(Vol *vol, const CacheKey *key, ProxyMutex *mutex)
+{
+  if (!vol->tier_keys || __atomic_load_n(cache_tier_slot(vol, key), __ATOMIC_ACQUIRE) != key->u64[0]) {
+    return vol;
+  }
+  CACHE_INCREMENT_DYN_STAT(cache_tier_reads_stat);
+  return vol->tier_vol;
+}
+
+void
+cache_tier_forget(Vol *vol, const CacheKey *key, ProxyMutex *mutex)
+{
+  CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+  if (lock.is_locked()) {
+    cache_tier_invalidate(vol, key);
+  }
+  CACHE_INCREMENT_DYN_STAT(cache_tier_fallbacks_stat);
+}
+
+static CacheVC *
+new_TierPromoter(int nbytes, Vol *vol)
+{
+  CacheVC *c        = new_CacheVC(vol);
+  ProxyMutex *mutex = vol->mutex.get();
+  c->base_stat      = cache_evacuate_active_stat;
+  CACHE_INCREMENT_DYN_STAT(c->base_stat + CACHE_STAT_ACTIVE);
+  c->buf         = new_IOBufferData(iobuffer_size_to_index(nbytes, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
+  c->vol         = vol;
+  c->f.evacuator = 1;
+  SET_CONTINUATION_HANDLER(c, &CacheVC::tierPromoteDone);
+  return c;
+}
+
+void
+cache_tier_promote(CacheVC *vc)
+{
+  Vol *vol          = vc->vol;
+  Vol *fast         = vol->tier_vol;
+  ProxyMutex *mutex = vc->mutex.get();
+  Doc *doc          = (Doc *)vc->buf->data();
+  uint64_t *slot    = cache_tier_slot(vol, &vc->first_key);
+
+  ink_assert(vol->mutex->thread_holding == this_ethread());
+  if (*slot == vc->first_key.u64[0] || *slot == cache_tier_pending(&vc->first_key) || vc->vector.count() != 1) {
+    return;
+  }
+  // The TinyLFU RAM cache shares the sketch and already counted this read.
+  if (cache_config_ram_cache_algorithm != RAM_CACHE_ALGORITHM_TINYLFU) {
+    vol->sketch->increment(&vc->first_key);
+  }
+  if (vol->sketch->frequency(&vc->first_key) < cache_config_tier_promote_hits) {
+    return;
+  }
+
+  CACHE_TRY_LOCK(lock, fast->mutex, mutex->thread_holding);
+  if (!lock.is_locked() || fast->agg_todo_size > cache_config_agg_write_backlog) {
+    return;
+  }
+
+  // The vector in the buffer may have been unmarshalled in place, so
+  // marshal it again ahead of the data.
+  int hlen = vc->vector.marshal_length();
+  int len  = sizeof(Doc) + hlen + doc->data_len();
+  if (len > BUFFER_SIZE_FOR_INDEX(MAX_BUFFER_SIZE_INDEX) || fast->round_to_approx_size(len) > AGG_SIZE) {
+    return;
+  }
+  CacheVC *c = new_TierPromoter(len, fast);
+  Doc *copy  = (Doc *)c->buf->data();
+  memcpy(copy, doc, sizeof(Doc));
+  copy->len      = len;
+  copy->hlen     = hlen;
+  copy->checksum = DOC_NO_CHECKSUM;
+  vc->vector.marshal(copy->hdr(), hlen);
+  memcpy(copy->data(), doc->data(), doc->data_len());
+
+  c->first_key     = vc->first_key;
+  c->agg_len       = fast->round_to_approx_size(len);
+  c->overwrite_dir = vc->dir;
+  c->tier_home     = vol;
+  dir_set_pinned(&c->overwrite_dir, 0);
+  dir_set_approx_size(&c->overwrite_dir, c->agg_len);
+
+  cache_tier_begin(vol, &vc->first_key);
+  CACHE_INCREMENT_DYN_STAT(cache_tier_promotions_stat);
+  DDebug("cache_tier", "promoting %X (%d bytes) from %s to %s", vc->first_key.slice32(0), len, vol->hash_text.get(),
+         fast->hash_text.get());
+
+  fast->agg_todo_size += c->agg_len;
+  fast->agg.enqueue(c);
+  fast->aggWrite(EVENT_IMMEDIATE, nullptr);
+}
+
+// Called by Vol::aggWrite once the copy is in the aggregation buffer.
+int
+CacheVC::tierPromoteDone(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  ink_assert(vol->mutex->thread_holding == this_ethread());
+  Dir old, *last_collision = nullptr;
+
+  // An earlier copy may still be around, make sure the probe finds this one.
+  while (dir_probe(&first_key, vol, &old, &last_collision) && dir_delete(&first_key, vol, &old)) {
+    last_collision = nullptr;
+  }
+  dir_insert(&first_key, vol, &dir);
+  SET_HANDLER(&CacheVC::tierPromotePublish);
+  return handleEvent(EVENT_IMMEDIATE, nullptr);
+}
+
+// Point reads at the copy, which needs the home stripe lock.
+int
+CacheVC::tierPromotePublish(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  CACHE_TRY_LOCK(lock, tier_home->mutex, mutex->thread_holding);
+  if (!lock.is_locked()) {
+    VC_SCHED_LOCK_RETRY();
+  }
+  trigger = nullptr;
+  cache_tier_publish(tier_home, &first_key);
+  return free_CacheVC(this);
+}
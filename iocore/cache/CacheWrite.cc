@@ -216,10 +216,7 @@ CacheVC::handleWrite(int event, Event * /* e ATS_UNUSED */)
   } else {
     vol->agg.enqueue(this);
   }
-  if (!vol->is_io_in_progress()) {
-    return vol->aggWrite(event, this);
-  }
-  return EVENT_CONT;
+  return vol->aggWrite(event, this);
 }
 
 static char *
@@ -334,7 +331,7 @@ Vol::aggWriteDone(int event, Event *e)
     if (header->write_pos + EVACUATION_SIZE > scan_pos) {
       periodic_scan();
     }
-    agg_buf_pos = 0;
+    agg_write_len = 0;
     header->write_serial++;
   } else {
     // delete all the directory entries that we inserted
@@ -344,15 +341,18 @@ Vol::aggWriteDone(int event, Event *e)
           hash_text.get(), (uint64_t)io.aiocb.aio_offset, (uint64_t)io.aiocb.aio_offset + io.aiocb.aio_nbytes,
           (uint64_t)io.aiocb.aio_offset / CACHE_BLOCK_SIZE,
           (uint64_t)(io.aiocb.aio_offset + io.aiocb.aio_nbytes) / CACHE_BLOCK_SIZE);
+    // and in the one filled behind it, which can't be written there now
     Dir del_dir;
     dir_clear(&del_dir);
-    for (int done = 0; done < agg_buf_pos;) {
-      Doc *doc = (Doc *)(agg_buffer + done);
+    for (int done = 0; done < agg_write_len + agg_buf_pos;) {
+      Doc *doc = (Doc *)(done < agg_write_len ? agg_write_buffer + done : agg_buffer + done - agg_write_len);
       dir_set_offset(&del_dir, header->write_pos + done);
       dir_delete(&doc->key, this, &del_dir);
       done += round_to_approx_size(doc->len);
     }
-    agg_buf_pos = 0;
+    agg_write_len   = 0;
+    agg_buf_pos     = 0;
+    header->agg_pos = header->write_pos;
   }
   set_io_not_in_progress();
   // callback ready sync CacheVCs
@@ -369,7 +369,7 @@ Vol::aggWriteDone(int event, Event *e)
     dir_sync_waiting = false;
     cacheDirSync->handleEvent(EVENT_IMMEDIATE, nullptr);
   }
-  if (agg.head || sync.head) {
+  if (agg.head || sync.head || agg_buf_pos >= agg_write_size) {
     return aggWrite(event, e);
   }
   return EVENT_CONT;
@@ -741,7 +741,7 @@ static int
 agg_copy(char *p, CacheVC *vc)
 {
   Vol *vol = vc->vol;
-  off_t o  = vol->header->write_pos + vol->agg_buf_pos;
+  off_t o  = vol->header->write_pos + vol->agg_write_len + vol->agg_buf_pos;
 
   if (!vc->f.evacuator) {
     Doc *doc                   = (Doc *)p;
@@ -762,7 +762,7 @@ agg_copy(char *p, CacheVC *vc)
     doc->hlen        = vc->header_len;
     doc->doc_type    = vc->frag_type;
     doc->v_major     = CACHE_DB_MAJOR_VERSION;
-    doc->v_minor     = CACHE_DB_MINOR_VERSION;
+    doc->v_minor     = CACHE_DOC_MINOR_VERSION;
     doc->unused      = 0; // force this for forward compatibility.
     doc->total_len   = vc->total_len;
     doc->first_key   = vc->first_key;
@@ -967,16 +967,28 @@ Vol::agg_wrap()
    eventProcessor.schedule_xxx().
    Also, make sure that any functions called by this also use
    the eventProcessor to schedule events
+
+   There are two aggregation buffers. While one is being written at
+   header->write_pos the writers are copied into the other, which follows it
+   on disk, and called back, so a burst doesn't wait for the disk. Nothing
+   else is written until the first write completes, so there is still one
+   write in flight and it is never larger than AGG_SIZE. Writers that must
+   be called back only once their data is on disk are left for the next
+   buffer, as is everything while a directory sync waits for the buffers
+   to drain.
 */
 int
 Vol::aggWrite(int event, void * /* e ATS_UNUSED */)
 {
-  ink_assert(!is_io_in_progress());
-
   Que(CacheVC, link) tocall;
   CacheVC *c;
+  off_t end;
+  bool writing = is_io_in_progress();
 
   cancel_trigger();
+  if (!writing) {
+    agg_stalled = false;
+  }
 
 Lagain:
   // calculate length of aggregated write
@@ -984,10 +996,19 @@ Lagain:
     int writelen = c->agg_len;
     // [amc] this is checked multiple places, on here was it strictly less.
     ink_assert(writelen <= AGG_SIZE);
-    if (agg_buf_pos + writelen > AGG_SIZE || header->write_pos + agg_buf_pos + writelen > (skip + len)) {
+    if (header->write_pos + agg_write_len + agg_buf_pos + writelen > (skip + len)) {
       break;
     }
-    DDebug("agg_read", "copying: %d, %" PRIu64 ", key: %d", agg_buf_pos, header->write_pos + agg_buf_pos, c->first_key.slice32(0));
+    if (agg_buf_pos + writelen > AGG_SIZE || (writing && (dir_sync_waiting || (c->f.sync && c->f.use_first_key)))) {
+      if (writing && !agg_stalled) {
+        Vol *vol    = this;
+        agg_stalled = true;
+        CACHE_INCREMENT_DYN_STAT(cache_agg_write_stall_stat);
+      }
+      break;
+    }
+    DDebug("agg_read", "copying: %d, %" PRIu64 ", key: %d", agg_buf_pos, header->write_pos + agg_write_len + agg_buf_pos,
+           c->first_key.slice32(0));
     int wrotelen = agg_copy(agg_buffer + agg_buf_pos, c);
     ink_assert(writelen == wrotelen);
     agg_todo_size -= writelen;
@@ -1008,6 +1029,11 @@ Lagain:
     c = n;
   }
 
+  // the rest goes into this buffer once the other one is on disk
+  if (writing) {
+    goto Lwait;
+  }
+
   // if we got nothing...
   if (!agg_buf_pos) {
     if (!agg.head && !sync.head) { // nothing to get
@@ -1036,7 +1062,7 @@ Lagain:
   }
 
   // evacuate space
-  off_t end = header->write_pos + agg_buf_pos + EVACUATION_SIZE;
+  end = header->write_pos + agg_buf_pos + EVACUATION_SIZE;
   if (evac_range(header->write_pos, end, !header->phase) < 0) {
     goto Lwait;
   }
@@ -1048,7 +1074,7 @@ Lagain:
 
   // if agg.head, then we are near the end of the disk, so
   // write down the aggregation in whatever size it is.
-  if (agg_buf_pos < AGG_HIGH_WATER && !agg.head && !sync.head && !dir_sync_waiting) {
+  if (agg_buf_pos < agg_write_size && !agg.head && !sync.head && !dir_sync_waiting) {
     goto Lwait;
   }
 
@@ -1068,10 +1094,20 @@ Lagain:
   // set write limit
   header->agg_pos = header->write_pos + agg_buf_pos;
 
+  // fill the other buffer while this one is written
+  std::swap(agg_buffer, agg_write_buffer);
+  agg_write_len = agg_buf_pos;
+  agg_buf_pos   = 0;
+  {
+    Vol *vol = this;
+    CACHE_INCREMENT_DYN_STAT(cache_agg_write_count_stat);
+    CACHE_SUM_DYN_STAT(cache_agg_write_bytes_stat, agg_write_len);
+  }
+
   io.aiocb.aio_fildes = fd;
   io.aiocb.aio_offset = header->write_pos;
-  io.aiocb.aio_buf    = agg_buffer;
-  io.aiocb.aio_nbytes = agg_buf_pos;
+  io.aiocb.aio_buf    = agg_write_buffer;
+  io.aiocb.aio_nbytes = agg_write_len;
   io.action           = this;
   /*
     Callback on AIO thread so that we can issue a new write ASAP
@@ -1639,7 +1675,7 @@ Action *
 Cache::open_write(Continuation *cont, const CacheKey *key, CacheFragType frag_type, int options, time_t apin_in_cache,
                   const char *hostname, int host_len)
 {
-  if (!CacheProcessor::IsCacheReady(frag_type)) {
+  if (!CacheProcessor::IsCacheReady(frag_type) || !all_stripes_up()) {
     cont->handleEvent(CACHE_EVENT_OPEN_WRITE_FAILED, (void *)-ECACHE_NOT_READY);
     return ACTION_RESULT_DONE;
   }
@@ -1700,16 +1736,45 @@ Cache::open_write(Continuation *cont, const CacheKey *key, CacheFragType frag_ty
   }
 }
 
+// Write admission: count the request in the volume's sketch and admit the
+// object only once it has been asked for cache_config_admission_min_hits
+// times recently, so one hit wonders don't push popular objects off the disk.
+// Fails open if the volume is busy rather than waiting for its lock.
+bool
+cache_admit(Vol *vol, const CacheKey *key, ProxyMutex *mutex)
+{
+  if (cache_config_admission_min_hits <= 1 || !vol->sketch) {
+    return true;
+  }
+  CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+  if (!lock.is_locked()) {
+    return true;
+  }
+  vol->sketch->increment(key);
+  if (vol->sketch->frequency(key) >= cache_config_admission_min_hits) {
+    return true;
+  }
+  CACHE_INCREMENT_DYN_STAT(cache_write_not_admitted_stat);
+  return false;
+}
+
 // main entry point for writing of http documents
 Action *
 Cache::open_write(Continuation *cont, const CacheKey *key, CacheHTTPInfo *info, time_t apin_in_cache,
                   const CacheKey * /* key1 ATS_UNUSED */, CacheFragType type, const char *hostname, int host_len)
 {
-  if (!CacheProcessor::IsCacheReady(type)) {
+  if (!CacheProcessor::IsCacheReady(type) || !all_stripes_up()) {
     cont->handleEvent(CACHE_EVENT_OPEN_WRITE_FAILED, (void *)-ECACHE_NOT_READY);
     return ACTION_RESULT_DONE;
   }
 
+  // Updates of objects already in the cache are always admitted.
+  if ((!info || (uintptr_t)info == CACHE_ALLOW_MULTIPLE_WRITES) &&
+      !cache_admit(key_to_vol(key, hostname, host_len), key, cont->mutex.get())) {
+    cont->handleEvent(CACHE_EVENT_OPEN_WRITE_FAILED, (void *)-ECACHE_NOT_ADMITTED);
+    return ACTION_RESULT_DONE;
+  }
+
   ink_assert(caches[type] == this);
   intptr_t err      = 0;
   int if_writers    = (uintptr_t)info == CACHE_ALLOW_MULTIPLE_WRITES;
@@ -34,11 +34,16 @@
 #define CACHE_ALT_REMOVED -2
 
 static const uint8_t CACHE_DB_MAJOR_VERSION = 24;
-static const uint8_t CACHE_DB_MINOR_VERSION = 1;
+static const uint8_t CACHE_DB_MINOR_VERSION = 2;
 // This is used in various comparisons because otherwise if the minor version is 0,
 // the compile fails because the condition is always true or false. Running it through
 // VersionNumber prevents that.
 extern const VersionNumber CACHE_DB_VERSION;
+// Objects are still written in the 24.1 format, 24.2 only marks stripes
+// keyed by the Murmur3 URL hash. Objects older than this need their
+// headers fixed up when read.
+static const uint8_t CACHE_DOC_MINOR_VERSION = 1;
+extern const VersionNumber CACHE_DOC_VERSION;
 
 static const uint8_t CACHE_DIR_MAJOR_VERSION = 18;
 static const uint8_t CACHE_DIR_MINOR_VERSION = 0;
@@ -75,6 +75,7 @@ struct Span {
   int64_t offset; // used only if (file == true); in bytes
   unsigned hw_sector_size;
   unsigned alignment;
+  unsigned io_size; ///< Optimal write size reported by the device, 0 if unknown.
   span_diskid_t disk_id;
   int forced_volume_num; ///< Force span in to specific volume.
 private:
@@ -160,6 +161,7 @@ public:
       offset(0),
       hw_sector_size(DEFAULT_HW_SECTOR_SIZE),
       alignment(0),
+      io_size(0),
       forced_volume_num(-1),
       is_mmapable_internal(false),
       file_pathname(false)
@@ -36,8 +36,11 @@
 #include "I_Cache.h"
 #include "P_CacheDisk.h"
 #include "P_CacheDir.h"
+#include "P_CacheSketch.h"
 #include "P_RamCache.h"
+#include "P_CacheL0.h"
 #include "P_CacheVol.h"
+#include "P_CacheTier.h"
 #include "P_CacheInternal.h"
 #include "P_CacheHosting.h"
 #include "P_CacheHttp.h"
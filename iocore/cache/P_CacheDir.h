@@ -27,7 +27,6 @@
 #include "P_CacheHttp.h"
 
 struct Vol;
-struct InterimCacheVol;
 struct CacheVC;
 
 /*
@@ -55,6 +54,8 @@ struct CacheVC;
 
 #define SYNC_MAX_WRITE (2 * 1024 * 1024)
 #define SYNC_DELAY HRTIME_MSECONDS(500)
+#define DIR_DIRTY_BOTH 3 // Vol::dir_dirty, both copies are out of date
+#define DIR_MAY_CONTAIN_LINKS 64 // longest bucket chain dir_may_contain will walk
 #define DO_NOT_REMOVE_THIS 0
 
 // Debugging Options
@@ -265,14 +266,26 @@ struct CacheSync : public Continuation {
   size_t buflen;
   bool buf_huge;
   off_t writepos;
+  uint8_t *segments; // segments to write in this sync
+  int nsegments;
   AIOCallbackInternal io;
   Event *trigger;
   ink_hrtime start_time;
   int mainEvent(int event, Event *e);
   void aio_write(int fd, char *b, int n, off_t o);
+  int next_write(Vol *vol);
 
   CacheSync()
-    : Continuation(new_ProxyMutex()), vol_idx(0), buf(0), buflen(0), buf_huge(false), writepos(0), trigger(0), start_time(0)
+    : Continuation(new_ProxyMutex()),
+      vol_idx(0),
+      buf(0),
+      buflen(0),
+      buf_huge(false),
+      writepos(0),
+      segments(0),
+      nsegments(0),
+      trigger(0),
+      start_time(0)
   {
     SET_HANDLER(&CacheSync::mainEvent);
   }
@@ -283,6 +296,8 @@ struct CacheSync : public Continuation {
 void vol_init_dir(Vol *d);
 int dir_token_probe(const CacheKey *, Vol *, Dir *);
 int dir_probe(const CacheKey *, Vol *, Dir *, Dir **);
+bool dir_may_contain(const CacheKey *key, Vol *d);
+bool dir_lookup_lockless(const CacheKey *key, Vol *d, const Dir *dir);
 int dir_insert(const CacheKey *key, Vol *d, Dir *to_part);
 int dir_overwrite(const CacheKey *key, Vol *d, Dir *to_part, Dir *overwrite, bool must_overwrite = true);
 int dir_delete(const CacheKey *key, Vol *d, Dir *del);
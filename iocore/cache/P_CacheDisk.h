@@ -89,6 +89,7 @@ struct CacheDisk : public Continuation {
   off_t skip              = 0;
   off_t num_usable_blocks = 0;
   int hw_sector_size      = 0;
+  int io_size             = 0; // optimal write size of the device, 0 if unknown
   int fd                  = -1;
   off_t free_space        = 0;
   off_t wasted_space      = 0;
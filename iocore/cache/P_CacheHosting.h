@@ -183,6 +183,7 @@ struct ConfigVol {
   off_t size;
   bool in_percent;
   int percent;
+  int agg_write_size; ///< 0 for proxy.config.cache.agg_write_size
   CacheVol *cachep;
   LINK(ConfigVol, link);
 };
@@ -30,6 +30,8 @@
 #include "HTTP.h"
 #include "P_CacheHttp.h"
 
+#include <vector>
+
 struct EvacuationBlock;
 
 // Compilation Options
@@ -106,6 +108,11 @@ enum {
   cache_direntries_used_stat,
   cache_ram_cache_hits_stat,
   cache_ram_cache_misses_stat,
+  cache_l0_hits_stat,
+  cache_l0_misses_stat,
+  cache_tier_promotions_stat,
+  cache_tier_reads_stat,
+  cache_tier_fallbacks_stat,
   cache_pread_count_stat,
   cache_percent_full_stat,
   cache_lookup_active_stat,
@@ -118,6 +125,7 @@ enum {
   cache_write_success_stat,
   cache_write_failure_stat,
   cache_write_backlog_failure_stat,
+  cache_write_not_admitted_stat,
   cache_update_active_stat,
   cache_update_success_stat,
   cache_update_failure_stat,
@@ -130,12 +138,16 @@ enum {
   cache_scan_active_stat,
   cache_scan_success_stat,
   cache_scan_failure_stat,
+  cache_read_ahead_active_stat,
+  cache_read_ahead_success_stat,
+  cache_read_ahead_failure_stat,
   cache_directory_collision_count_stat,
   cache_single_fragment_document_count_stat,
   cache_two_fragment_document_count_stat,
   cache_three_plus_plus_fragment_document_count_stat,
   cache_read_busy_success_stat,
   cache_read_busy_failure_stat,
+  cache_read_lockless_miss_stat,
   cache_gc_bytes_evacuated_stat,
   cache_gc_frags_evacuated_stat,
   cache_write_bytes_stat,
@@ -146,6 +158,9 @@ enum {
   cache_directory_sync_count_stat,
   cache_directory_sync_time_stat,
   cache_directory_sync_bytes_stat,
+  cache_agg_write_count_stat,
+  cache_agg_write_bytes_stat,
+  cache_agg_write_stall_stat,
   /* AIO read/write error counters */
   cache_span_errors_read_stat,
   cache_span_errors_write_stat,
@@ -209,6 +224,7 @@ extern int cache_config_enable_checksum;
 extern int cache_config_alt_rewrite_max_size;
 extern int cache_config_read_while_writer;
 extern int cache_config_agg_write_backlog;
+extern int cache_config_ram_cache_algorithm;
 extern int cache_config_ram_cache_compress;
 extern int cache_config_ram_cache_compress_percent;
 extern int cache_config_ram_cache_use_seen_filter;
@@ -219,6 +235,11 @@ extern int cache_config_target_fragment_size;
 extern int cache_config_mutex_retry_delay;
 extern int cache_read_while_writer_retry_delay;
 extern int cache_config_read_while_writer_max_retries;
+extern int cache_config_admission_min_hits;
+extern int cache_config_admission_sketch_entries;
+extern int cache_config_incremental_open;
+extern int cache_config_agg_write_size;
+extern int cache_config_read_ahead_fragments;
 
 // CacheVC
 struct CacheVC : public CacheVConnection {
@@ -315,10 +336,16 @@ struct CacheVC : public CacheVConnection {
   int openReadStartEarliest(int event, Event *e);
   int openReadVecWrite(int event, Event *e);
   int openReadStartHead(int event, Event *e);
+  bool openReadFromL0(Ptr<IOBufferData> &data);
   int openReadFromWriter(int event, Event *e);
   int openReadFromWriterMain(int event, Event *e);
   int openReadFromWriterFailure(int event, Event *);
   int openReadChooseWriter(int event, Event *e);
+  int readAheadDone(int event, Event *e);
+  int readAheadWait(int event, Event *e);
+  void read_ahead_start();
+  void read_ahead_take();
+  void read_ahead_cancel();
 
   int openWriteCloseDir(int event, Event *e);
   int openWriteCloseHeadDone(int event, Event *e);
@@ -363,6 +390,8 @@ struct CacheVC : public CacheVConnection {
     io.aiocb.aio_fildes = AIO_AGG_WRITE_IN_PROGRESS;
   }
   int evacuateDocDone(int event, Event *e);
+  int tierPromoteDone(int event, Event *e);
+  int tierPromotePublish(int event, Event *e);
   int evacuateReadHead(int event, Event *e);
 
   void cancel_trigger();
@@ -465,6 +494,9 @@ struct CacheVC : public CacheVConnection {
   int fragment;
   int scan_msec_delay;
   CacheVC *write_vc;
+  CacheVC *read_ahead;        // reader: the next fragment read ahead, read ahead: the one after it
+  CacheVC *read_ahead_parent; // read ahead: the reader, nullptr once it has gone away
+  Vol *tier_home;             // tier promoter: the stripe the copy is of
   char *hostname;
   int host_len;
   int header_to_write_len;
@@ -494,6 +526,8 @@ struct CacheVC : public CacheVConnection {
       unsigned int hit_evacuate : 1;
       unsigned int compressed_in_ram : 1; // compressed state in ram cache
       unsigned int allow_empty_doc : 1;   // used for cache empty http document
+      unsigned int l0_hit : 1;            // head served from the thread's L0 cache, no Vol state
+      unsigned int read_ahead_done : 1;   // read ahead: the fragment is in buf
     } f;
   };
   // BTF optimization used to skip reading stuff in cache partition that doesn't contain any
@@ -532,6 +566,7 @@ extern CacheSync *cacheDirSync;
 int cache_write(CacheVC *, CacheHTTPInfoVector *);
 int get_alternate_index(CacheHTTPInfoVector *cache_vector, CacheKey key);
 CacheVC *new_DocEvacuator(int nbytes, Vol *d);
+bool cache_admit(Vol *vol, const CacheKey *key, ProxyMutex *mutex);
 
 // inline Functions
 
@@ -951,7 +986,13 @@ struct Cache {
   int64_t cache_size; // in store block size
   CacheHostTable *hosttable;
   volatile int total_initialized_vol;
+  int total_header_vol;   // stripes whose directory header has been read
+  bool older_stripes;     // one of them was written by an older cache version
+  std::vector<CacheKey> recovering_removes; // removed before every stripe was up
   CacheType scheme;
+  ink_hrtime open_time;      // stripes started initializing
+  ink_hrtime ready_time;     // cache started serving
+  ink_hrtime recovered_time; // all stripes done
 
   int open(bool reconfigure, bool fix);
   int close();
@@ -976,12 +1017,25 @@ struct Cache {
                int host_len);
   Action *deref(Continuation *cont, const CacheKey *key, CacheFragType type, const char *hostname, int host_len);
 
-  void vol_initialized(bool result);
+  void vol_header_read(VersionNumber version);
+  void vol_initialized(Vol *vol, bool result);
 
   int open_done();
 
   Vol *key_to_vol(const CacheKey *key, const char *hostname, int host_len);
 
+  // Every stripe has been recovered. Before that, with incremental open, a
+  // key can map to another stripe once more stripes are up, and that stripe
+  // may hold the copy from before the restart. So writes and links fail
+  // until this is true, and removes also go to the other stripes, see
+  // remove_recovering().
+  bool
+  all_stripes_up() const
+  {
+    return total_initialized_vol == total_nvol;
+  }
+  void remove_recovering(const CacheKey *key, CacheFragType type, Vol *skip);
+
   Cache()
     : cache_read_done(0),
       total_good_nvol(0),
@@ -990,7 +1044,12 @@ struct Cache {
       cache_size(0), // in store block size
       hosttable(nullptr),
       total_initialized_vol(0),
-      scheme(CACHE_NONE_TYPE)
+      total_header_vol(0),
+      older_stripes(false),
+      scheme(CACHE_NONE_TYPE),
+      open_time(0),
+      ready_time(0),
+      recovered_time(0)
   {
   }
 };
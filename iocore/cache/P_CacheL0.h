@@ -0,0 +1,54 @@
+/** @file
+
+  Per thread cache of hot objects in front of the volume RAM cache
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#ifndef _P_CACHE_L0_H__
+#define _P_CACHE_L0_H__
+
+#include "I_Cache.h"
+
+struct Vol;
+struct Dir;
+
+// The L0 cache is a small direct mapped table per event thread holding the
+// first Doc of single fragment HTTP objects that were already RAM cache hits.
+// It is consulted in Cache::open_read before the volume lock is taken, so a
+// hit never waits for the Vol.
+//
+// Each entry remembers the directory entry its Doc was read through. A hit
+// walks the key's bucket chain without the lock (see dir_lookup_lockless)
+// and only counts if that entry is still there, so an entry is dropped once
+// its object is rewritten, updated, removed or overwritten on disk, while
+// writes of other keys leave it alone.
+
+extern int cache_config_ram_cache_l0_entries;
+extern int cache_config_ram_cache_l0_cutoff;
+
+void cache_l0_init();
+bool cache_l0_get(const CacheKey *key, Vol *vol, Ptr<IOBufferData> &data);
+// Must be called with the volume lock held, dir is the entry data was read
+// through and data is the unmarshalled Doc.
+void cache_l0_put(const CacheKey *key, Vol *vol, const Dir *dir, IOBufferData *data);
+// The directory was reinitialized, offsets in it may be reused.
+void cache_l0_invalidate_all();
+
+#endif /* _P_CACHE_L0_H__ */
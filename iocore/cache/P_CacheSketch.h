@@ -0,0 +1,100 @@
+/** @file
+
+  Count-Min sketch of recent cache key popularity
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#ifndef _P_CACHE_SKETCH_H__
+#define _P_CACHE_SKETCH_H__
+
+#include "I_Cache.h"
+
+#define CACHE_SKETCH_MIN_WORDS 64
+#define CACHE_SKETCH_MAX_COUNT 15
+
+// Count-Min sketch with four hash functions over one table of 4 bit
+// saturating counters, 16 to a word and one word per expected entry. All
+// counters are halved after 10 increments per expected entry, so the counts
+// follow a shifting workload.
+//
+// One per volume is shared by the write admission filter and the TinyLFU RAM
+// cache, both of which only touch it with the volume lock held.
+struct CacheFrequencySketch {
+  uint64_t *table     = nullptr;
+  uint64_t mask       = 0;
+  int64_t additions   = 0;
+  int64_t sample_size = 0;
+
+  void
+  init(int64_t entries)
+  {
+    int64_t words = CACHE_SKETCH_MIN_WORDS;
+    while (words < entries) {
+      words <<= 1;
+    }
+    ats_free(table);
+    table       = (uint64_t *)ats_calloc(words, sizeof(uint64_t));
+    mask        = words - 1;
+    additions   = 0;
+    sample_size = words * 10;
+  }
+
+  // Word index (low bits) and counter within the word (bits 48-51) of row i
+  static uint64_t
+  hash(const CacheKey *key, int i)
+  {
+    uint64_t h = key->u64[0] + i * key->u64[1];
+    return h ^ (h >> 29);
+  }
+
+  int
+  frequency(const CacheKey *key) const
+  {
+    int f = CACHE_SKETCH_MAX_COUNT;
+    for (int i = 0; i < 4; i++) {
+      uint64_t h = hash(key, i);
+      int c      = (table[h & mask] >> (((h >> 48) & 15) << 2)) & 15;
+      f          = c < f ? c : f;
+    }
+    return f;
+  }
+
+  void
+  increment(const CacheKey *key)
+  {
+    bool added = false;
+    for (int i = 0; i < 4; i++) {
+      uint64_t h = hash(key, i);
+      int shift  = ((h >> 48) & 15) << 2;
+      if (((table[h & mask] >> shift) & 15) < CACHE_SKETCH_MAX_COUNT) {
+        table[h & mask] += (uint64_t)1 << shift;
+        added = true;
+      }
+    }
+    if (added && ++additions >= sample_size) {
+      for (uint64_t w = 0; w <= mask; w++) {
+        table[w] = (table[w] >> 1) & 0x7777777777777777ULL;
+      }
+      additions /= 2;
+    }
+  }
+};
+
+#endif /* _P_CACHE_SKETCH_H__ */
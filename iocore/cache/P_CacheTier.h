@@ -0,0 +1,123 @@
+/** @file
+
+  Promotion of popular objects to a fast storage tier
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#ifndef _P_CACHE_TIER_H__
+#define _P_CACHE_TIER_H__
+
+#include "I_Cache.h"
+
+struct Vol;
+struct CacheVC;
+
+// The stripes of the volume named by proxy.config.cache.tier.volume (usually
+// spans on SSD or NVMe forced to it in storage.config) form a fast tier. They
+// are left out of the generic volume hash, and each other HTTP stripe (its
+// home) is paired with one of them.
+//
+// When a single fragment, single alternate object has been read from its home
+// stripe often enough (by the stripe's frequency sketch), its Doc is copied to
+// the paired fast stripe and its key is recorded in the home stripe's promotion
+// table. Cache::open_read consults the table before probing, so a lookup still
+// costs one directory probe: in the fast stripe if promoted, in the home stripe
+// if not.
+//
+// The home copy is never removed. A promoted key is dropped from the table as
+// soon as its home directory entry changes (write, update or delete), so a
+// stale copy is never served, and when the fast stripe overwrites the copy a
+// read falls back to the home stripe. Hot copies are kept in the fast tier by
+// the usual hit evacuation as it wraps.
+//
+// While the copy waits in the fast stripe's aggregation buffer its slot holds
+// the inverted key, so reads keep using the home stripe without taking the
+// promotion for a lost copy. The key is published once the copy is in the
+// fast stripe's directory. Slots are only changed with the home stripe
+// locked, reads look at them without the lock.
+
+extern int cache_config_tier_volume;
+extern int cache_config_tier_promote_hits;
+
+// Pair home stripes with fast ones, called once all stripes are up.
+void cache_tier_init();
+// The stripe holding key, vol if it hasn't been promoted.
+Vol *cache_tier_lookup(Vol *vol, const CacheKey *key, ProxyMutex *mutex);
+// The promoted copy of key is gone, read it from vol from now on.
+void cache_tier_forget(Vol *vol, const CacheKey *key, ProxyMutex *mutex);
+// Called with the home stripe lock held when a complete object has been read
+// from it into vc->buf.
+void cache_tier_promote(CacheVC *vc);
+
+inline uint64_t *
+cache_tier_slot(Vol *vol, const CacheKey *key)
+{
+  return &vol->tier_keys[key->slice32(1) & vol->tier_mask];
+}
+
+// Slot value of a promotion that isn't in the fast stripe's directory yet.
+// Flipping the key also flips its slot bits, so no key can be mistaken for
+// another's pending promotion.
+inline uint64_t
+cache_tier_pending(const CacheKey *key)
+{
+  return ~key->u64[0];
+}
+
+// The following are called with the home stripe lock held.
+
+// Start promoting key, false if it is already promoted or pending.
+inline bool
+cache_tier_begin(Vol *vol, const CacheKey *key)
+{
+  uint64_t *slot = cache_tier_slot(vol, key);
+  if (*slot == key->u64[0] || *slot == cache_tier_pending(key)) {
+    return false;
+  }
+  __atomic_store_n(slot, cache_tier_pending(key), __ATOMIC_RELEASE);
+  return true;
+}
+
+// The copy of key is in the fast stripe's directory, send reads there unless
+// the home entry changed meanwhile. False if the copy is of no use.
+inline bool
+cache_tier_publish(Vol *vol, const CacheKey *key)
+{
+  uint64_t *slot = cache_tier_slot(vol, key);
+  if (*slot != cache_tier_pending(key)) {
+    return false;
+  }
+  __atomic_store_n(slot, key->u64[0], __ATOMIC_RELEASE);
+  return true;
+}
+
+// The directory entry for key changed.
+inline void
+cache_tier_invalidate(Vol *vol, const CacheKey *key)
+{
+  if (vol->tier_keys) {
+    uint64_t *slot = cache_tier_slot(vol, key);
+    if (*slot == key->u64[0] || *slot == cache_tier_pending(key)) {
+      __atomic_store_n(slot, 0, __ATOMIC_RELEASE);
+    }
+  }
+}
+
+#endif /* _P_CACHE_TIER_H__ */
@@ -50,8 +50,11 @@
 #define LOOKASIDE_SIZE 256
 #define EVACUATION_BUCKET_SIZE (2 * EVACUATION_SIZE) // 16MB
 #define RECOVERY_SIZE EVACUATION_SIZE                // 8MB
+#define DIR_READ_CHUNK_SIZE (8 * 1024 * 1024)        // directory read at startup
+#define DIR_READ_CHUNKS_IN_FLIGHT 8
 #define AIO_NOT_IN_PROGRESS 0
 #define AIO_AGG_WRITE_IN_PROGRESS -1
+#define AIO_READ_AHEAD_IN_PROGRESS -2 // waiting for a fragment read ahead, see CacheVC::readAheadWait
 #define AUTO_SIZE_RAM_CACHE -1                               // 1-1 with directory size
 #define DEFAULT_TARGET_FRAGMENT_SIZE (1048576 - sizeof(Doc)) // 1MB
 
@@ -72,6 +75,7 @@ struct CacheDisk;
 struct VolInitInfo;
 struct DiskVol;
 struct CacheVol;
+struct CacheFrequencySketch;
 
 struct VolHeaderFooter {
   unsigned int magic;
@@ -126,6 +130,8 @@ struct Vol : public Continuation {
 
   char *raw_dir           = nullptr;
   Dir *dir                = nullptr;
+  uint8_t *dir_dirty      = nullptr; // per segment, bit n set if changed since directory copy n was written
+  uint32_t *dir_seq       = nullptr; // per segment, odd while the segment is being changed
   VolHeaderFooter *header = nullptr;
   VolHeaderFooter *footer = nullptr;
   int segments            = 0;
@@ -143,14 +149,19 @@ struct Vol : public Continuation {
   Queue<CacheVC, Continuation::Link_link> agg;
   Queue<CacheVC, Continuation::Link_link> stat_cache_vcs;
   Queue<CacheVC, Continuation::Link_link> sync;
-  char *agg_buffer  = nullptr;
-  int agg_todo_size = 0;
-  int agg_buf_pos   = 0;
+  char *agg_buffer       = nullptr; // being filled
+  char *agg_write_buffer = nullptr; // being written, see Vol::aggWrite
+  int agg_todo_size      = 0;
+  int agg_buf_pos        = 0;
+  int agg_write_len      = 0;              // bytes of agg_write_buffer in flight at header->write_pos
+  int agg_write_size     = AGG_HIGH_WATER; // write once this much is buffered
+  bool agg_stalled       = false; // writers are waiting for both buffers
 
   Event *trigger = nullptr;
 
   OpenDir open_dir;
   RamCache *ram_cache            = nullptr;
+  CacheFrequencySketch *sketch   = nullptr; // admission and promotion history, see P_CacheSketch.h
   int evacuate_size              = 0;
   DLL<EvacuationBlock> *evacuate = nullptr;
   DLL<EvacuationBlock> lookaside[LOOKASIDE_SIZE];
@@ -161,6 +172,9 @@ struct Vol : public Continuation {
   CacheDisk *disk            = nullptr;
   Cache *cache               = nullptr;
   CacheVol *cache_vol        = nullptr;
+  Vol *tier_vol              = nullptr; // fast stripe to promote to, see P_CacheTier.h
+  uint64_t *tier_keys        = nullptr; // promoted keys, direct mapped
+  uint32_t tier_mask         = 0;
   uint32_t last_sync_serial  = 0;
   uint32_t last_write_serial = 0;
   uint32_t sector_size       = 0;
@@ -168,6 +182,7 @@ struct Vol : public Continuation {
   bool dir_sync_waiting      = false;
   bool dir_sync_in_progress  = false;
   bool writing_end_marker    = false;
+  bool recovering            = false; // not in the volume hash yet, see Cache::vol_initialized
 
   CacheKey first_fragment_key;
   int64_t first_fragment_offset = 0;
@@ -195,6 +210,8 @@ struct Vol : public Continuation {
   int init(char *s, off_t blocks, off_t dir_skip, bool clear);
 
   int handle_dir_clear(int event, void *data);
+  int read_dir(off_t pos);
+  bool read_dir_chunk(AIOCallback *op);
   int handle_dir_read(int event, void *data);
   int handle_recover_from_data(int event, void *data);
   int handle_recover_write_dir(int event, void *data);
@@ -245,13 +262,19 @@ struct Vol : public Continuation {
 
   Vol() : Continuation(new_ProxyMutex())
   {
-    open_dir.mutex = mutex;
-    agg_buffer     = (char *)ats_memalign(ats_pagesize(), AGG_SIZE);
+    open_dir.mutex   = mutex;
+    agg_buffer       = (char *)ats_memalign(ats_pagesize(), AGG_SIZE);
+    agg_write_buffer = (char *)ats_memalign(ats_pagesize(), AGG_SIZE);
     memset(agg_buffer, 0, AGG_SIZE);
+    memset(agg_write_buffer, 0, AGG_SIZE);
     SET_HANDLER(&Vol::aggWrite);
   }
 
-  ~Vol() { ats_memalign_free(agg_buffer); }
+  ~Vol()
+  {
+    ats_memalign_free(agg_buffer);
+    ats_memalign_free(agg_write_buffer);
+  }
 };
 
 struct AIO_Callback_handler : public Continuation {
@@ -350,7 +373,7 @@ vol_out_of_phase_write_valid(Vol *d, Dir *e)
 TS_INLINE int
 vol_in_phase_valid(Vol *d, Dir *e)
 {
-  return (dir_offset(e) - 1 < ((d->header->write_pos + d->agg_buf_pos - d->start) / CACHE_BLOCK_SIZE));
+  return (dir_offset(e) - 1 < ((d->header->write_pos + d->agg_write_len + d->agg_buf_pos - d->start) / CACHE_BLOCK_SIZE));
 }
 
 TS_INLINE off_t
@@ -380,7 +403,8 @@ vol_dir_segment(Vol *d, int s)
 TS_INLINE int
 vol_in_phase_agg_buf_valid(Vol *d, Dir *e)
 {
-  return (vol_offset(d, e) >= d->header->write_pos && vol_offset(d, e) < (d->header->write_pos + d->agg_buf_pos));
+  return (vol_offset(d, e) >= d->header->write_pos &&
+          vol_offset(d, e) < (d->header->write_pos + d->agg_write_len + d->agg_buf_pos));
 }
 // length of the partition not including the offset of location 0.
 TS_INLINE off_t
@@ -0,0 +1,327 @@
+/** @file
+
+  A brief file description
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+// Window TinyLFU (W-TinyLFU) replacement policy, size aware.
+//
+// New objects enter a small LRU window (1% of the bytes). Objects falling out
+// of the window compete for a place in the main cache, a segmented LRU split
+// into probation (20%) and protected (80%) segments: the candidate is admitted
+// only if a Count-Min sketch of recent accesses says it is more popular than
+// every object that would have to be evicted to make room for it. A hit in
+// probation promotes to protected. The sketch (P_CacheSketch.h) is aged by
+// halving every counter periodically, so one-time scans (video segments, large
+// downloads) pass through the window without flushing the main cache. It is
+// the volume's if write admission is on, so both see the same history.
+
+#include "P_Cache.h"
+
+enum {
+  TINYLFU_WINDOW,
+  TINYLFU_PROBATION,
+  TINYLFU_PROTECTED,
+  TINYLFU_QUEUES,
+};
+
+struct RamCacheTinyLFUEntry {
+  INK_MD5 key;
+  uint32_t auxkey1;
+  uint32_t auxkey2;
+  uint32_t size; // bytes charged for this entry
+  int queue;
+  LINK(RamCacheTinyLFUEntry, lru_link);
+  LINK(RamCacheTinyLFUEntry, hash_link);
+  Ptr<IOBufferData> data;
+};
+
+#define ENTRY_OVERHEAD 128 // per-entry overhead to consider when computing sizes
+#define WINDOW_PERCENT 1
+#define PROTECTED_PERCENT 80
+#define SKETCH_BYTES_PER_ENTRY 4096 // assumed average object size, for sizing a private sketch
+
+struct RamCacheTinyLFU : public RamCache {
+  int64_t max_bytes             = 0;
+  int64_t window_bytes          = 0; // target sizes of the window, protected and whole main cache
+  int64_t protected_bytes       = 0;
+  int64_t main_bytes            = 0;
+  int64_t bytes[TINYLFU_QUEUES] = {0, 0, 0};
+  int64_t objects               = 0;
+
+  // returns 1 on found/stored, 0 on not found/stored, if provided auxkey1 and auxkey2 must match
+  int get(INK_MD5 *key, Ptr<IOBufferData> *ret_data, uint32_t auxkey1 = 0, uint32_t auxkey2 = 0) override;
+  int put(INK_MD5 *key, IOBufferData *data, uint32_t len, bool copy = false, uint32_t auxkey1 = 0, uint32_t auxkey2 = 0) override;
+  int fixup(const INK_MD5 *key, uint32_t old_auxkey1, uint32_t old_auxkey2, uint32_t new_auxkey1, uint32_t new_auxkey2) override;
+  int64_t size() const override;
+
+  void init(int64_t max_bytes, Vol *vol) override;
+
+  // private
+  CacheFrequencySketch own_sketch;
+  CacheFrequencySketch *sketch = nullptr; // the volume's, if it has one
+  Que(RamCacheTinyLFUEntry, lru_link) lru[TINYLFU_QUEUES];
+  DList(RamCacheTinyLFUEntry, hash_link) *bucket = nullptr;
+  int nbuckets = 0;
+  int ibuckets = 0;
+  Vol *vol     = nullptr;
+
+  void resize_hashtable();
+  void move(RamCacheTinyLFUEntry *e, int queue);
+  void admit(RamCacheTinyLFUEntry *e);
+  RamCacheTinyLFUEntry *remove(RamCacheTinyLFUEntry *e);
+};
+
+int64_t
+RamCacheTinyLFU::size() const
+{
+  int64_t s = 0;
+  for (int q = 0; q < TINYLFU_QUEUES; q++) {
+    forl_LL(RamCacheTinyLFUEntry, e, lru[q])
+    {
+      s += sizeof(*e);
+      s += sizeof(*e->data);
+      s += e->data->block_size();
+    }
+  }
+  return s;
+}
+
+ClassAllocator<RamCacheTinyLFUEntry> ramCacheTinyLFUEntryAllocator("RamCacheTinyLFUEntry");
+
+static const int bucket_sizes[] = {127,     251,      509,      1021,     2039,      4093,      8191,     16381,
+                                   32749,   65521,    131071,   262139,   524287,    1048573,   2097143,  4194301,
+                                   8388593, 16777213, 33554393, 67108859, 134217689, 268435399, 536870909};
+
+void
+RamCacheTinyLFU::resize_hashtable()
+{
+  int anbuckets = bucket_sizes[ibuckets];
+  DDebug("ram_cache", "resize hashtable %d", anbuckets);
+  int64_t s = anbuckets * sizeof(DList(RamCacheTinyLFUEntry, hash_link));
+  DList(RamCacheTinyLFUEntry, hash_link) *new_bucket = (DList(RamCacheTinyLFUEntry, hash_link) *)ats_malloc(s);
+  memset(new_bucket, 0, s);
+  if (bucket) {
+    for (int64_t i = 0; i < nbuckets; i++) {
+      RamCacheTinyLFUEntry *e = nullptr;
+      while ((e = bucket[i].pop())) {
+        new_bucket[e->key.slice32(3) % anbuckets].push(e);
+      }
+    }
+    ats_free(bucket);
+  }
+  bucket   = new_bucket;
+  nbuckets = anbuckets;
+}
+
+void
+RamCacheTinyLFU::init(int64_t abytes, Vol *avol)
+{
+  vol             = avol;
+  max_bytes       = abytes;
+  window_bytes    = max_bytes * WINDOW_PERCENT / 100;
+  main_bytes      = max_bytes - window_bytes;
+  protected_bytes = main_bytes * PROTECTED_PERCENT / 100;
+  DDebug("ram_cache", "initializing ram_cache %" PRId64 " bytes", abytes);
+  if (!max_bytes) {
+    return;
+  }
+  if (vol && vol->sketch) {
+    sketch = vol->sketch;
+  } else {
+    own_sketch.init(max_bytes / SKETCH_BYTES_PER_ENTRY);
+    sketch = &own_sketch;
+  }
+  resize_hashtable();
+}
+
+void
+RamCacheTinyLFU::move(RamCacheTinyLFUEntry *e, int queue)
+{
+  lru[e->queue].remove(e);
+  bytes[e->queue] -= e->size;
+  e->queue = queue;
+  lru[queue].enqueue(e);
+  bytes[queue] += e->size;
+}
+
+int
+RamCacheTinyLFU::get(INK_MD5 *key, Ptr<IOBufferData> *ret_data, uint32_t auxkey1, uint32_t auxkey2)
+{
+  if (!max_bytes) {
+    return 0;
+  }
+  sketch->increment(key);
+  uint32_t i              = key->slice32(3) % nbuckets;
+  RamCacheTinyLFUEntry *e = bucket[i].head;
+  while (e) {
+    if (e->key == *key && e->auxkey1 == auxkey1 && e->auxkey2 == auxkey2) {
+      if (e->queue == TINYLFU_PROBATION) {
+        move(e, TINYLFU_PROTECTED);
+        while (bytes[TINYLFU_PROTECTED] > protected_bytes) {
+          move(lru[TINYLFU_PROTECTED].head, TINYLFU_PROBATION);
+        }
+      } else {
+        move(e, e->queue);
+      }
+      (*ret_data) = e->data;
+      DDebug("ram_cache", "get %X %d %d HIT", key->slice32(3), auxkey1, auxkey2);
+      CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_hits_stat, 1);
+      return 1;
+    }
+    e = e->hash_link.next;
+  }
+  DDebug("ram_cache", "get %X %d %d MISS", key->slice32(3), auxkey1, auxkey2);
+  CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_misses_stat, 1);
+  return 0;
+}
+
+RamCacheTinyLFUEntry *
+RamCacheTinyLFU::remove(RamCacheTinyLFUEntry *e)
+{
+  RamCacheTinyLFUEntry *ret = e->hash_link.next;
+  uint32_t b                = e->key.slice32(3) % nbuckets;
+  bucket[b].remove(e);
+  lru[e->queue].remove(e);
+  bytes[e->queue] -= e->size;
+  CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_bytes_stat, -(int64_t)e->size);
+  DDebug("ram_cache", "put %X %d %d FREED", e->key.slice32(3), e->auxkey1, e->auxkey2);
+  e->data = nullptr;
+  THREAD_FREE(e, ramCacheTinyLFUEntryAllocator, this_thread());
+  objects--;
+  return ret;
+}
+
+// e just fell out of the window, either move it to probation or drop it.
+void
+RamCacheTinyLFU::admit(RamCacheTinyLFUEntry *e)
+{
+  int64_t need = bytes[TINYLFU_PROBATION] + bytes[TINYLFU_PROTECTED] + e->size - main_bytes;
+
+  if (need > 0) {
+    int freq                = sketch->frequency(&e->key);
+    RamCacheTinyLFUEntry *v = lru[TINYLFU_PROBATION].head;
+    int q                   = TINYLFU_PROBATION;
+
+    // Everything that would have to go must be less popular than e
+    for (int64_t freed = 0; freed < need; v = v->lru_link.next) {
+      if (!v) {
+        if (q == TINYLFU_PROTECTED) {
+          break;
+        }
+        q = TINYLFU_PROTECTED;
+        v = lru[q].head;
+        if (!v) {
+          break;
+        }
+      }
+      if (sketch->frequency(&v->key) >= freq) {
+        DDebug("ram_cache", "put %X %d %d REJECTED", e->key.slice32(3), e->auxkey1, e->auxkey2);
+        remove(e);
+        return;
+      }
+      freed += v->size;
+    }
+    while (need > 0) {
+      v = lru[TINYLFU_PROBATION].head ? lru[TINYLFU_PROBATION].head : lru[TINYLFU_PROTECTED].head;
+      if (!v) {
+        break;
+      }
+      need -= v->size;
+      remove(v);
+    }
+  }
+  move(e, TINYLFU_PROBATION);
+}
+
+// ignore 'copy' since we don't touch the data
+int
+RamCacheTinyLFU::put(INK_MD5 *key, IOBufferData *data, uint32_t len, bool, uint32_t auxkey1, uint32_t auxkey2)
+{
+  if (!max_bytes) {
+    return 0;
+  }
+  uint32_t i              = key->slice32(3) % nbuckets;
+  RamCacheTinyLFUEntry *e = bucket[i].head;
+  while (e) {
+    if (e->key == *key) {
+      if (e->auxkey1 == auxkey1 && e->auxkey2 == auxkey2) {
+        move(e, e->queue);
+        return 1;
+      } else { // discard when aux keys conflict
+        e = remove(e);
+        continue;
+      }
+    }
+    e = e->hash_link.next;
+  }
+  uint32_t size = ENTRY_OVERHEAD + data->block_size();
+  if (size > main_bytes) {
+    DDebug("ram_cache", "put %X %d %d len %d TOO BIG", key->slice32(3), auxkey1, auxkey2, len);
+    return 0;
+  }
+  e          = THREAD_ALLOC(ramCacheTinyLFUEntryAllocator, this_ethread());
+  e->key     = *key;
+  e->auxkey1 = auxkey1;
+  e->auxkey2 = auxkey2;
+  e->size    = size;
+  e->queue   = TINYLFU_WINDOW;
+  e->data    = data;
+  bucket[i].push(e);
+  lru[TINYLFU_WINDOW].enqueue(e);
+  bytes[TINYLFU_WINDOW] += size;
+  objects++;
+  CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_bytes_stat, size);
+  DDebug("ram_cache", "put %X %d %d INSERTED", key->slice32(3), auxkey1, auxkey2);
+  while (bytes[TINYLFU_WINDOW] > window_bytes) {
+    admit(lru[TINYLFU_WINDOW].head);
+  }
+  if (objects > nbuckets) {
+    ++ibuckets;
+    resize_hashtable();
+  }
+  return 1;
+}
+
+int
+RamCacheTinyLFU::fixup(const INK_MD5 *key, uint32_t old_auxkey1, uint32_t old_auxkey2, uint32_t new_auxkey1,
+                       uint32_t new_auxkey2)
+{
+  if (!max_bytes) {
+    return 0;
+  }
+  uint32_t i              = key->slice32(3) % nbuckets;
+  RamCacheTinyLFUEntry *e = bucket[i].head;
+  while (e) {
+    if (e->key == *key && e->auxkey1 == old_auxkey1 && e->auxkey2 == old_auxkey2) {
+      e->auxkey1 = new_auxkey1;
+      e->auxkey2 = new_auxkey2;
+      return 1;
+    }
+    e = e->hash_link.next;
+  }
+  return 0;
+}
+
+RamCache *
+new_RamCacheTinyLFU()
+{
+  return new RamCacheTinyLFU;
+}
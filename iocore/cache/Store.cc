@@ -527,6 +527,7 @@ Span::init(const char *path, int64_t size)
     this->file_pathname  = true;
     this->hw_sector_size = geometry.blocksz;
     this->alignment      = geometry.alignsz;
+    this->io_size        = geometry.iosz;
     this->blocks         = geometry.totalsz / STORE_BLOCK_SIZE;
 
     break;
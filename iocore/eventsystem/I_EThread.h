@@ -299,6 +299,14 @@ public:
   static constexpr int NO_ETHREAD_ID = -1;
   int id                             = NO_ETHREAD_ID;
   unsigned int event_types           = 0;
+
+  /** Passes through the event loop of a regular thread, bumped by the thread at the start of each pass.
+
+      Nothing a handler does can hold on to a pointer across a pass, so once this has changed any
+      pointer the thread loaded before is dead. Only this thread writes it, others read it to find
+      out when a retired object can no longer be in use.
+  */
+  uint64_t loop_passes = 0;
   bool is_event_type(EventType et);
   void set_event_type(EventType et);
 
@@ -177,6 +177,7 @@ EThread::execute()
       if (unlikely(shutdown_event_system == true)) {
         return;
       }
+      __atomic_store_n(&loop_passes, loop_passes + 1, __ATOMIC_RELEASE);
       // execute all the available external events that have
       // already been dequeued
       cur_time = Thread::get_hrtime_updated();
@@ -142,6 +142,7 @@ struct SSLConfig {
   static SSLConfigParams *acquire();
   static void release(SSLConfigParams *params);
   typedef ConfigProcessor::scoped_config<SSLConfig, SSLConfigParams> scoped_config;
+  friend scoped_config;
 
 private:
   static int configid;
@@ -154,6 +155,7 @@ struct SSLCertificateConfig {
   static void release(SSLCertLookup *params);
 
   typedef ConfigProcessor::scoped_config<SSLCertificateConfig, SSLCertLookup> scoped_config;
+  friend scoped_config;
 
 private:
   static int configid;
@@ -185,6 +187,7 @@ struct SSLTicketKeyConfig {
   }
 
   typedef ConfigProcessor::scoped_config<SSLTicketKeyConfig, SSLTicketParams> scoped_config;
+  friend scoped_config;
 
 private:
   static int configid;
@@ -332,6 +332,13 @@ HttpRequestData::get_client_ip()
   return nullptr;
 }
 
+const char *
+HttpRequestData::get_match_string(int *)
+{
+  ink_assert(false);
+  return nullptr;
+}
+
 SslAPIHooks *ssl_hooks = nullptr;
 StatPagesManager statPagesManager;
 
@@ -166,6 +166,12 @@ struct RecRawStat {
   uint32_t version;
 };
 
+// A sum/count pair, as aggregated over all threads by the raw stat sync.
+struct RecRawStatTotal {
+  int64_t sum;
+  int64_t count;
+};
+
 // WARNING!  It's advised that developers do not modify the contents of
 // the RecRawStatBlock.  ^_^
 struct RecRawStatBlock {
@@ -174,6 +180,46 @@ struct RecRawStatBlock {
   int num_stats;          // number of stats in this block
   int max_stats;          // maximum number of stats for this block
   ink_mutex mutex;
+
+  RecRawStatTotal *thread_totals; // per-thread values summed at the start of a sync pass
+  bool in_sync_pass;              // thread_totals are valid for the current sync pass
+  RecRawStatTotal *snapshot[2];   // double-buffered globals published after each sync pass
+  volatile uint64_t snapshot_gen; // snapshot seqlock, snapshot[snapshot_gen & 1] is current
+  RecRawStatBlock *next;          // all allocated blocks, walked by the sync
+};
+
+namespace ts
+{
+struct LogHistogram;
+}
+struct RecRecord;
+
+// Records derived from each histogram, in registration order.
+enum RecHistogramRecordT {
+  REC_HISTOGRAM_COUNT,
+  REC_HISTOGRAM_SUM,
+  REC_HISTOGRAM_P50,
+  REC_HISTOGRAM_P90,
+  REC_HISTOGRAM_P99,
+  REC_HISTOGRAM_P999,
+  REC_HISTOGRAM_MAX,
+  REC_HISTOGRAM_NUM_RECORDS
+};
+
+// Number of raw stat syncs the percentiles and max are computed over, one
+// minute at the default sync interval.
+#define REC_HISTOGRAM_WINDOW 12
+
+// Per-thread histograms, merged into the globals by the raw stat sync.
+struct RecHistogramBlock {
+  off_t ethr_hist_offset;    // thread local histogram storage
+  ts::LogHistogram *global;  // histograms merged over all threads, as of the last sync
+  ts::LogHistogram *window;  // REC_HISTOGRAM_WINDOW per sync intervals per histogram
+  int window_slot;           // interval the next sync writes to
+  RecRecord **records;       // REC_HISTOGRAM_NUM_RECORDS derived records per histogram
+  int max_histograms;        // maximum number of histograms for this block
+  ink_mutex mutex;           // protects global
+  RecHistogramBlock *next;   // all allocated blocks, walked by the sync
 };
 
 //-------------------------------------------------------------------------
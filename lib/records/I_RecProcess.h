@@ -26,6 +26,7 @@
 
 #include "I_RecCore.h"
 #include "I_EventSystem.h"
+#include "ts/LogHistogram.h"
 
 //-------------------------------------------------------------------------
 // Initialization/Starting
@@ -51,6 +52,18 @@ int _RecRegisterRawStat(RecRawStatBlock *rsb, RecT rec_type, const char *name, R
 #define RecRegisterRawStat(rsb, rec_type, name, data_type, persist_type, id, sync_cb) \
   _RecRegisterRawStat((rsb), (rec_type), (name), (data_type), REC_PERSISTENCE_TYPE(persist_type), (id), (sync_cb))
 
+//-------------------------------------------------------------------------
+// Histogram Registration
+//-------------------------------------------------------------------------
+RecHistogramBlock *RecAllocateHistogramBlock(int num_histograms);
+
+// Registers the records derived from histogram @a id, named @a name with the
+// suffixes .count, .sum, .p50, .p90, .p99, .p999 and .max. The count and sum
+// cover the life of the process, the percentiles and max only the last
+// REC_HISTOGRAM_WINDOW syncs. Derived records are never persistent, since
+// percentiles can't be rebuilt from persisted values.
+int RecRegisterHistogram(RecHistogramBlock *rhb, RecT rec_type, const char *name, int id);
+
 // RecRawStatRange* RecAllocateRawStatRange (int num_buckets);
 
 // int RecRegisterRawStatRange (RecRawStatRange *rsr,
@@ -91,6 +104,11 @@ int RecSetRawStatCount(RecRawStatBlock *rsb, int id, int64_t data);
 int RecGetRawStatSum(RecRawStatBlock *rsb, int id, int64_t *data);
 int RecGetRawStatCount(RecRawStatBlock *rsb, int id, int64_t *data);
 
+// Lock-free read of the sum and count published by the last raw stat sync.
+// The pair always comes from the same sync pass. Returns REC_ERR_FAIL if no
+// sync has completed yet.
+int RecGetRawStatSnapshot(RecRawStatBlock *rsb, int id, RecRawStatTotal *total);
+
 //-------------------------------------------------------------------------
 // Global RawStat Items (e.g. same as above, but no thread-local behavior)
 //-------------------------------------------------------------------------
@@ -108,6 +126,15 @@ RecRawStat *RecGetGlobalRawStatPtr(RecRawStatBlock *rsb, int id);
 int64_t *RecGetGlobalRawStatSumPtr(RecRawStatBlock *rsb, int id);
 int64_t *RecGetGlobalRawStatCountPtr(RecRawStatBlock *rsb, int id);
 
+//-------------------------------------------------------------------------
+// Histogram Recording/Getting
+//-------------------------------------------------------------------------
+inline int RecHistogramRecord(RecHistogramBlock *rhb, EThread *ethread, int id, int64_t value);
+
+// Copies out histogram @a id as merged by the last sync. The buckets are
+// cumulative, callers wanting an interval subtract an earlier copy.
+int RecGetHistogram(RecHistogramBlock *rhb, int id, ts::LogHistogram *data);
+
 //-------------------------------------------------------------------------
 // RecIncrRawStatXXX
 //-------------------------------------------------------------------------
@@ -157,4 +184,18 @@ RecIncrRawStatCount(RecRawStatBlock *rsb, EThread *ethread, int id, int64_t incr
   return REC_ERR_OKAY;
 }
 
+// Histograms are thread local and updated without atomics, just like the
+// RecIncrRawStatXXX calls. Negative values are recorded as 0.
+inline int
+RecHistogramRecord(RecHistogramBlock *rhb, EThread *ethread, int id, int64_t value)
+{
+  ink_assert((id >= 0) && (id < rhb->max_histograms));
+  if (ethread == nullptr) {
+    ethread = this_ethread();
+  }
+  ts::LogHistogram *tlp = (reinterpret_cast<ts::LogHistogram *>(reinterpret_cast<char *>(ethread) + rhb->ethr_hist_offset)) + id;
+  tlp->record(value < 0 ? 0 : static_cast<uint64_t>(value));
+  return REC_ERR_OKAY;
+}
+
 #endif /* !_I_REC_PROCESS_H_ */
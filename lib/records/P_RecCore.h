@@ -98,4 +98,8 @@ void RecDumpRecordsHt(RecT rec_type = RECT_NULL);
 
 void RecDumpRecords(RecT rec_type, RecDumpEntryCb callback, void *edata);
 
+// As RecDumpRecords(), but raw sum and count stats are read from the last
+// sync's snapshot instead of under each record's lock.
+void RecDumpRecordsSnapshot(RecT rec_type, RecDumpEntryCb callback, void *edata);
+
 #endif
@@ -35,7 +35,9 @@
 // This is for the internal stats and configs, as well as API stats. We currently use
 // about 1600 stats + configs for the core, but we're allocating 2000 for some growth.
 // TODO: if/when we switch to a new config system, we should make this run-time dynamic.
-#define REC_MAX_RECORDS (2000 + TS_MAX_API_STATS)
+// Each API histogram is exposed as REC_HISTOGRAM_NUM_RECORDS derived stats.
+#define TS_MAX_API_HISTOGRAMS 32
+#define REC_MAX_RECORDS (2000 + TS_MAX_API_STATS + TS_MAX_API_HISTOGRAMS * REC_HISTOGRAM_NUM_RECORDS)
 
 #define REC_CONFIG_UPDATE_INTERVAL_MS 3000
 #define REC_REMOTE_SYNC_INTERVAL_MS 5000
@@ -38,5 +38,6 @@
 //-------------------------------------------------------------------------
 
 int RecExecRawStatSyncCbs();
+int RecExecHistogramSync();
 
 #endif
@@ -0,0 +1,228 @@
+/** @file
+
+  Record histogram support.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "P_RecCore.h"
+#include "P_RecProcess.h"
+
+namespace
+{
+inline ts::LogHistogram *
+thread_histogram(EThread *et, RecHistogramBlock *rhb, int id)
+{
+  return (reinterpret_cast<ts::LogHistogram *>(reinterpret_cast<char *>(et) + rhb->ethr_hist_offset)) + id;
+}
+
+const char *const derived_suffix[REC_HISTOGRAM_NUM_RECORDS] = {".count", ".sum", ".p50", ".p90", ".p99", ".p999", ".max"};
+}
+
+static RecHistogramBlock *histogram_blocks = nullptr;
+static ink_mutex histogram_blocks_mutex    = PTHREAD_MUTEX_INITIALIZER;
+
+//-------------------------------------------------------------------------
+// histogram_derived_value
+//-------------------------------------------------------------------------
+// The count and sum are counters over the whole process life @a total, the
+// percentiles and max are gauges over the recent @a window.
+static int64_t
+histogram_derived_value(const ts::LogHistogram &total, const ts::LogHistogram &h, int which)
+{
+  switch (which) {
+  case REC_HISTOGRAM_COUNT:
+    return total.count;
+  case REC_HISTOGRAM_SUM:
+    return total.sum;
+  case REC_HISTOGRAM_P50:
+    return h.percentile(0.50);
+  case REC_HISTOGRAM_P90:
+    return h.percentile(0.90);
+  case REC_HISTOGRAM_P99:
+    return h.percentile(0.99);
+  case REC_HISTOGRAM_P999:
+    return h.percentile(0.999);
+  case REC_HISTOGRAM_MAX:
+    return h.max();
+  default:
+    ink_assert(!"Unexpected histogram record");
+    return 0;
+  }
+}
+
+//-------------------------------------------------------------------------
+// histogram_sync
+//-------------------------------------------------------------------------
+static void
+histogram_sync(RecHistogramBlock *rhb, int id)
+{
+  ts::LogHistogram total;
+  ts::LogHistogram recent;
+
+  // sum the thread local histograms, the threads keep writing without any
+  // synchronization so this is as consistent as the raw stat sums are.
+  total.clear();
+  for (EThread *et : eventProcessor.active_ethreads()) {
+    total.merge(*thread_histogram(et, rhb, id));
+  }
+
+  for (EThread *et : eventProcessor.active_dthreads()) {
+    total.merge(*thread_histogram(et, rhb, id));
+  }
+
+  // what was recorded since the last sync replaces the oldest interval
+  ts::LogHistogram *window = rhb->window + id * REC_HISTOGRAM_WINDOW;
+
+  {
+    ink_scoped_mutex_lock lock(rhb->mutex);
+    window[rhb->window_slot] = total;
+    window[rhb->window_slot].subtract(rhb->global[id]);
+    rhb->global[id] = total;
+  }
+
+  recent.clear();
+  for (int i = 0; i < REC_HISTOGRAM_WINDOW; ++i) {
+    recent.merge(window[i]);
+  }
+
+  for (int i = 0; i < REC_HISTOGRAM_NUM_RECORDS; ++i) {
+    RecRecord *r = rhb->records[id * REC_HISTOGRAM_NUM_RECORDS + i];
+
+    rec_mutex_acquire(&(r->lock));
+    RecDataSetFromInk64(r->data_type, &(r->data), histogram_derived_value(total, recent, i));
+    r->sync_required = REC_SYNC_REQUIRED;
+    rec_mutex_release(&(r->lock));
+  }
+}
+
+//-------------------------------------------------------------------------
+// RecAllocateHistogramBlock
+//-------------------------------------------------------------------------
+RecHistogramBlock *
+RecAllocateHistogramBlock(int num_histograms)
+{
+  off_t ethr_hist_offset;
+  RecHistogramBlock *rhb;
+
+  // allocate thread-local histogram memory
+  if ((ethr_hist_offset = eventProcessor.allocate(num_histograms * sizeof(ts::LogHistogram))) == -1) {
+    return nullptr;
+  }
+
+  // create the histogram-block structure
+  rhb = (RecHistogramBlock *)ats_malloc(sizeof(RecHistogramBlock));
+  memset(rhb, 0, sizeof(RecHistogramBlock));
+
+  rhb->global  = (ts::LogHistogram *)ats_calloc(num_histograms, sizeof(ts::LogHistogram));
+  rhb->window  = (ts::LogHistogram *)ats_calloc(num_histograms * REC_HISTOGRAM_WINDOW, sizeof(ts::LogHistogram));
+  rhb->records = (RecRecord **)ats_calloc(num_histograms * REC_HISTOGRAM_NUM_RECORDS, sizeof(RecRecord *));
+
+  rhb->max_histograms   = num_histograms;
+  rhb->ethr_hist_offset = ethr_hist_offset;
+
+  ink_mutex_init(&(rhb->mutex));
+
+  ink_mutex_acquire(&histogram_blocks_mutex);
+  rhb->next        = histogram_blocks;
+  histogram_blocks = rhb;
+  ink_mutex_release(&histogram_blocks_mutex);
+
+  return rhb;
+}
+
+//-------------------------------------------------------------------------
+// RecRegisterHistogram
+//-------------------------------------------------------------------------
+int
+RecRegisterHistogram(RecHistogramBlock *rhb, RecT rec_type, const char *name, int id)
+{
+  Debug("stats", "RecRegisterHistogram(%s): rhb pointer:%p id:%d", name, rhb, id);
+
+  // check to see if we're good to proceed
+  ink_assert(id < rhb->max_histograms);
+
+  RecRecord *derived[REC_HISTOGRAM_NUM_RECORDS];
+  RecData data_default;
+  memset(&data_default, 0, sizeof(RecData));
+
+  for (int i = 0; i < REC_HISTOGRAM_NUM_RECORDS; ++i) {
+    char rec_name[256];
+    RecRecord *r;
+
+    snprintf(rec_name, sizeof(rec_name), "%s%s", name, derived_suffix[i]);
+    if ((r = RecRegisterStat(rec_type, rec_name, RECD_INT, data_default, RECP_NON_PERSISTENT)) == nullptr) {
+      return REC_ERR_FAIL;
+    }
+
+    if (i_am_the_record_owner(r->rec_type)) {
+      r->sync_required = r->sync_required | REC_PEER_SYNC_REQUIRED;
+    } else {
+      send_register_message(r);
+    }
+    derived[i] = r;
+  }
+
+  // only publish the records once all of them exist, the sync skips unregistered slots
+  ink_scoped_mutex_lock lock(rhb->mutex);
+  memcpy(&rhb->records[id * REC_HISTOGRAM_NUM_RECORDS], derived, sizeof(derived));
+
+  return REC_ERR_OKAY;
+}
+
+//-------------------------------------------------------------------------
+// RecGetHistogram
+//-------------------------------------------------------------------------
+int
+RecGetHistogram(RecHistogramBlock *rhb, int id, ts::LogHistogram *data)
+{
+  ink_assert((id >= 0) && (id < rhb->max_histograms));
+
+  ink_scoped_mutex_lock lock(rhb->mutex);
+  *data = rhb->global[id];
+  return REC_ERR_OKAY;
+}
+
+//-------------------------------------------------------------------------
+// RecExecHistogramSync
+//-------------------------------------------------------------------------
+int
+RecExecHistogramSync()
+{
+  ink_mutex_acquire(&histogram_blocks_mutex);
+  RecHistogramBlock *blocks = histogram_blocks;
+  ink_mutex_release(&histogram_blocks_mutex);
+
+  for (RecHistogramBlock *rhb = blocks; rhb; rhb = rhb->next) {
+    for (int id = 0; id < rhb->max_histograms; ++id) {
+      bool registered;
+
+      {
+        ink_scoped_mutex_lock lock(rhb->mutex);
+        registered = rhb->records[id * REC_HISTOGRAM_NUM_RECORDS] != nullptr;
+      }
+      if (registered) {
+        histogram_sync(rhb, id);
+      }
+    }
+    rhb->window_slot = (rhb->window_slot + 1) % REC_HISTOGRAM_WINDOW;
+  }
+
+  return REC_ERR_OKAY;
+}
@@ -144,6 +144,7 @@ struct raw_stat_sync_cont : public Continuation {
   exec_callbacks(int /* event */, Event * /* e */)
   {
     RecExecRawStatSyncCbs();
+    RecExecHistogramSync();
     Debug("statsproc", "raw_stat_sync_cont() processed");
 
     return EVENT_CONT;
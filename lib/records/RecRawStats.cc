@@ -37,6 +37,87 @@ thread_stat(EThread *et, RecRawStatBlock *rsb, int id)
 {
   return (reinterpret_cast<RecRawStat *>(reinterpret_cast<char *>(et) + rsb->ethr_stat_offset)) + id;
 }
+
+// Add one thread's whole stat block into @a totals. The thread block is contiguous, so this
+// is a single linear pass the compiler can vectorize, rather than one pointer chase per stat.
+inline void
+thread_stat_accumulate(RecRawStatTotal *totals, const RecRawStat *tlp, int n)
+{
+  for (int i = 0; i < n; ++i) {
+    totals[i].sum += tlp[i].sum;
+    totals[i].count += tlp[i].count;
+  }
+}
+}
+
+// All raw stat blocks, so a sync pass can aggregate each block once instead of once per stat.
+static RecRawStatBlock *raw_stat_blocks = nullptr;
+static ink_mutex raw_stat_blocks_mutex  = PTHREAD_MUTEX_INITIALIZER;
+
+//-------------------------------------------------------------------------
+// raw_stat_sync_begin
+//-------------------------------------------------------------------------
+static void
+raw_stat_sync_begin(RecRawStatBlock *rsb)
+{
+  ink_scoped_mutex_lock lock(rsb->mutex);
+  RecRawStatTotal *totals = rsb->thread_totals;
+
+  memset(totals, 0, rsb->max_stats * sizeof(RecRawStatTotal));
+  for (EThread *et : eventProcessor.active_ethreads()) {
+    thread_stat_accumulate(totals, thread_stat(et, rsb, 0), rsb->max_stats);
+  }
+
+  for (EThread *et : eventProcessor.active_dthreads()) {
+    thread_stat_accumulate(totals, thread_stat(et, rsb, 0), rsb->max_stats);
+  }
+
+  rsb->in_sync_pass = true;
+}
+
+//-------------------------------------------------------------------------
+// raw_stat_sync_end
+//-------------------------------------------------------------------------
+// Publish the synced globals into the inactive snapshot buffer and flip the
+// generation. Readers that raced with the flip notice the change and retry.
+static void
+raw_stat_sync_end(RecRawStatBlock *rsb)
+{
+  ink_scoped_mutex_lock lock(rsb->mutex);
+  uint64_t gen           = rsb->snapshot_gen;
+  RecRawStatTotal *snap  = rsb->snapshot[(gen + 1) & 1];
+  RecRawStat *const *raw = rsb->global;
+
+  for (int i = 0; i < rsb->max_stats; ++i) {
+    if (raw[i]) {
+      snap[i].sum   = raw[i]->sum;
+      snap[i].count = raw[i]->count;
+    } else {
+      snap[i].sum   = 0;
+      snap[i].count = 0;
+    }
+  }
+
+  __atomic_store_n(&rsb->snapshot_gen, gen + 1, __ATOMIC_RELEASE);
+  rsb->in_sync_pass = false;
+}
+
+//-------------------------------------------------------------------------
+// raw_stat_get_snapshot
+//-------------------------------------------------------------------------
+static bool
+raw_stat_get_snapshot(RecRawStatBlock *rsb, int id, RecRawStatTotal *total)
+{
+  uint64_t gen;
+
+  ink_assert((id >= 0) && (id < rsb->max_stats));
+  do {
+    gen    = __atomic_load_n(&rsb->snapshot_gen, __ATOMIC_ACQUIRE);
+    *total = rsb->snapshot[gen & 1][id];
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  } while (gen != __atomic_load_n(&rsb->snapshot_gen, __ATOMIC_RELAXED));
+
+  return gen != 0;
 }
 
 static int
@@ -80,27 +161,33 @@ raw_stat_sync_to_global(RecRawStatBlock *rsb, int id)
   total.sum   = 0;
   total.count = 0;
 
-  // sum the thread local values
-  for (EThread *et : eventProcessor.active_ethreads()) {
-    RecRawStat *tlp = thread_stat(et, rsb, id);
-    total.sum += tlp->sum;
-    total.count += tlp->count;
-  }
-
-  for (EThread *et : eventProcessor.active_dthreads()) {
-    RecRawStat *tlp = thread_stat(et, rsb, id);
-    total.sum += tlp->sum;
-    total.count += tlp->count;
-  }
-
-  if (total.sum < 0) { // Assure that we stay positive
-    total.sum = 0;
-  }
-
   // lock so the setting of the globals and last values are atomic
   {
     ink_scoped_mutex_lock lock(rsb->mutex);
 
+    if (rsb->in_sync_pass) {
+      // the thread local values were already summed for the whole block
+      total.sum   = rsb->thread_totals[id].sum;
+      total.count = rsb->thread_totals[id].count;
+    } else {
+      // sum the thread local values
+      for (EThread *et : eventProcessor.active_ethreads()) {
+        RecRawStat *tlp = thread_stat(et, rsb, id);
+        total.sum += tlp->sum;
+        total.count += tlp->count;
+      }
+
+      for (EThread *et : eventProcessor.active_dthreads()) {
+        RecRawStat *tlp = thread_stat(et, rsb, id);
+        total.sum += tlp->sum;
+        total.count += tlp->count;
+      }
+    }
+
+    if (total.sum < 0) { // Assure that we stay positive
+      total.sum = 0;
+    }
+
     // get the delta from the last sync
     RecRawStat delta;
     delta.sum   = total.sum - rsb->global[id]->last_sum;
@@ -134,6 +221,8 @@ raw_stat_clear(RecRawStatBlock *rsb, int id)
     ink_atomic_swap(&(rsb->global[id]->last_sum), (int64_t)0);
     ink_atomic_swap(&(rsb->global[id]->count), (int64_t)0);
     ink_atomic_swap(&(rsb->global[id]->last_count), (int64_t)0);
+    rsb->thread_totals[id].sum   = 0;
+    rsb->thread_totals[id].count = 0;
   }
   // reset the local stats
   for (EThread *et : eventProcessor.active_ethreads()) {
@@ -165,6 +254,7 @@ raw_stat_clear_sum(RecRawStatBlock *rsb, int id)
     ink_scoped_mutex_lock lock(rsb->mutex);
     ink_atomic_swap(&(rsb->global[id]->sum), (int64_t)0);
     ink_atomic_swap(&(rsb->global[id]->last_sum), (int64_t)0);
+    rsb->thread_totals[id].sum = 0;
   }
 
   // reset the local stats
@@ -195,6 +285,7 @@ raw_stat_clear_count(RecRawStatBlock *rsb, int id)
     ink_scoped_mutex_lock lock(rsb->mutex);
     ink_atomic_swap(&(rsb->global[id]->count), (int64_t)0);
     ink_atomic_swap(&(rsb->global[id]->last_count), (int64_t)0);
+    rsb->thread_totals[id].count = 0;
   }
 
   // reset the local stats
@@ -236,7 +327,17 @@ RecAllocateRawStatBlock(int num_stats)
   rsb->max_stats        = num_stats;
   rsb->ethr_stat_offset = ethr_stat_offset;
 
+  rsb->thread_totals = (RecRawStatTotal *)ats_calloc(num_stats, sizeof(RecRawStatTotal));
+  rsb->snapshot[0]   = (RecRawStatTotal *)ats_calloc(num_stats, sizeof(RecRawStatTotal));
+  rsb->snapshot[1]   = (RecRawStatTotal *)ats_calloc(num_stats, sizeof(RecRawStatTotal));
+
   ink_mutex_init(&(rsb->mutex));
+
+  ink_mutex_acquire(&raw_stat_blocks_mutex);
+  rsb->next       = raw_stat_blocks;
+  raw_stat_blocks = rsb;
+  ink_mutex_release(&raw_stat_blocks_mutex);
+
   return rsb;
 }
 
@@ -444,6 +545,12 @@ RecGetRawStatCount(RecRawStatBlock *rsb, int id, int64_t *data)
   return REC_ERR_OKAY;
 }
 
+int
+RecGetRawStatSnapshot(RecRawStatBlock *rsb, int id, RecRawStatTotal *total)
+{
+  return raw_stat_get_snapshot(rsb, id, total) ? REC_ERR_OKAY : REC_ERR_FAIL;
+}
+
 //-------------------------------------------------------------------------
 // RecIncrGlobalRawStatXXX
 //-------------------------------------------------------------------------
@@ -547,7 +654,8 @@ RecRegisterRawStatSyncCb(const char *name, RecRawStatSyncCb sync_cb, RecRawStatB
 
       r->stat_meta.sync_rsb = rsb;
       r->stat_meta.sync_id  = id;
-      r->stat_meta.sync_cb  = sync_cb;
+      // RecDumpRecordsSnapshot() reads these without the record lock
+      __atomic_store_n(&r->stat_meta.sync_cb, sync_cb, __ATOMIC_RELEASE);
 
       raw = RecGetGlobalRawStatPtr(r->stat_meta.sync_rsb, r->stat_meta.sync_id);
 
@@ -570,8 +678,18 @@ int
 RecExecRawStatSyncCbs()
 {
   RecRecord *r;
+  RecRawStatBlock *rsb;
   int i, num_records;
 
+  // Blocks are only ever prepended, so the list can be walked from a copy of the head.
+  ink_mutex_acquire(&raw_stat_blocks_mutex);
+  RecRawStatBlock *blocks = raw_stat_blocks;
+  ink_mutex_release(&raw_stat_blocks_mutex);
+
+  for (rsb = blocks; rsb; rsb = rsb->next) {
+    raw_stat_sync_begin(rsb);
+  }
+
   num_records = g_num_records;
   for (i = 0; i < num_records; i++) {
     r = &(g_records[i]);
@@ -590,9 +708,63 @@ RecExecRawStatSyncCbs()
     rec_mutex_release(&(r->lock));
   }
 
+  for (rsb = blocks; rsb; rsb = rsb->next) {
+    raw_stat_sync_end(rsb);
+  }
+
   return REC_ERR_OKAY;
 }
 
+//-------------------------------------------------------------------------
+// RecDumpRecordsSnapshot
+//-------------------------------------------------------------------------
+// The value of a plain sum or count stat as of the last sync, read from its
+// block's snapshot without the record lock. Returns false for any other
+// record, which has to be read under the lock.
+static bool
+raw_stat_get_snapshot_data(const RecRecord *r, RecData *data)
+{
+  RecRawStatSyncCb sync_cb;
+  RecRawStatTotal total;
+
+  if (!REC_TYPE_IS_STAT(r->rec_type)) {
+    return false;
+  }
+  sync_cb = __atomic_load_n(&r->stat_meta.sync_cb, __ATOMIC_ACQUIRE);
+  if (sync_cb != RecRawStatSyncSum && sync_cb != RecRawStatSyncCount) {
+    return false;
+  }
+  if (!raw_stat_get_snapshot(r->stat_meta.sync_rsb, r->stat_meta.sync_id, &total)) {
+    return false;
+  }
+
+  memset(data, 0, sizeof(RecData));
+  RecDataSetFromInk64(r->data_type, data, sync_cb == RecRawStatSyncSum ? total.sum : total.count);
+  return true;
+}
+
+void
+RecDumpRecordsSnapshot(RecT rec_type, RecDumpEntryCb callback, void *edata)
+{
+  int num_records = g_num_records;
+
+  for (int i = 0; i < num_records; i++) {
+    RecRecord *r = &(g_records[i]);
+    RecData snapshot;
+
+    if ((rec_type != RECT_NULL) && !(rec_type & r->rec_type)) {
+      continue;
+    }
+    if (raw_stat_get_snapshot_data(r, &snapshot)) {
+      callback(r->rec_type, edata, r->registered, r->name, r->data_type, &snapshot);
+    } else {
+      rec_mutex_acquire(&(r->lock));
+      callback(r->rec_type, edata, r->registered, r->name, r->data_type, &r->data);
+      rec_mutex_release(&(r->lock));
+    }
+  }
+}
+
 int
 RecRawStatUpdateSum(RecRawStatBlock *rsb, int id)
 {
@@ -29,10 +29,8 @@
  ****************************************************************************/
 #include "ts/ink_platform.h"
 #include "ts/ink_memory.h"
-#include "ts/DynArray.h"
 #include "ts/ink_inet.h"
 #include "ts/ink_assert.h"
-#include "ts/ink_hash_table.h"
 #include "ts/Tokenizer.h"
 #include "ts/HostLookup.h"
 #include "ts/MatcherUtils.h"
@@ -160,595 +158,47 @@ hostcmp(const char *c1, const char *c2)
   return 0;
 }
 
-// static const unsigned char asciiToTable[256]
-//
-//   Used to Map Legal hostname characters into
-//     to indexes used by char_table to
-//     index strings
-//
-//   Legal hostname characters are 0-9, A-Z, a-z and '-'
-//   '_' is also included although it is not in the spec (RFC 883)
-//
-//   Uppercase and lowercase "a-z" both map to same indexes
-//     since hostnames are not case sensative
-//
-//   Illegal characters map to 255
-//
-static const unsigned char asciiToTable[256] = {
-  255, 255, 255, 255, 255, 255, 255, 255, // 0 - 7
-  255, 255, 255, 255, 255, 255, 255, 255, // 8 - 15
-  255, 255, 255, 255, 255, 255, 255, 255, // 16 - 23
-  255, 255, 255, 255, 255, 255, 255, 255, // 24 - 31
-  255, 255, 255, 255, 255, 255, 255, 255, // 32 - 39
-  255, 255, 255, 255, 255, 0,   255, 255, // 40 - 47 ('-')
-  1,   2,   3,   4,   5,   6,   7,   8,   // 48 - 55 (0-7)
-  9,   10,  255, 255, 255, 255, 255, 255, // 56 - 63 (8-9)
-  255, 11,  12,  13,  14,  15,  16,  17,  // 64 - 71 (A-G)
-  18,  19,  20,  21,  22,  23,  24,  25,  // 72 - 79 (H-O)
-  26,  27,  28,  29,  30,  31,  32,  33,  // 80 - 87 (P-W)
-  34,  35,  36,  255, 255, 255, 255, 37,  // 88 - 95 (X-Z, '_')
-  255, 11,  12,  13,  14,  15,  16,  17,  // 96 - 103 (a-g)
-  18,  19,  20,  21,  22,  23,  24,  25,  // 104 - 111 (h-0)
-  26,  27,  28,  29,  30,  31,  32,  33,  // 112 - 119 (p-w)
-  34,  35,  36,  255, 255, 255, 255, 255, // 120 - 127 (x-z)
-  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
-  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
-  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
-  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
-  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255};
-
-// Number of legal characters in the acssiToTable array
-static const int numLegalChars = 38;
-
-// struct charIndex_el
-//
-//   Used by class charIndex.  Forms a single level
-//    in charIndex tree
-//
-struct charIndex_el {
-  charIndex_el();
-  ~charIndex_el();
-  HostBranch *branch_array[numLegalChars];
-  charIndex_el *next_level[numLegalChars];
-};
-
-charIndex_el::charIndex_el()
-{
-  memset(branch_array, 0, sizeof(branch_array));
-  memset(next_level, 0, sizeof(next_level));
-}
-
-charIndex_el::~charIndex_el()
-{
-  int i;
-
-  // Recursively delete all the lower levels of the
-  //   data structure
-  for (i = 0; i < numLegalChars; i++) {
-    if (next_level[i] != nullptr) {
-      delete next_level[i];
-    }
-  }
-}
-
-// struct charIndexIterInternal
-//
-//  An internal struct to charIndexIterState
-//    Stores the location of an element in
-//    class charIndex
-//
-struct charIndexIterInternal {
-  charIndex_el *ptr;
-  int index;
-};
-
-// Used as a default return element for DynArray in
-//   struct charIndexIterState
-static charIndexIterInternal default_iter = {nullptr, -1};
-
-// struct charIndexIterState
-//
-//    struct for the callee to keep interation state
-//      for class charIndex
-//
-struct charIndexIterState {
-  charIndexIterState();
-
-  // Where that level we are in interation
-  int cur_level;
-
-  // Where we got the last element from
-  int cur_index;
-  charIndex_el *cur_el;
-
-  //  Queue of the above levels
-  DynArray<charIndexIterInternal> q;
-};
-
-charIndexIterState::charIndexIterState() : cur_level(-1), cur_index(-1), cur_el(nullptr), q(&default_iter, 6)
-{
-}
-
-// class charIndex - A constant time string matcher intended for
-//    short strings in a sparsely populated DNS paritition
-//
-//    Creates a look up table for character in data string
-//
-//    Mapping from character to table index is done by
-//      asciiToTable[]
-//
-//    The illegalKey hash table is side structure for any
-//     entries that contain illegal hostname characters that
-//     we can not index into the normal table
-//
-//    Example: com
-//      c maps to 13, o maps to 25, m maps to 23
-//
-//                             charIndex_el         charIndex_el
-//                             -----------         ------------
-//                           0 |    |    |         |    |     |
-//                           . |    |    |         |    |     |
-//    charIndex_el           . |    |    |         |    |     |
-//    ----------             . |    |    |         |    |     |
-//  0 |   |    |             . |    |    |   |-->23| ptr|  0  |  (ptr is to the
-//  . |   |    |   |-------->25| 0  |   -----|     |    |     |   hostBranch for
-//  . |   |    |   |         . |    |    |         |    |     |   domain com)
-// 13 | 0 |  --|---|         . |    |    |         |    |     |
-//  . |   |    |             . |    |    |         |    |     |
-//  . |   |    |               |    |    |         |    |     |
-//  . |   |    |               |    |    |         |    |     |
-//    |   |    |               -----------         -----------|
-//    |   |    |
-//    |   |    |
-//    |   |    |
-//    |--------|
-//
-//
-//
-class charIndex
-{
-public:
-  charIndex();
-  ~charIndex();
-  void Insert(const char *match_data, HostBranch *toInsert);
-  HostBranch *Lookup(const char *match_data);
-  HostBranch *iter_first(charIndexIterState *s);
-  HostBranch *iter_next(charIndexIterState *s);
-
-private:
-  charIndex_el *root;
-  InkHashTable *illegalKey;
-};
-
-charIndex::charIndex() : illegalKey(nullptr)
-{
-  root = new charIndex_el;
-}
-
-charIndex::~charIndex()
-{
-  InkHashTableIteratorState ht_iter;
-  InkHashTableEntry *ht_entry = nullptr;
-  HostBranch *tmp;
-
-  delete root;
-
-  // Destroy the illegalKey hashtable if there is one and free
-  //   up all of its values
-  if (illegalKey != nullptr) {
-    ht_entry = ink_hash_table_iterator_first(illegalKey, &ht_iter);
-
-    while (ht_entry != nullptr) {
-      tmp = (HostBranch *)ink_hash_table_entry_value(illegalKey, ht_entry);
-      ink_assert(tmp != nullptr);
-      delete tmp;
-      ht_entry = ink_hash_table_iterator_next(illegalKey, &ht_iter);
-    }
-    ink_hash_table_destroy(illegalKey);
-  }
-}
-
-// void charIndex::Insert(const char* match_data, HostBranch* toInsert)
-//
-//   Places a binding for match_data to toInsert into the index
-//
-void
-charIndex::Insert(const char *match_data, HostBranch *toInsert)
-{
-  unsigned char index;
-  const char *match_start = match_data;
-  charIndex_el *cur       = root;
-  charIndex_el *next;
-
-  if (*match_data == '\0') {
-    // Should not happen
-    ink_assert(0);
-    return;
-  }
-
-  while (true) {
-    index = asciiToTable[(unsigned char)(*match_data)];
-
-    // Check to see if our index into table is for an
-    //  'illegal' DNS character
-    if (index == 255) {
-      // Insert into illgals hash table
-      if (illegalKey == nullptr) {
-        illegalKey = ink_hash_table_create(InkHashTableKeyType_String);
-      }
-      ink_hash_table_insert(illegalKey, (char *)match_start, toInsert);
-      break;
-    }
-
-    // Check to see if are at the level we supposed be at
-    if (*(match_data + 1) == '\0') {
-      // The slot should always be emtpy, no duplicate
-      //   keys are allowed
-      ink_assert(cur->branch_array[index] == nullptr);
-      cur->branch_array[index] = toInsert;
-      break;
-    } else {
-      // We need to find the next level in the table
-
-      next = cur->next_level[index];
-
-      // Check to see if we need to expand the table
-      if (next == nullptr) {
-        next                   = new charIndex_el;
-        cur->next_level[index] = next;
-      }
-      cur = next;
-    }
-    match_data++;
-  }
-}
-
-// HostBranch* charIndex::Lookup(const char* match_data)
-//
-//  Searches the charIndex on key match_data
-//    If there is a binding for match_data, returns a pointer to it
-//    otherwise a nullptr pointer is returned
-//
-HostBranch *
-charIndex::Lookup(const char *match_data)
-{
-  unsigned char index;
-  charIndex_el *cur = root;
-  void *hash_lookup;
-  const char *match_start = match_data;
-
-  if (root == nullptr || *match_data == '\0') {
-    return nullptr;
-  }
-
-  while (true) {
-    index = asciiToTable[(unsigned char)(*match_data)];
-
-    // Check to see if our index into table is for an
-    //  'illegal' DNS character
-    if (index == 255) {
-      if (illegalKey == nullptr) {
-        return nullptr;
-      } else {
-        if (ink_hash_table_lookup(illegalKey, (char *)match_start, &hash_lookup)) {
-          return (HostBranch *)hash_lookup;
-        } else {
-          return nullptr;
-        }
-      }
-    }
-    // Check to see if we are looking for the next level or
-    //    a HostBranch
-    if (*(match_data + 1) == '\0') {
-      return cur->branch_array[index];
-    } else {
-      cur = cur->next_level[index];
-
-      if (cur == nullptr) {
-        return nullptr;
-      }
-    }
-
-    match_data++;
-  }
-}
-
-//
-// HostBranch* charIndex::iter_next(charIndexIterState* s)
-//
-//    Initialize iterator state and returns the first element
-//     found in the charTable.  If none is found, nullptr
-//     is returned
-//
-HostBranch *
-charIndex::iter_first(charIndexIterState *s)
-{
-  s->cur_level = 0;
-  s->cur_index = -1;
-  s->cur_el    = root;
-
-  return iter_next(s);
-}
-
-//
-// HostBranch* charIndex::iter_next(charIndexIterState* s)
-//
-//    Finds the next element in the char index and returns
-//      a pointer to it.  If there are no more elements, nullptr
-//      is returned
-//
-HostBranch *
-charIndex::iter_next(charIndexIterState *s)
-{
-  int index;
-  charIndex_el *current_el = s->cur_el;
-  intptr_t level           = s->cur_level;
-  charIndexIterInternal stored_state;
-  HostBranch *r = nullptr;
-  bool first_element;
-
-  // bool first_element is used to tell if first elemente
-  //  pointed to by s has already been returned to caller
-  //  it has unless we are being called from iter_first
-  if (s->cur_index < 0) {
-    first_element = false;
-    index         = s->cur_index + 1;
-  } else {
-    first_element = true;
-    index         = s->cur_index;
-  }
-
-  while (true) {
-    // Check to see if we need to go back up a level
-    if (index >= numLegalChars) {
-      if (level <= 0) {
-        // No more levels so bail out
-        break;
-      } else {
-        // Go back up to a stored level
-        stored_state = s->q[level - 1];
-        ink_assert(stored_state.ptr != nullptr);
-        ink_assert(stored_state.index >= 0);
-        level--;
-        current_el = stored_state.ptr;
-        index      = stored_state.index + 1;
-      }
-    } else {
-      // Check to see if there is something to return
-      //
-      //  Note: we check for something to return before a descending
-      //    a level so that when we come back up we will
-      //    be done with this index
-      //
-      if (current_el->branch_array[index] != nullptr && first_element == false) {
-        r            = current_el->branch_array[index];
-        s->cur_level = level;
-        s->cur_index = index;
-        s->cur_el    = current_el;
-        break;
-      } else if (current_el->next_level[index] != nullptr) {
-        // There is a lower level to iterate over, store our
-        //   current state and descend
-        stored_state.ptr   = current_el;
-        stored_state.index = index;
-        s->q(level)        = stored_state;
-        current_el         = current_el->next_level[index];
-        index              = 0;
-        level++;
-      } else {
-        // Nothing here so advance to next index
-        index++;
-      }
-    }
-    first_element = false;
-  }
-
-  return r;
-}
-
-// class hostArray
-//
-//   Is a fixed size array for holding HostBrach*
-//   Allows only sequential access to data
-//
-
-// Since the only iter state is an index into the
-//   array typedef it
-using hostArrayIterState = int;
-
-class hostArray
-{
-public:
-  hostArray();
-  ~hostArray();
-  bool Insert(const char *match_data_in, HostBranch *toInsert);
-  HostBranch *Lookup(const char *match_data_in, bool bNotProcess);
-  HostBranch *iter_first(hostArrayIterState *s, char **key = nullptr);
-  HostBranch *iter_next(hostArrayIterState *s, char **key = nullptr);
-
-private:
-  int num_el; // number of elements currently in the array
-  HostBranch *branch_array[HOST_ARRAY_MAX];
-  char *match_data[HOST_ARRAY_MAX];
-};
-
-hostArray::hostArray() : num_el(0)
-{
-  memset(branch_array, 0, sizeof(branch_array));
-  memset(match_data, 0, sizeof(match_data));
-}
-
-hostArray::~hostArray()
-{
-  for (int i = 0; i < num_el; i++) {
-    ink_assert(branch_array[i] != nullptr);
-    ink_assert(match_data[i] != nullptr);
-    ats_free(match_data[i]);
-  }
-}
-
-// bool hostArray::Insert(const char* match_data_in, HostBranch* toInsert)
-//
-//    Places toInsert into the array with key match_data if there
-//     is adequate space, in which case true is returned
-//    If space is inadequate, false is returned and nothing is inserted
-//
-bool
-hostArray::Insert(const char *match_data_in, HostBranch *toInsert)
-{
-  if (num_el >= HOST_ARRAY_MAX) {
-    return false;
-  } else {
-    branch_array[num_el] = toInsert;
-    match_data[num_el]   = ats_strdup(match_data_in);
-    num_el++;
-    return true;
-  }
-}
-
-// HostBranch* hostArray::Lookup(const char* match_data_in)
-//
-//   Looks for key match_data_in.  If a binding is found,
-//     returns HostBranch* found to the key, otherwise
-//     nullptr is returned
-//
-HostBranch *
-hostArray::Lookup(const char *match_data_in, bool bNotProcess)
-{
-  HostBranch *r = nullptr;
-  char *pMD;
-
-  for (int i = 0; i < num_el; i++) {
-    pMD = match_data[i];
-
-    if (bNotProcess && '!' == *pMD) {
-      char *cp = ++pMD;
-      if ('\0' == *cp) {
-        continue;
-      }
-
-      if (strcmp(cp, match_data_in) != 0) {
-        r = branch_array[i];
-      } else {
-        continue;
-      }
-    }
-
-    else if (strcmp(match_data[i], match_data_in) == 0) {
-      r = branch_array[i];
-      break;
-    }
-  }
-  return r;
-}
+// maps enum LeafType to strings
+const char *LeafTypeStr[] = {"Leaf Invalid", "Host (Partial)", "Host (Full)", "Domain (Full)", "Domain (Partial)"};
 
-// HostBranch* hostArray::iter_first(hostArrayIterState* s) {
-//
-//   Initilizes s and returns the first element or
-//     nullptr if no elements exist
-//
-HostBranch *
-hostArray::iter_first(hostArrayIterState *s, char **key)
-{
-  *s = -1;
-  return iter_next(s, key);
-}
+// Initial number of slots in the child table, must be a power of 2
+static const int HOST_SLOTS_MIN = 64;
 
-// HostBranch* hostArray::iter_next(hostArrayIterState* s) {
+// static uint32_t label_hash(int parent, const char* label, int len)
 //
-//    Returns the next element in the hostArray or
-//      nullptr if none exist
+//   FNV-1a of the label, mixed with the parent so that the same
+//     label under different parents lands in different slots
 //
-HostBranch *
-hostArray::iter_next(hostArrayIterState *s, char **key)
+static inline uint32_t
+label_hash(int parent, const char *label, int len)
 {
-  (*s)++;
+  uint32_t h = 2166136261U;
 
-  if (*s < num_el) {
-    if (key != nullptr) {
-      *key = match_data[*s];
-    }
-    return branch_array[*s];
-  } else {
-    return nullptr;
+  for (int i = 0; i < len; i++) {
+    h = (h ^ static_cast<unsigned char>(label[i])) * 16777619U;
   }
+  h ^= static_cast<uint32_t>(parent) * 0x9E3779B1U;
+  return h ^ (h >> 16);
 }
 
-// maps enum LeafType to strings
-const char *LeafTypeStr[] = {"Leaf Invalid", "Host (Partial)", "Host (Full)", "Domain (Full)", "Domain (Partial)"};
-
-static int negative_one = -1;
-
-HostBranch::HostBranch() : level(0), type(HOST_TERMINAL), next_level(nullptr), leaf_indexs(&negative_one, 1)
+HostLookup::HostLookup(const char *name) : leaf_next(nullptr), leaf_array(nullptr), array_len(-1), num_el(-1), matcher_name(name)
 {
-}
+  HostBranch root;
 
-// HostBranch::~HostBranch()
-//
-//   Recursive delete all host branches below us
-//
-HostBranch::~HostBranch()
-{
-  // Hash Iteration
-  InkHashTable *ht;
-  InkHashTableIteratorState ht_iter;
-  InkHashTableEntry *ht_entry = nullptr;
-
-  // charIndex Iteration
-  charIndexIterState ci_iter;
-  charIndex *ci;
-
-  // hostArray Iteration
-  hostArray *ha;
-  hostArrayIterState ha_iter;
-
-  HostBranch *lower_branch;
-
-  switch (type) {
-  case HOST_TERMINAL:
-    ink_assert(next_level == nullptr);
-    break;
-  case HOST_HASH:
-    ink_assert(next_level != nullptr);
-    ht       = (InkHashTable *)next_level;
-    ht_entry = ink_hash_table_iterator_first(ht, &ht_iter);
-
-    while (ht_entry != nullptr) {
-      lower_branch = (HostBranch *)ink_hash_table_entry_value(ht, ht_entry);
-      delete lower_branch;
-      ht_entry = ink_hash_table_iterator_next(ht, &ht_iter);
-    }
-    ink_hash_table_destroy(ht);
-    break;
-  case HOST_INDEX:
-    ink_assert(next_level != nullptr);
-    ci           = (charIndex *)next_level;
-    lower_branch = ci->iter_first(&ci_iter);
-    while (lower_branch != nullptr) {
-      delete lower_branch;
-      lower_branch = ci->iter_next(&ci_iter);
-    }
-    delete ci;
-    break;
-  case HOST_ARRAY:
-    ink_assert(next_level != nullptr);
-    ha           = (hostArray *)next_level;
-    lower_branch = ha->iter_first(&ha_iter);
-    while (lower_branch != nullptr) {
-      delete lower_branch;
-      lower_branch = ha->iter_next(&ha_iter);
-    }
-    delete ha;
-    break;
-  }
-}
+  root.level        = 0;
+  root.parent       = -1;
+  root.label_offset = 0;
+  root.label_len    = 0;
+  root.first_child  = -1;
+  root.next_sibling = -1;
+  root.first_leaf   = -1;
+  root.last_leaf    = -1;
+  root.num_children = 0;
+  root.not_children = false;
+  branches.push_back(root);
 
-HostLookup::HostLookup(const char *name) : leaf_array(nullptr), array_len(-1), num_el(-1), matcher_name(name)
-{
-  root             = new HostBranch;
-  root->level      = 0;
-  root->type       = HOST_TERMINAL;
-  root->next_level = nullptr;
+  Slot empty = {0, -1};
+  slots.assign(HOST_SLOTS_MIN, empty);
 }
 
 HostLookup::~HostLookup()
@@ -760,8 +210,7 @@ HostLookup::~HostLookup()
     }
     delete[] leaf_array;
   }
-
-  delete root;
+  delete[] leaf_next;
 }
 
 static void
@@ -778,215 +227,143 @@ HostLookup::Print()
 void
 HostLookup::Print(HostLookupPrintFunc f)
 {
-  PrintHostBranch(root, f);
+  PrintHostBranch(0, f);
 }
 
 //
-// void HostLookup::PrintHostBranch(HostBranch* hb, HostLookupPrintFunc f)
+// void HostLookup::PrintHostBranch(int branch, HostLookupPrintFunc f)
 //
-//   Recursively traverse the matching tree rooted at arg hb
+//   Recursively traverse the matching tree rooted at arg branch
 //     and print out each element
 //
 void
-HostLookup::PrintHostBranch(HostBranch *hb, HostLookupPrintFunc f)
+HostLookup::PrintHostBranch(int branch, HostLookupPrintFunc f)
 {
-  // Hash iteration
-  InkHashTable *ht;
-  InkHashTableIteratorState ht_iter;
-  InkHashTableEntry *ht_entry = nullptr;
-
-  // charIndex Iteration
-  charIndexIterState ci_iter;
-  charIndex *ci;
-
-  // hostArray Iteration
-  hostArray *h_array;
-  hostArrayIterState ha_iter;
-
-  HostBranch *lower_branch;
-  intptr_t curIndex;
-  intptr_t i; // Loop var
-
-  for (i = 0; i < hb->leaf_indexs.length(); i++) {
-    curIndex = hb->leaf_indexs[i];
-    printf("\t\t%s for %s\n", LeafTypeStr[leaf_array[curIndex].type], leaf_array[curIndex].match);
-    f(leaf_array[curIndex].opaque_data);
+  for (int i = branches[branch].first_leaf; i != -1; i = leaf_next[i]) {
+    printf("\t\t%s for %s\n", LeafTypeStr[leaf_array[i].type], leaf_array[i].match);
+    f(leaf_array[i].opaque_data);
   }
 
-  switch (hb->type) {
-  case HOST_TERMINAL:
-    ink_assert(hb->next_level == nullptr);
-    break;
-  case HOST_HASH:
-    ink_assert(hb->next_level != nullptr);
-    ht       = (InkHashTable *)hb->next_level;
-    ht_entry = ink_hash_table_iterator_first(ht, &ht_iter);
-
-    while (ht_entry != nullptr) {
-      lower_branch = (HostBranch *)ink_hash_table_entry_value(ht, ht_entry);
-      PrintHostBranch(lower_branch, f);
-      ht_entry = ink_hash_table_iterator_next(ht, &ht_iter);
-    }
-    break;
-  case HOST_INDEX:
-    ink_assert(hb->next_level != nullptr);
-    ci           = (charIndex *)hb->next_level;
-    lower_branch = ci->iter_first(&ci_iter);
-    while (lower_branch != nullptr) {
-      PrintHostBranch(lower_branch, f);
-      lower_branch = ci->iter_next(&ci_iter);
-    }
-    break;
-  case HOST_ARRAY:
-    ink_assert(hb->next_level != nullptr);
-    h_array      = (hostArray *)hb->next_level;
-    lower_branch = h_array->iter_first(&ha_iter);
-    while (lower_branch != nullptr) {
-      PrintHostBranch(lower_branch, f);
-      lower_branch = h_array->iter_next(&ha_iter);
+  for (int child = branches[branch].first_child; child != -1; child = branches[child].next_sibling) {
+    PrintHostBranch(child, f);
+  }
+}
+
+//
+// void HostLookup::GrowSlots()
+//
+//   Double the child table and rehash everything into it
+//
+void
+HostLookup::GrowSlots()
+{
+  Slot empty = {0, -1};
+  std::vector<Slot> old(slots.size() * 2, empty);
+  uint32_t mask = old.size() - 1;
+
+  old.swap(slots);
+  for (const Slot &slot : old) {
+    if (slot.branch != -1) {
+      uint32_t i = slot.hash & mask;
+      while (slots[i].branch != -1) {
+        i = (i + 1) & mask;
+      }
+      slots[i] = slot;
     }
-    break;
   }
 }
 
 //
-// HostBranch* HostLookup::TableNewLevel(HostBranch* from, const char* level_data)
+// int HostLookup::InsertBranch(int parent, const char* level_data, int len)
 //
-//    Creates the next level structure in arg from
-//       Creates a HostBranch for level_data, inserts it in to the
-//         the next_level structure and returns a pointer to the new
-//         HostBranch
+//    Creates a new HostBranch for level_data below branch parent
+//      and returns its index
 //
-HostBranch *
-HostLookup::TableNewLevel(HostBranch *from, const char *level_data)
-{
-  hostArray *new_ha_table;
-  charIndex *new_ci_table;
+int
+HostLookup::InsertBranch(int parent, const char *level_data, int len)
+{
+  HostBranch b;
+  int idx = branches.size();
+
+  b.level        = branches[parent].level + 1;
+  b.parent       = parent;
+  b.label_offset = labels.size();
+  b.label_len    = len;
+  b.first_child  = -1;
+  b.next_sibling = branches[parent].first_child;
+  b.first_leaf   = -1;
+  b.last_leaf    = -1;
+  b.num_children = 0;
+  b.not_children = false;
+
+  labels.insert(labels.end(), level_data, level_data + len);
+  branches.push_back(b);
+  branches[parent].first_child = idx;
+  branches[parent].num_children++;
+  if (len > 0 && level_data[0] == '!') {
+    branches[parent].not_children = true;
+  }
 
-  ink_assert(from->type == HOST_TERMINAL);
+  // Keep the table at most half full
+  if (branches.size() * 2 > slots.size()) {
+    GrowSlots();
+  }
 
-  // Use the charIndex for high speed matching at the first level of
-  //   the table.  The first level is short strings, ie: com, edu, jp, fr
-  if (from->level == 0) {
-    new_ci_table     = new charIndex;
-    from->type       = HOST_INDEX;
-    from->next_level = new_ci_table;
-  } else {
-    new_ha_table     = new hostArray;
-    from->type       = HOST_ARRAY;
-    from->next_level = new_ha_table;
+  uint32_t mask = slots.size() - 1;
+  uint32_t h    = label_hash(parent, level_data, len);
+  uint32_t i    = h & mask;
+
+  while (slots[i].branch != -1) {
+    i = (i + 1) & mask;
   }
+  slots[i].hash   = h;
+  slots[i].branch = idx;
 
-  return InsertBranch(from, level_data);
+  return idx;
 }
 
+// int HostLookup::FindNextLevel(int parent, const char* level_data, int len,
+//                               bool bNotProcess)
 //
-// HostBranch* HostLookup::InsertBranch(HostBranch* insert_to, const char* level_data)
-//
+//   Searches for the branch below parent bound to level data
+//   If found returns its index, otherwise returns -1
 //
-//    Abstrction to place a new node for level_data below node
-//      insert to.  Inserts into any of the data types used by
-//      by class HostMatcher
+//   If bNotProcess is set and there is no exact match, a child
+//     bound to "!label" matches any level data other than "label".
+//     The most recently added such child wins.  As with the old
+//     hostArray, this only applies below the top level and while
+//     the parent has at most HOST_ARRAY_MAX children.  Past that
+//     "!label" is an ordinary label.
 //
-HostBranch *
-HostLookup::InsertBranch(HostBranch *insert_in, const char *level_data)
+int
+HostLookup::FindNextLevel(int parent, const char *level_data, int len, bool bNotProcess) const
 {
-  // Variables for moving an array into a hash table after it
-  //   gets too big
-  //
-  hostArray *ha;
-  hostArrayIterState ha_iter;
-  HostBranch *tmp;
-  char *key = nullptr;
-  InkHashTable *new_ht;
-
-  HostBranch *new_branch = new HostBranch;
-  new_branch->type       = HOST_TERMINAL;
-  new_branch->level      = insert_in->level + 1;
-  new_branch->next_level = nullptr;
-
-  switch (insert_in->type) {
-  case HOST_TERMINAL:
-    // Should not happen
-    ink_release_assert(0);
-    break;
-  case HOST_HASH:
-    ink_hash_table_insert((InkHashTable *)insert_in->next_level, (char *)level_data, new_branch);
-    break;
-  case HOST_INDEX:
-    ((charIndex *)insert_in->next_level)->Insert(level_data, new_branch);
-    break;
-  case HOST_ARRAY:
-    if (((hostArray *)insert_in->next_level)->Insert(level_data, new_branch) == false) {
-      // The array is out of space, time to move to a hash table
-      ha     = (hostArray *)insert_in->next_level;
-      new_ht = ink_hash_table_create(InkHashTableKeyType_String);
-      ink_hash_table_insert(new_ht, (char *)level_data, new_branch);
-
-      // Iterate through the existing elements in the array and
-      //  stuff them into the hash table
-      tmp = ha->iter_first(&ha_iter, &key);
-      ink_assert(tmp != nullptr);
-      while (tmp != nullptr) {
-        ink_assert(key != nullptr);
-        ink_hash_table_insert(new_ht, key, tmp);
-        tmp = ha->iter_next(&ha_iter, &key);
-      }
+  uint32_t mask = slots.size() - 1;
+  uint32_t h    = label_hash(parent, level_data, len);
 
-      // Ring out the old, ring in the new
-      delete ha;
-      insert_in->next_level = new_ht;
-      insert_in->type       = HOST_HASH;
+  for (uint32_t i = h & mask; slots[i].branch != -1; i = (i + 1) & mask) {
+    if (slots[i].hash == h) {
+      const HostBranch &b = branches[slots[i].branch];
+      if (b.parent == parent && b.label_len == len && memcmp(&labels[b.label_offset], level_data, len) == 0) {
+        return slots[i].branch;
+      }
     }
-    break;
   }
 
-  return new_branch;
-}
+  const HostBranch &p = branches[parent];
 
-// HostBranch* HostLookup::FindNextLevel(HostBranch* from,
-//                                       const char* level_data)
-//
-//   Searches in the branch for  the next level down in the search
-//     structure bound to level data
-//   If found returns a pointer to the next level HostBranch,
-//    otherwise returns nullptr
-//
-HostBranch *
-HostLookup::FindNextLevel(HostBranch *from, const char *level_data, bool bNotProcess)
-{
-  HostBranch *r = nullptr;
-  InkHashTable *hash;
-  charIndex *ci_table;
-  hostArray *ha_table;
-  void *lookup;
-
-  switch (from->type) {
-  case HOST_TERMINAL:
-    // Should not happen
-    ink_assert(0);
-    return nullptr;
-  case HOST_HASH:
-    hash = (InkHashTable *)from->next_level;
-    ink_assert(hash != nullptr);
-    if (ink_hash_table_lookup(hash, (char *)level_data, &lookup)) {
-      r = (HostBranch *)lookup;
-    } else {
-      r = nullptr;
+  if (bNotProcess && p.not_children && p.level > 0 && p.num_children <= HOST_ARRAY_MAX) {
+    for (int child = p.first_child; child != -1; child = branches[child].next_sibling) {
+      const HostBranch &b = branches[child];
+      const char *label   = &labels[b.label_offset];
+
+      if (b.label_len > 1 && label[0] == '!' && (b.label_len - 1 != len || memcmp(label + 1, level_data, len) != 0)) {
+        return child;
+      }
     }
-    break;
-  case HOST_INDEX:
-    ci_table = (charIndex *)from->next_level;
-    ink_assert(ci_table != nullptr);
-    r = ci_table->Lookup(level_data);
-    break;
-  case HOST_ARRAY:
-    ha_table = (hostArray *)from->next_level;
-    ink_assert(ha_table != nullptr);
-    r = ha_table->Lookup(level_data, bNotProcess);
-    break;
   }
-  return r;
+
+  return -1;
 }
 
 // void HostLookup::TableInsert(const char* match_data, int index)
@@ -999,8 +376,7 @@ HostLookup::FindNextLevel(HostBranch *from, const char *level_data, bool bNotPro
 void
 HostLookup::TableInsert(const char *match_data, int index, bool domain_record)
 {
-  HostBranch *cur = this->root;
-  HostBranch *next;
+  int cur          = 0;
   char *match_copy = ats_strdup(match_data);
   Tokenizer match_tok(".");
   int numTok;
@@ -1013,22 +389,12 @@ HostLookup::TableInsert(const char *match_data, int index, bool domain_record)
   //       Get beyond the fixed number depth of the host table
   //  OR   We reach the level where the match stops
   //
-  for (i = 0; i < HOST_TABLE_DEPTH; i++) {
-    // Check to see we need to stop at the current level
-    if (numTok == cur->level) {
-      break;
-    }
+  for (i = 0; i < HOST_TABLE_DEPTH && i < numTok; i++) {
+    const char *label = match_tok[numTok - i - 1];
+    int len           = strlen(label);
+    int next          = FindNextLevel(cur, label, len);
 
-    if (cur->next_level == nullptr) {
-      cur = TableNewLevel(cur, match_tok[numTok - i - 1]);
-    } else {
-      next = FindNextLevel(cur, match_tok[numTok - i - 1]);
-      if (next == nullptr) {
-        cur = InsertBranch(cur, match_tok[numTok - i - 1]);
-      } else {
-        cur = next;
-      }
-    }
+    cur = (next == -1) ? InsertBranch(cur, label, len) : next;
   }
 
   // Update the leaf type.  There are three types:
@@ -1061,18 +427,25 @@ HostLookup::TableInsert(const char *match_data, int index, bool domain_record)
     }
   }
 
-  // Place the index in to leaf array into the match list for this
-  //   HOST_BRANCH
-  cur->leaf_indexs(cur->leaf_indexs.length()) = index;
+  // Append the index in to leaf array to the match list for this
+  //   HostBranch
+  HostBranch &b    = branches[cur];
+  leaf_next[index] = -1;
+  if (b.last_leaf == -1) {
+    b.first_leaf = index;
+  } else {
+    leaf_next[b.last_leaf] = index;
+  }
+  b.last_leaf = index;
 
   ats_free(match_copy);
 }
 
-// bool HostLookup::MatchArray(HostLookupState* s, void**opaque_ptr, DynArray<int>& array,
+// bool HostLookup::MatchArray(HostLookupState* s, void**opaque_ptr, const HostBranch* branch,
 //                             bool host_done)
 //
-//  Helper function to iterate throught arg array and update Result
-//    for each element in arg array
+//  Helper function to iterate throught the leaves of arg branch and
+//    update Result for each of them
 //
 //  host_done should be passed as true if this call represents the all fields
 //     in the matched against hostname being consumed.  Example: for www.example.com
@@ -1081,19 +454,17 @@ HostLookup::TableInsert(const char *match_data, int index, bool domain_record)
 //
 
 bool
-HostLookup::MatchArray(HostLookupState *s, void **opaque_ptr, DynArray<int> &array, bool host_done)
+HostLookup::MatchArray(HostLookupState *s, void **opaque_ptr, const HostBranch *branch, bool host_done)
 {
-  intptr_t index;
-  intptr_t i;
+  int index = (s->array_index == -1) ? branch->first_leaf : leaf_next[s->array_index];
 
-  for (i = s->array_index + 1; i < array.length(); i++) {
-    index = array[i];
+  for (; index != -1; index = leaf_next[index]) {
+    s->array_index = index;
 
     switch (leaf_array[index].type) {
     case HOST_PARTIAL:
       if (hostcmp(s->hostname, leaf_array[index].match) == 0) {
-        *opaque_ptr    = leaf_array[index].opaque_data;
-        s->array_index = i;
+        *opaque_ptr = leaf_array[index].opaque_data;
         return true;
       }
       break;
@@ -1103,8 +474,7 @@ HostLookup::MatchArray(HostLookupState *s, void **opaque_ptr, DynArray<int> &arr
       //   "www.example.com
       //
       if (host_done == true) {
-        *opaque_ptr    = leaf_array[index].opaque_data;
-        s->array_index = i;
+        *opaque_ptr = leaf_array[index].opaque_data;
         return true;
       }
       break;
@@ -1114,8 +484,7 @@ HostLookup::MatchArray(HostLookupState *s, void **opaque_ptr, DynArray<int> &arr
       }
     // FALL THROUGH
     case DOMAIN_COMPLETE:
-      *opaque_ptr    = leaf_array[index].opaque_data;
-      s->array_index = i;
+      *opaque_ptr = leaf_array[index].opaque_data;
       return true;
     case LEAF_INVALID:
       // Should not get here
@@ -1124,7 +493,6 @@ HostLookup::MatchArray(HostLookupState *s, void **opaque_ptr, DynArray<int> &arr
     }
   }
 
-  s->array_index = i;
   return false;
 }
 
@@ -1136,7 +504,7 @@ HostLookup::MatchFirst(const char *host, HostLookupState *s, void **opaque_ptr)
 {
   char *last_dot = nullptr;
 
-  s->cur         = root;
+  s->cur         = &branches[0];
   s->table_level = 0;
   s->array_index = -1;
   s->hostname    = host ? host : "";
@@ -1170,7 +538,7 @@ HostLookup::MatchFirst(const char *host, HostLookupState *s, void **opaque_ptr)
 bool
 HostLookup::MatchNext(HostLookupState *s, void **opaque_ptr)
 {
-  HostBranch *cur = s->cur;
+  const HostBranch *cur = s->cur;
 
   // Check to see if there is any work to be done
   if (num_el <= 0) {
@@ -1178,7 +546,7 @@ HostLookup::MatchNext(HostLookupState *s, void **opaque_ptr)
   }
 
   while (s->table_level <= HOST_TABLE_DEPTH) {
-    if (MatchArray(s, opaque_ptr, cur->leaf_indexs, (s->host_copy_next == nullptr))) {
+    if (MatchArray(s, opaque_ptr, cur, (s->host_copy_next == nullptr))) {
       return true;
     }
     // Check to see if we run out of tokens in the hostname
@@ -1186,15 +554,16 @@ HostLookup::MatchNext(HostLookupState *s, void **opaque_ptr)
       break;
     }
     // Check to see if there are any lower levels
-    if (cur->type == HOST_TERMINAL) {
+    if (cur->first_child == -1) {
       break;
     }
 
-    cur = FindNextLevel(cur, s->host_copy_next, true);
+    int next = FindNextLevel(cur - &branches[0], s->host_copy_next, strlen(s->host_copy_next), true);
 
-    if (cur == nullptr) {
+    if (next == -1) {
       break;
     } else {
+      cur            = &branches[next];
       s->cur         = cur;
       s->array_index = -1;
       s->table_level++;
@@ -1245,6 +614,13 @@ HostLookup::AllocateSpace(int num_entries)
 
   leaf_array = new HostLeaf[num_entries];
   memset(leaf_array, 0, sizeof(HostLeaf) * num_entries);
+  leaf_next = new int[num_entries];
+
+  // Most entries are a distinct host or domain, size the tree for that
+  branches.reserve(num_entries + 1);
+  while (slots.size() < static_cast<size_t>(num_entries) * 2) {
+    GrowSlots();
+  }
 
   array_len = num_entries;
   num_el    = 0;
@@ -31,21 +31,18 @@
 #ifndef _HOST_LOOKUP_H_
 #define _HOST_LOOKUP_H_
 
-#include "DynArray.h"
+#include <stdint.h>
+#include <vector>
+
+#include "ts/ink_memory.h"
 
 // HostLookup  constantss
 const int HOST_TABLE_DEPTH = 3; // Controls the max number of levels in the logical tree
-const int HOST_ARRAY_MAX   = 8; // Sets the fixed array size
+const int HOST_ARRAY_MAX   = 8; // Negated labels only apply among this many siblings
 
 //
 //  Begin Host Lookup Helper types
 //
-enum HostNodeType {
-  HOST_TERMINAL,
-  HOST_HASH,
-  HOST_INDEX,
-  HOST_ARRAY,
-};
 enum LeafType {
   LEAF_INVALID,
   HOST_PARTIAL,
@@ -54,11 +51,11 @@ enum LeafType {
   DOMAIN_PARTIAL,
 };
 
-// The data in the HostMatcher tree is pointers to HostBranches.
-//   No duplicates keys permitted in the tree.  To handle multiple
-//   data items bound the same key, the HostBranch has the lead_indexs
-//   array which stores pointers (in the form of array indexes) to
-//   HostLeaf structs
+// The data in the HostMatcher tree is a reversed label trie of
+//   HostBranches, one per distinct domain suffix.  No duplicates keys
+//   permitted in the tree.  To handle multiple data items bound the
+//   same key, the HostBranch has a chain of leaf indexes which point
+//   at HostLeaf structs
 //
 // There is HostLeaf struct for each data item put into the
 //   table
@@ -71,13 +68,22 @@ struct HostLeaf {
   void *opaque_data; // Data associated with this leaf
 };
 
+// All the branches live in one array and refer to each other by
+//   index, the labels live in one string pool.  Children are found
+//   through a single open addressed hash table keyed by (parent, label)
+//   so a lookup is one probe per level of the host name.
+//
 struct HostBranch {
-  HostBranch();
-  ~HostBranch();
-  int level;                 // what level in the tree.  the root is level 0
-  HostNodeType type;         // tells what kind of data structure is next_level is
-  void *next_level;          // opaque pointer to lookup structure
-  DynArray<int> leaf_indexs; // pointers HostLeaf(s)
+  int level;        // what level in the tree.  the root is level 0
+  int parent;       // index of the parent branch, -1 for the root
+  int label_offset; // offset of our label in the label pool
+  int label_len;
+  int first_child;  // most recently added child, -1 if none
+  int next_sibling; // next (older) child of our parent, -1 if none
+  int first_leaf;   // chain of HostLeaf indexes, in insertion order
+  int last_leaf;
+  int num_children;
+  bool not_children; // at least one child label starts with '!'
 };
 
 typedef void (*HostLookupPrintFunc)(void *opaque_data);
@@ -88,9 +94,9 @@ typedef void (*HostLookupPrintFunc)(void *opaque_data);
 struct HostLookupState {
   HostLookupState() : cur(nullptr), table_level(0), array_index(0), hostname(NULL), host_copy(NULL), host_copy_next(NULL) {}
   ~HostLookupState() { ats_free(host_copy); }
-  HostBranch *cur;
+  const HostBranch *cur;
   int table_level;
-  int array_index;
+  int array_index; // last leaf index examined at this level, -1 for none
   const char *hostname;
   char *host_copy;      // request lower-cased host name copy
   char *host_copy_next; // ptr to part of host_copy for next use
@@ -117,16 +123,25 @@ public:
 
 private:
   void TableInsert(const char *match_data, int index, bool domain_record);
-  HostBranch *TableNewLevel(HostBranch *from, const char *level_data);
-  HostBranch *InsertBranch(HostBranch *insert_in, const char *level_data);
-  HostBranch *FindNextLevel(HostBranch *from, const char *level_data, bool bNotProcess = false);
-  bool MatchArray(HostLookupState *s, void **opaque_ptr, DynArray<int> &array, bool host_done);
-  void PrintHostBranch(HostBranch *hb, HostLookupPrintFunc f);
-  HostBranch *root;         // The top of the search tree
-  HostLeaf *leaf_array;     // array of all leaves in tree
-  int array_len;            // the length of the arrays
-  int num_el;               // the numbe of itmems in the tree
-  const char *matcher_name; // Used for Debug/Warning/Error messages
+  int InsertBranch(int parent, const char *level_data, int len);
+  int FindNextLevel(int parent, const char *level_data, int len, bool bNotProcess = false) const;
+  bool MatchArray(HostLookupState *s, void **opaque_ptr, const HostBranch *branch, bool host_done);
+  void PrintHostBranch(int branch, HostLookupPrintFunc f);
+  void GrowSlots();
+
+  struct Slot {
+    uint32_t hash;
+    int32_t branch; // -1 if empty
+  };
+
+  std::vector<HostBranch> branches; // The search tree, the root is element 0
+  std::vector<Slot> slots;          // (parent, label) -> child, size is a power of 2
+  std::vector<char> labels;         // label pool
+  int *leaf_next;                   // next leaf in the same branch, -1 at the end
+  HostLeaf *leaf_array;             // array of all leaves in tree
+  int array_len;                    // the length of the arrays
+  int num_el;                       // the numbe of itmems in the tree
+  const char *matcher_name;         // Used for Debug/Warning/Error messages
 };
 
 #endif
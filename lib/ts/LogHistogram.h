@@ -0,0 +1,161 @@
+/** @file
+
+  Log-linear histogram for latency and size distributions.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+namespace ts
+{
+/** A log-linear (HDR style) histogram of non-negative integer samples.
+
+    Each power of two range is split into @c SUB_BUCKETS linear buckets, so the value reported for
+    any sample is within 1/SUB_BUCKETS of the recorded value, regardless of magnitude. Values below
+    @c SUB_BUCKETS are counted exactly, values at or above 2^MAX_BITS land in the last bucket.
+
+    This is deliberately a plain aggregate with no constructor so that instances can live in raw
+    per-thread storage and be updated without atomics. Use @c clear to initialize one.
+*/
+struct LogHistogram {
+  enum {
+    SUB_BUCKET_BITS = 3,
+    SUB_BUCKETS     = 1 << SUB_BUCKET_BITS,
+    MAX_BITS        = 40,
+    N_BUCKETS       = (MAX_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKETS,
+  };
+
+  uint64_t buckets[N_BUCKETS];
+  uint64_t count; ///< Number of samples.
+  uint64_t sum;   ///< Sum of all samples (exact, not bucketed).
+
+  /// Bucket index for @a value.
+  static int
+  bucket_index(uint64_t value)
+  {
+    if (value < static_cast<uint64_t>(SUB_BUCKETS)) {
+      return static_cast<int>(value);
+    }
+    if (value >= (static_cast<uint64_t>(1) << MAX_BITS)) {
+      return N_BUCKETS - 1;
+    }
+    int shift = (63 - __builtin_clzll(value)) - SUB_BUCKET_BITS;
+    return (shift * SUB_BUCKETS) + static_cast<int>(value >> shift);
+  }
+
+  /// Smallest value that maps to bucket @a idx.
+  static uint64_t
+  bucket_lower(int idx)
+  {
+    if (idx < 2 * SUB_BUCKETS) {
+      return idx;
+    }
+    int shift = idx / SUB_BUCKETS - 1;
+    return static_cast<uint64_t>(SUB_BUCKETS + idx % SUB_BUCKETS) << shift;
+  }
+
+  /// Largest value that maps to bucket @a idx.
+  static uint64_t
+  bucket_upper(int idx)
+  {
+    return idx + 1 < N_BUCKETS ? bucket_lower(idx + 1) - 1 : UINT64_MAX;
+  }
+
+  void
+  clear()
+  {
+    memset(this, 0, sizeof(*this));
+  }
+
+  void
+  record(uint64_t value)
+  {
+    ++buckets[bucket_index(value)];
+    ++count;
+    sum += value;
+  }
+
+  /// Add the samples of @a that to this histogram.
+  void
+  merge(const LogHistogram &that)
+  {
+    for (int i = 0; i < N_BUCKETS; ++i) {
+      buckets[i] += that.buckets[i];
+    }
+    count += that.count;
+    sum += that.sum;
+  }
+
+  /// Remove the samples of @a that, an earlier snapshot of this histogram.
+  void
+  subtract(const LogHistogram &that)
+  {
+    for (int i = 0; i < N_BUCKETS; ++i) {
+      buckets[i] -= that.buckets[i];
+    }
+    count -= that.count;
+    sum -= that.sum;
+  }
+
+  /** Value at quantile @a q (0.0 to 1.0).
+
+      This is the upper bound of the bucket holding the sample of that rank, so it never under
+      reports a latency. Returns 0 for an empty histogram.
+  */
+  uint64_t
+  percentile(double q) const
+  {
+    if (count == 0) {
+      return 0;
+    }
+
+    uint64_t rank = q <= 0.0 ? 1 : static_cast<uint64_t>(q * count + 0.5);
+    uint64_t seen = 0;
+
+    if (rank < 1) {
+      rank = 1;
+    } else if (rank > count) {
+      rank = count;
+    }
+    for (int i = 0; i < N_BUCKETS; ++i) {
+      seen += buckets[i];
+      if (seen >= rank) {
+        return i == N_BUCKETS - 1 ? bucket_lower(i) : bucket_upper(i);
+      }
+    }
+    return bucket_lower(N_BUCKETS - 1);
+  }
+
+  /// Upper bound of the highest non-empty bucket, 0 if empty.
+  uint64_t
+  max() const
+  {
+    for (int i = N_BUCKETS - 1; i >= 0; --i) {
+      if (buckets[i]) {
+        return i == N_BUCKETS - 1 ? bucket_lower(i) : bucket_upper(i);
+      }
+    }
+    return 0;
+  }
+};
+} // namespace ts
@@ -0,0 +1,201 @@
+/** @file
+
+  MurmurHash3 (x64, 128 bit) support class.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "ts/Murmur3.h"
+#include <cstring>
+
+// Based on the public domain MurmurHash3 by Austin Appleby.
+
+namespace
+{
+const uint64_t C1 = 0x87c37b91114253d5ULL;
+const uint64_t C2 = 0x4cf5ad432745937fULL;
+
+inline uint64_t
+rotl64(uint64_t x, int r)
+{
+  return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t
+fmix64(uint64_t k)
+{
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdULL;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53ULL;
+  k ^= k >> 33;
+  return k;
+}
+
+inline uint64_t
+mix_k1(uint64_t k1)
+{
+  k1 *= C1;
+  k1 = rotl64(k1, 31);
+  return k1 * C2;
+}
+
+inline uint64_t
+mix_k2(uint64_t k2)
+{
+  k2 *= C2;
+  k2 = rotl64(k2, 33);
+  return k2 * C1;
+}
+
+// little endian load, compilers turn this into a single load where possible
+inline uint64_t
+load64(const uint8_t *p)
+{
+  return static_cast<uint64_t>(p[0]) | static_cast<uint64_t>(p[1]) << 8 | static_cast<uint64_t>(p[2]) << 16 |
+         static_cast<uint64_t>(p[3]) << 24 | static_cast<uint64_t>(p[4]) << 32 | static_cast<uint64_t>(p[5]) << 40 |
+         static_cast<uint64_t>(p[6]) << 48 | static_cast<uint64_t>(p[7]) << 56;
+}
+}
+
+Murmur3Context::Murmur3Context() : _h1(0), _h2(0), _total(0), _buffer_len(0)
+{
+}
+
+void
+Murmur3Context::block(const uint8_t *data)
+{
+  _h1 ^= mix_k1(load64(data));
+  _h1 = rotl64(_h1, 27);
+  _h1 += _h2;
+  _h1 = _h1 * 5 + 0x52dce729;
+
+  _h2 ^= mix_k2(load64(data + 8));
+  _h2 = rotl64(_h2, 31);
+  _h2 += _h1;
+  _h2 = _h2 * 5 + 0x38495ab5;
+}
+
+bool
+Murmur3Context::update(void const *data, int length)
+{
+  const uint8_t *p = static_cast<const uint8_t *>(data);
+
+  if (length <= 0) {
+    return true;
+  }
+  _total += length;
+
+  // finish a partial block left by the previous update
+  if (_buffer_len) {
+    int n = sizeof(_buffer) - _buffer_len;
+    if (length < n) {
+      memcpy(_buffer + _buffer_len, p, length);
+      _buffer_len += length;
+      return true;
+    }
+    memcpy(_buffer + _buffer_len, p, n);
+    this->block(_buffer);
+    _buffer_len = 0;
+    p += n;
+    length -= n;
+  }
+
+  for (; length >= static_cast<int>(sizeof(_buffer)); p += sizeof(_buffer), length -= sizeof(_buffer)) {
+    this->block(p);
+  }
+
+  if (length) {
+    memcpy(_buffer, p, length);
+    _buffer_len = length;
+  }
+  return true;
+}
+
+bool
+Murmur3Context::finalize(CryptoHash &hash)
+{
+  uint64_t k1 = 0;
+  uint64_t k2 = 0;
+
+  switch (_buffer_len) {
+  case 15:
+    k2 ^= static_cast<uint64_t>(_buffer[14]) << 48;
+  // fallthrough
+  case 14:
+    k2 ^= static_cast<uint64_t>(_buffer[13]) << 40;
+  // fallthrough
+  case 13:
+    k2 ^= static_cast<uint64_t>(_buffer[12]) << 32;
+  // fallthrough
+  case 12:
+    k2 ^= static_cast<uint64_t>(_buffer[11]) << 24;
+  // fallthrough
+  case 11:
+    k2 ^= static_cast<uint64_t>(_buffer[10]) << 16;
+  // fallthrough
+  case 10:
+    k2 ^= static_cast<uint64_t>(_buffer[9]) << 8;
+  // fallthrough
+  case 9:
+    k2 ^= static_cast<uint64_t>(_buffer[8]);
+    _h2 ^= mix_k2(k2);
+  // fallthrough
+  case 8:
+    k1 ^= static_cast<uint64_t>(_buffer[7]) << 56;
+  // fallthrough
+  case 7:
+    k1 ^= static_cast<uint64_t>(_buffer[6]) << 48;
+  // fallthrough
+  case 6:
+    k1 ^= static_cast<uint64_t>(_buffer[5]) << 40;
+  // fallthrough
+  case 5:
+    k1 ^= static_cast<uint64_t>(_buffer[4]) << 32;
+  // fallthrough
+  case 4:
+    k1 ^= static_cast<uint64_t>(_buffer[3]) << 24;
+  // fallthrough
+  case 3:
+    k1 ^= static_cast<uint64_t>(_buffer[2]) << 16;
+  // fallthrough
+  case 2:
+    k1 ^= static_cast<uint64_t>(_buffer[1]) << 8;
+  // fallthrough
+  case 1:
+    k1 ^= static_cast<uint64_t>(_buffer[0]);
+    _h1 ^= mix_k1(k1);
+  }
+
+  _h1 ^= _total;
+  _h2 ^= _total;
+
+  _h1 += _h2;
+  _h2 += _h1;
+
+  _h1 = fmix64(_h1);
+  _h2 = fmix64(_h2);
+
+  _h1 += _h2;
+  _h2 += _h1;
+
+  hash.u64[0] = _h1;
+  hash.u64[1] = _h2;
+  return true;
+}
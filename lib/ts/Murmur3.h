@@ -0,0 +1,56 @@
+/** @file
+
+  MurmurHash3 (x64, 128 bit) support class.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#ifndef _MURMUR3_H_
+#define _MURMUR3_H_
+
+#include "ts/ink_defs.h"
+#include "ts/CryptoHash.h"
+
+/** Incremental MurmurHash3_x64_128.
+
+    A fast non-cryptographic 128 bit hash, several times faster than MD5 on URL sized input. The
+    result depends only on the bytes fed in, not on how they are split across calls to @c update,
+    and matches the reference implementation (seed 0, result stored as the two 64 bit halves in
+    host order) for the same input.
+*/
+class Murmur3Context : public CryptoContext
+{
+protected:
+  uint64_t _h1;
+  uint64_t _h2;
+  uint64_t _total;     ///< Bytes hashed so far.
+  uint8_t _buffer[16]; ///< Partial block.
+  int _buffer_len;     ///< Bytes in @a _buffer.
+
+  void block(const uint8_t *data);
+
+public:
+  Murmur3Context();
+  /// Update the hash with @a data of @a length bytes.
+  virtual bool update(void const *data, int length);
+  /// Finalize and extract the @a hash.
+  virtual bool finalize(CryptoHash &hash);
+};
+
+#endif
@@ -24,6 +24,7 @@
 #include "ts/ink_platform.h"
 #include "ts/ink_thread.h"
 #include "ts/ink_memory.h"
+#include "ts/ParseRules.h"
 #include "ts/Regex.h"
 
 #ifdef PCRE_CONFIG_JIT
@@ -136,6 +137,317 @@ Regex::~Regex()
   }
 }
 
+//
+// RegexPrefilter
+//
+namespace
+{
+// Skip a character class, @a p points just past the opening '['.
+bool
+skip_class(const char *&p)
+{
+  if (*p == '^') {
+    ++p;
+  }
+  if (*p == ']') { // a leading ']' is a literal
+    ++p;
+  }
+  while (*p) {
+    char c = *p++;
+
+    if (c == '\\') {
+      if (*p++ == '\0') {
+        return false;
+      }
+    } else if (c == '[' && *p == ':') {
+      const char *e = strstr(p, ":]");
+      if (e == nullptr) {
+        return false;
+      }
+      p = e + 2;
+    } else if (c == ']') {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Skip a (possibly nested) group, @a p points just past the opening '('.
+bool
+skip_group(const char *&p)
+{
+  int depth = 1;
+
+  while (*p) {
+    char c = *p++;
+
+    if (c == '\\') {
+      if (*p == '\0' || *p == 'Q') { // can't tell where a \Q quote ends without a real parse
+        return false;
+      }
+      ++p;
+    } else if (c == '[') {
+      if (!skip_class(p)) {
+        return false;
+      }
+    } else if (c == '(') {
+      ++depth;
+    } else if (c == ')' && --depth == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Escapes that are a single character class or assertion, and so just end a literal run.
+const char REGEX_CLASS_ESCAPES[] = "dDwWsShHvVbBAzZGRXKntrfea";
+}
+
+/** The literal is the longest run of plain characters at the top level of the pattern, every match
+    must contain it. Anything this doesn't understand (alternation at the top level, extended mode,
+    quoting, numeric escapes, backtracking verbs) gives up rather than guessing. Characters outside
+    of ASCII end a run so that multi byte characters can't be split by a quantifier.
+ */
+bool
+RegexPrefilter::required_literal(const char *pattern, std::string &literal)
+{
+  std::string run;
+  const char *p = pattern;
+
+  literal.clear();
+
+  auto end_run = [&]() {
+    if (run.size() > literal.size()) {
+      literal = run;
+    }
+    run.clear();
+  };
+
+  while (*p) {
+    char c = *p++;
+
+    switch (c) {
+    case '|':
+      literal.clear();
+      return false;
+    case '(':
+      if (*p == '*') {
+        literal.clear();
+        return false;
+      }
+      if (*p == '?') {
+        for (const char *o = p + 1; ParseRules::is_alpha(*o) || *o == '-'; ++o) {
+          if (*o == 'x') {
+            literal.clear();
+            return false;
+          }
+        }
+      }
+      end_run();
+      if (!skip_group(p)) {
+        literal.clear();
+        return false;
+      }
+      break;
+    case '[':
+      end_run();
+      if (!skip_class(p)) {
+        literal.clear();
+        return false;
+      }
+      break;
+    case ')':
+      literal.clear();
+      return false;
+    case '.':
+    case '^':
+    case '$':
+      end_run();
+      break;
+    case '?':
+    case '*':
+    case '{':
+      // The preceding character is optional (or at least might be), drop it.
+      if (!run.empty()) {
+        run.erase(run.size() - 1);
+      }
+      end_run();
+      if (c == '{') {
+        const char *q = p;
+        while (ParseRules::is_digit(*q) || *q == ',') {
+          ++q;
+        }
+        if (*q == '}') {
+          p = q + 1;
+        }
+      }
+      if (*p == '?' || *p == '+') { // lazy or possessive
+        ++p;
+      }
+      break;
+    case '+':
+      end_run();
+      if (*p == '?' || *p == '+') {
+        ++p;
+      }
+      break;
+    case '\\':
+      c = *p++;
+      if (c == '\0') {
+        literal.clear();
+        return false;
+      }
+      if (ParseRules::is_alnum(c)) {
+        if (strchr(REGEX_CLASS_ESCAPES, c) == nullptr) {
+          literal.clear();
+          return false;
+        }
+        end_run();
+      } else if (static_cast<unsigned char>(c) >= 0x80) {
+        end_run();
+      } else {
+        run += ParseRules::ink_tolower(c);
+      }
+      break;
+    default:
+      if (static_cast<unsigned char>(c) >= 0x80) {
+        end_run();
+      } else {
+        run += ParseRules::ink_tolower(c);
+      }
+      break;
+    }
+  }
+  end_run();
+
+  return !literal.empty();
+}
+
+int
+RegexPrefilter::add(const char *pattern)
+{
+  std::string literal;
+
+  ink_assert(!_compiled);
+  required_literal(pattern, literal);
+  _literals.push_back(literal);
+
+  return _npatterns++;
+}
+
+void
+RegexPrefilter::compile()
+{
+  int nstates = 1;
+
+  ink_assert(!_compiled);
+
+  // Case fold the byte classes, only bytes that occur in some literal get a class of their own.
+  memset(_classes, 0, sizeof(_classes));
+  _nclasses = 1;
+  for (const std::string &lit : _literals) {
+    for (char c : lit) {
+      uint8_t lower = static_cast<uint8_t>(c);
+      uint8_t upper = static_cast<uint8_t>(ParseRules::ink_toupper(c));
+
+      if (_classes[lower] == 0) {
+        _classes[lower] = _classes[upper] = _nclasses++;
+      }
+    }
+  }
+
+  // Build the trie of literals.
+  _always.assign((_npatterns + 63) / 64, 0);
+  _delta.assign(_nclasses, -1);
+  _out.assign(1, std::vector<int>());
+  for (int i = 0; i < _npatterns; ++i) {
+    const std::string &lit = _literals[i];
+    int state              = 0;
+
+    if (lit.empty()) {
+      _always[i >> 6] |= static_cast<uint64_t>(1) << (i & 63);
+      continue;
+    }
+    for (char c : lit) {
+      int idx = state * _nclasses + _classes[static_cast<uint8_t>(c)];
+      if (_delta[idx] < 0) {
+        _delta[idx] = nstates++;
+        _delta.resize(nstates * _nclasses, -1);
+        _out.emplace_back();
+      }
+      state = _delta[idx];
+    }
+    _out[state].push_back(i);
+  }
+
+  // Breadth first, fill in the failure transitions and merge the outputs of the failure states.
+  std::vector<int> fail(nstates, 0);
+  std::vector<int> queue;
+
+  queue.reserve(nstates);
+  for (int c = 0; c < _nclasses; ++c) {
+    if (_delta[c] < 0) {
+      _delta[c] = 0;
+    } else {
+      queue.push_back(_delta[c]);
+    }
+  }
+  for (size_t head = 0; head < queue.size(); ++head) {
+    int state = queue[head];
+
+    for (int c = 0; c < _nclasses; ++c) {
+      int idx  = state * _nclasses + c;
+      int next = _delta[idx];
+      int back = _delta[fail[state] * _nclasses + c];
+
+      if (next < 0) {
+        _delta[idx] = back;
+      } else {
+        fail[next] = back;
+        _out[next].insert(_out[next].end(), _out[back].begin(), _out[back].end());
+        queue.push_back(next);
+      }
+    }
+  }
+
+  _compiled = true;
+}
+
+RegexPrefilter::Candidates::Candidates(const RegexPrefilter &filter, const char *str, int length) : _bits(nullptr)
+{
+  if (!filter._compiled) {
+    return; // everything is a candidate
+  }
+
+  size_t nwords = filter._always.size();
+
+  _bits = nwords <= countof(_inline) ? _inline : static_cast<uint64_t *>(ats_malloc(nwords * sizeof(uint64_t)));
+  if (nwords) {
+    memcpy(_bits, filter._always.data(), nwords * sizeof(uint64_t));
+  }
+
+  const int32_t *delta = filter._delta.data();
+  int nclasses         = filter._nclasses;
+  int state            = 0;
+
+  for (int i = 0; i < length; ++i) {
+    state = delta[state * nclasses + filter._classes[static_cast<uint8_t>(str[i])]];
+    for (int idx : filter._out[state]) {
+      _bits[idx >> 6] |= static_cast<uint64_t>(1) << (idx & 63);
+    }
+  }
+}
+
+RegexPrefilter::Candidates::~Candidates()
+{
+  if (_bits != _inline) {
+    ats_free(_bits);
+  }
+}
+
+//
+// DFA
+//
 DFA::~DFA()
 {
   dfa_pattern *p = _my_patterns;
@@ -222,6 +534,13 @@ DFA::compile(const char **patterns, int npatterns, unsigned flags)
     }
   }
 
+  // (Re)build the prefilter over every pattern in the list, indexed by list position.
+  _filter = RegexPrefilter();
+  for (dfa_pattern *p = _my_patterns; p; p = p->_next) {
+    _filter.add(p->_p);
+  }
+  _filter.compile();
+
   return 0;
 }
 
@@ -235,14 +554,19 @@ int
 DFA::match(const char *str, int length) const
 {
   int rc;
+  int pos        = 0;
   dfa_pattern *p = _my_patterns;
+  RegexPrefilter::Candidates candidates(_filter, str, length);
 
   while (p) {
-    rc = p->_re->exec(str, length);
-    if (rc > 0) {
-      return p->_idx;
+    if (candidates.test(pos)) {
+      rc = p->_re->exec(str, length);
+      if (rc > 0) {
+        return p->_idx;
+      }
     }
     p = p->_next;
+    ++pos;
   }
 
   return -1;
@@ -26,6 +26,10 @@
 
 #include "ts/ink_config.h"
 
+#include <stdint.h>
+#include <string>
+#include <vector>
+
 #ifdef HAVE_PCRE_PCRE_H
 #include <pcre/pcre.h>
 #else
@@ -55,6 +59,76 @@ private:
   pcre_extra *regex_extra;
 };
 
+/** Literal prefilter for an ordered set of regular expressions.
+
+    Each pattern added is reduced to the longest literal string any subject it matches must contain
+    (compared case insensitively). All of those literals are compiled into a single Aho-Corasick
+    automaton, so one pass over a subject yields every pattern that can possibly match it. Patterns
+    with no usable literal are always candidates. The prefilter never rules out a pattern that would
+    match, it is only used to avoid executing the ones that can't.
+*/
+class RegexPrefilter
+{
+public:
+  RegexPrefilter() : _npatterns(0), _compiled(false) {}
+
+  /// Add @a pattern, return its index. Indices are assigned in order from 0.
+  int add(const char *pattern);
+  /// Build the automaton, after this no more patterns may be added.
+  void compile();
+
+  int
+  size() const
+  {
+    return _npatterns;
+  }
+
+  bool
+  is_compiled() const
+  {
+    return _compiled;
+  }
+
+  /** Extract the required literal of @a pattern into @a literal.
+
+      @return @c false if no literal can be safely determined, in which case the pattern must
+      always be treated as a candidate.
+  */
+  static bool required_literal(const char *pattern, std::string &literal);
+
+  /// The set of candidate patterns for one subject string.
+  class Candidates
+  {
+  public:
+    Candidates(const RegexPrefilter &filter, const char *str, int length);
+    ~Candidates();
+
+    /// @c true if pattern @a idx may match the subject.
+    bool
+    test(int idx) const
+    {
+      return _bits == nullptr || (_bits[idx >> 6] & (static_cast<uint64_t>(1) << (idx & 63)));
+    }
+
+  private:
+    uint64_t _inline[16];
+    uint64_t *_bits;
+
+    Candidates(const Candidates &) = delete;
+    Candidates &operator=(const Candidates &) = delete;
+  };
+
+private:
+  int _npatterns;
+  bool _compiled;
+  int _nclasses;
+  uint8_t _classes[256];              ///< Byte to character class, case folded. Class 0 is "no literal has this byte".
+  std::vector<std::string> _literals; ///< Folded literal per pattern, empty if none.
+  std::vector<int32_t> _delta;        ///< Transition table, states * classes.
+  std::vector<std::vector<int>> _out; ///< Patterns whose literal ends at each state.
+  std::vector<uint64_t> _always;      ///< Bitset of patterns without a literal.
+};
+
 typedef struct __pat {
   int _idx;
   Regex *_re;
@@ -78,6 +152,7 @@ private:
   dfa_pattern *build(const char *pattern, unsigned flags = 0);
 
   dfa_pattern *_my_patterns;
+  RegexPrefilter _filter;
 };
 
 #endif /* __TS_REGEX_H__ */
@@ -1,6 +1,6 @@
 /** @file
 
-    Trie implementation for 8-bit string keys.
+    Radix trie implementation for 8-bit string keys.
 
     @section license License
 
@@ -27,14 +27,24 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "ts/Arena.h"
 #include "ts/List.h"
 
-// Note that you should provide the class to use here, but we'll store
-// pointers to such objects internally.
+/** A path compressed (radix) trie for 8-bit string keys.
+
+    Each node holds the whole run of key bytes leading to it, so a key costs one node per branch
+    point rather than one per byte, and a node only carries the children it actually has. Nodes
+    and labels are allocated from an @c Arena, either one shared with the caller (so many tries can
+    be released at once by resetting it) or one owned by the trie.
+
+    Note that you should provide the class to use here, but we'll store pointers to such objects
+    internally.
+*/
 template <typename T> class Trie
 {
 public:
-  Trie() { m_root.Clear(); }
+  /// Nodes come from @a arena if provided, the caller must not reset it before clearing the trie.
+  explicit Trie(Arena *arena = nullptr) : m_arena(arena ? arena : &m_own_arena) { m_root.Clear(); }
   // will return false for duplicates; key should be nullptr-terminated
   // if key_len is defaulted to -1
   bool Insert(const char *key, T *value, int rank, int key_len = -1);
@@ -58,44 +68,53 @@ private:
   class Node
   {
   public:
+    const char *label; ///< Key bytes from the parent to this node, not terminated.
+    int label_len;
+    int rank;
     T *value;
     bool occupied;
-    int rank;
+    unsigned short n_children;
+    unsigned short max_children;
+    unsigned char *child_keys; ///< First label byte of each child, parallel to @a children.
+    Node **children;
 
     void
     Clear()
     {
-      value    = nullptr;
-      occupied = false;
-      rank     = 0;
-      ink_zero(children);
+      label        = nullptr;
+      label_len    = 0;
+      rank         = 0;
+      value        = nullptr;
+      occupied     = false;
+      n_children   = 0;
+      max_children = 0;
+      child_keys   = nullptr;
+      children     = nullptr;
     }
 
     void Print(const char *debug_tag) const;
-    inline Node *
-    GetChild(char index) const
+    inline Node **
+    ChildSlot(char index) const
     {
-      return children[static_cast<unsigned char>(index)];
+      const void *k = n_children ? memchr(child_keys, static_cast<unsigned char>(index), n_children) : nullptr;
+      return k ? &children[static_cast<const unsigned char *>(k) - child_keys] : nullptr;
     }
     inline Node *
-    AllocateChild(char index)
+    GetChild(char index) const
     {
-      Node *&child = children[static_cast<unsigned char>(index)];
-      ink_assert(child == nullptr);
-      child = static_cast<Node *>(ats_malloc(sizeof(Node)));
-      child->Clear();
-      return child;
+      Node **slot = ChildSlot(index);
+      return slot ? *slot : nullptr;
     }
-
-  private:
-    Node *children[N_NODE_CHILDREN];
   };
 
+  Arena m_own_arena;
+  Arena *m_arena;
   Node m_root;
   Queue<T> m_value_list;
 
   void _CheckArgs(const char *key, int &key_len) const;
-  void _Clear(Node *node);
+  Node *_AllocNode(const char *label, int label_len, bool copy);
+  void _AddChild(Node *parent, Node *child);
 
   // make copy-constructor and assignment operator private
   // till we properly implement them
@@ -118,37 +137,90 @@ Trie<T>::_CheckArgs(const char *key, int &key_len) const
   }
 }
 
+template <typename T>
+typename Trie<T>::Node *
+Trie<T>::_AllocNode(const char *label, int label_len, bool copy)
+{
+  Node *node = static_cast<Node *>(m_arena->alloc(sizeof(Node)));
+
+  node->Clear();
+  if (copy) {
+    char *l = static_cast<char *>(m_arena->alloc(label_len, 1));
+    memcpy(l, label, label_len);
+    label = l;
+  }
+  node->label     = label;
+  node->label_len = label_len;
+  return node;
+}
+
+template <typename T>
+void
+Trie<T>::_AddChild(Node *parent, Node *child)
+{
+  if (parent->n_children == parent->max_children) {
+    int n = parent->max_children ? parent->max_children * 2 : 2;
+
+    if (n > N_NODE_CHILDREN) {
+      n = N_NODE_CHILDREN;
+    }
+    // The old arrays stay in the arena, growth is geometric so that's at most as much again.
+    unsigned char *keys = static_cast<unsigned char *>(m_arena->alloc(n, 1));
+    Node **children     = static_cast<Node **>(m_arena->alloc(n * sizeof(Node *)));
+    if (parent->n_children) {
+      memcpy(keys, parent->child_keys, parent->n_children);
+      memcpy(children, parent->children, parent->n_children * sizeof(Node *));
+    }
+    parent->child_keys   = keys;
+    parent->children     = children;
+    parent->max_children = n;
+  }
+  parent->child_keys[parent->n_children] = static_cast<unsigned char>(child->label[0]);
+  parent->children[parent->n_children]   = child;
+  ++parent->n_children;
+}
+
 template <typename T>
 bool
 Trie<T>::Insert(const char *key, T *value, int rank, int key_len /* = -1 */)
 {
   _CheckArgs(key, key_len);
 
-  Node *next_node;
   Node *curr_node = &m_root;
   int i           = 0;
 
-  while (true) {
-    if (is_debug_tag_set("Trie::Insert")) {
-      Debug("Trie::Insert", "Visiting Node...");
-      curr_node->Print("Trie::Insert");
-    }
+  while (i < key_len) {
+    Node **slot = curr_node->ChildSlot(key[i]);
 
-    if (i == key_len) {
+    if (!slot) {
+      Node *leaf = _AllocNode(key + i, key_len - i, true);
+
+      Debug("Trie::Insert", "Creating child node for [%.*s]", key_len - i, key + i);
+      _AddChild(curr_node, leaf);
+      curr_node = leaf;
       break;
     }
 
-    next_node = curr_node->GetChild(key[i]);
-    if (!next_node) {
-      while (i < key_len) {
-        Debug("Trie::Insert", "Creating child node for char %c (%d)", key[i], key[i]);
-        curr_node = curr_node->AllocateChild(key[i]);
-        ++i;
-      }
-      break;
+    Node *next_node = *slot;
+    int common      = 1; // the first byte is how we found it
+    int rest        = key_len - i;
+    while (common < next_node->label_len && common < rest && next_node->label[common] == key[i + common]) {
+      ++common;
+    }
+
+    if (common < next_node->label_len) {
+      // The key diverges (or ends) inside this label, split it. The new node takes the child's
+      // slot in the parent since they start with the same byte.
+      Node *mid = _AllocNode(next_node->label, common, false);
+
+      *slot = mid;
+      next_node->label += common;
+      next_node->label_len -= common;
+      _AddChild(mid, next_node);
+      next_node = mid;
     }
     curr_node = next_node;
-    ++i;
+    i += common;
   }
 
   if (curr_node->occupied) {
@@ -174,11 +246,7 @@ Trie<T>::Search(const char *key, int key_len /* = -1 */) const
   const Node *curr_node  = &m_root;
   int i                  = 0;
 
-  while (curr_node) {
-    if (is_debug_tag_set("Trie::Search")) {
-      Debug("Trie::Search", "Visiting node...");
-      curr_node->Print("Trie::Search");
-    }
+  while (true) {
     if (curr_node->occupied) {
       if (!found_node || curr_node->rank <= found_node->rank) {
         found_node = curr_node;
@@ -187,8 +255,12 @@ Trie<T>::Search(const char *key, int key_len /* = -1 */) const
     if (i == key_len) {
       break;
     }
-    curr_node = curr_node->GetChild(key[i]);
-    ++i;
+    const Node *next_node = curr_node->GetChild(key[i]);
+    if (!next_node || next_node->label_len > key_len - i || memcmp(next_node->label, key + i, next_node->label_len) != 0) {
+      break;
+    }
+    i += next_node->label_len;
+    curr_node = next_node;
   }
 
   if (found_node) {
@@ -199,21 +271,6 @@ Trie<T>::Search(const char *key, int key_len /* = -1 */) const
   return nullptr;
 }
 
-template <typename T>
-void
-Trie<T>::_Clear(Node *node)
-{
-  Node *child;
-
-  for (int i = 0; i < N_NODE_CHILDREN; ++i) {
-    child = node->GetChild(i);
-    if (child) {
-      _Clear(child);
-      ats_free(child);
-    }
-  }
-}
-
 template <typename T>
 void
 Trie<T>::Clear()
@@ -222,7 +279,8 @@ Trie<T>::Clear()
   while (nullptr != (iter = m_value_list.pop()))
     delete iter;
 
-  _Clear(&m_root);
+  // Nodes in a shared arena go when the owner resets it.
+  m_own_arena.reset();
   m_root.Clear();
 }
 
@@ -239,16 +297,14 @@ void
 Trie<T>::Node::Print(const char *debug_tag) const
 {
   if (occupied) {
-    Debug(debug_tag, "Node is occupied");
+    Debug(debug_tag, "Node [%.*s] is occupied", label_len, label);
     Debug(debug_tag, "Node has rank %d", rank);
   } else {
-    Debug(debug_tag, "Node is not occupied");
+    Debug(debug_tag, "Node [%.*s] is not occupied", label_len, label);
   }
 
-  for (int i = 0; i < N_NODE_CHILDREN; ++i) {
-    if (GetChild(i)) {
-      Debug(debug_tag, "Node has child for char %c", static_cast<char>(i));
-    }
+  for (int i = 0; i < n_children; ++i) {
+    Debug(debug_tag, "Node has child for [%.*s]", children[i]->label_len, children[i]->label);
   }
 }
 
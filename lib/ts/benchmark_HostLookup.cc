@@ -0,0 +1,195 @@
+/** @file
+
+    HostLookup build and match benchmark.
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    Build with "make -C lib/ts benchmark_HostLookup", it is not part of the default build.
+
+    Usage: benchmark_HostLookup [entries [lookups]]
+
+    Two synthetic workloads are run.
+
+    - parent.config: every entry is a dest_domain on one of a few TLDs, with one or two levels
+      below the registered domain. Lookups are for hosts a level or two deeper, half of them in
+      configured domains.
+    - cache.config: a mix of dest_host and dest_domain entries where most lookups hit several
+      rules, so each lookup walks all of its matches with MatchNext like ControlMatcher does.
+ */
+
+#include "ts/ink_platform.h"
+#include "ts/ink_defs.h"
+#include "ts/ink_hrtime.h"
+#include "ts/HostLookup.h"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+const char *const tlds[] = {"com", "net", "org", "co.uk", "de", "jp", "io"};
+
+struct Workload {
+  const char *name;
+  std::vector<std::string> entries;
+  std::vector<bool> domain;
+  std::vector<std::string> queries;
+};
+
+// A small deterministic generator so runs are comparable.
+uint64_t
+next_rand(uint64_t &state)
+{
+  state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+  return state >> 33;
+}
+
+void
+parent_config(Workload &w, int n, int lookups)
+{
+  char buf[128];
+  uint64_t r = 1;
+
+  w.name = "parent.config";
+  for (int i = 0; i < n; ++i) {
+    const char *tld = tlds[i % countof(tlds)];
+
+    if (i % 4 == 0) {
+      snprintf(buf, sizeof(buf), "origin%d.customer%d.%s", i % 3, i, tld);
+    } else {
+      snprintf(buf, sizeof(buf), "customer%d.%s", i, tld);
+    }
+    w.entries.push_back(buf);
+    w.domain.push_back(true);
+  }
+  for (int i = 0; i < lookups; ++i) {
+    int k = next_rand(r) % (2 * n); // half of these don't exist
+
+    snprintf(buf, sizeof(buf), "img%d.origin%d.customer%d.%s", k % 5, k % 3, k, tlds[k % countof(tlds)]);
+    w.queries.push_back(buf);
+  }
+}
+
+void
+cache_config(Workload &w, int n, int lookups)
+{
+  char buf[128];
+  uint64_t r = 2;
+
+  w.name = "cache.config";
+  for (int i = 0; i < n; ++i) {
+    const char *tld = tlds[(i / 3) % countof(tlds)];
+
+    switch (i % 3) {
+    case 0: // a site wide rule
+      snprintf(buf, sizeof(buf), "site%d.%s", i / 3, tld);
+      w.domain.push_back(true);
+      break;
+    case 1: // a rule for the static host of the same site
+      snprintf(buf, sizeof(buf), "static.site%d.%s", i / 3, tld);
+      w.domain.push_back(false);
+      break;
+    default: // and one for a deep api host
+      snprintf(buf, sizeof(buf), "v2.api.eu.site%d.%s", i / 3, tld);
+      w.domain.push_back(false);
+      break;
+    }
+    w.entries.push_back(buf);
+  }
+  for (int i = 0; i < lookups; ++i) {
+    int k             = next_rand(r) % (n / 3 + 1);
+    const char *tld   = tlds[(k + (next_rand(r) % 4 == 0)) % countof(tlds)]; // a quarter on the wrong TLD
+    const char *hosts = nullptr;
+
+    switch (next_rand(r) % 3) {
+    case 0:
+      hosts = "static";
+      break;
+    case 1:
+      hosts = "v2.api.eu";
+      break;
+    default:
+      hosts = "www";
+      break;
+    }
+    snprintf(buf, sizeof(buf), "%s.site%d.%s", hosts, k, tld);
+    w.queries.push_back(buf);
+  }
+}
+
+void
+run(Workload &w)
+{
+  HostLookup hl(w.name);
+  ink_hrtime start = ink_get_hrtime_internal();
+
+  hl.AllocateSpace(w.entries.size());
+  for (size_t i = 0; i < w.entries.size(); ++i) {
+    hl.NewEntry(w.entries[i].c_str(), w.domain[i], reinterpret_cast<void *>(i + 1));
+  }
+
+  ink_hrtime built = ink_get_hrtime_internal();
+  uint64_t matches = 0;
+  uint64_t hits    = 0;
+
+  for (const std::string &q : w.queries) {
+    HostLookupState s;
+    void *opaque = nullptr;
+    bool hit     = false;
+
+    for (bool r = hl.MatchFirst(q.c_str(), &s, &opaque); r; r = hl.MatchNext(&s, &opaque)) {
+      ++matches;
+      hit = true;
+    }
+    hits += hit;
+  }
+
+  ink_hrtime done = ink_get_hrtime_internal();
+
+  printf("%-14s entries %8zu  build %8" PRId64 " ms  lookups %8zu  %7.1f ns/lookup  hits %5.1f%%  matches/lookup %.2f\n",
+         w.name, w.entries.size(), ink_hrtime_to_msec(built - start), w.queries.size(),
+         static_cast<double>(done - built) / w.queries.size(), 100.0 * hits / w.queries.size(),
+         static_cast<double>(matches) / w.queries.size());
+}
+}
+
+int
+main(int argc, char *argv[])
+{
+  int n       = argc > 1 ? atoi(argv[1]) : 1000000;
+  int lookups = argc > 2 ? atoi(argv[2]) : 1000000;
+
+  if (n <= 0 || lookups <= 0) {
+    fprintf(stderr, "usage: %s [entries [lookups]]\n", argv[0]);
+    return 1;
+  }
+
+  {
+    Workload w;
+    parent_config(w, n, lookups);
+    run(w);
+  }
+  {
+    Workload w;
+    cache_config(w, n, lookups);
+    run(w);
+  }
+
+  return 0;
+}
@@ -497,6 +497,14 @@ ink_file_get_geometry(int fd ATS_UNUSED, ink_device_geometry &geometry)
   }
 #endif
 
+#if defined(BLKIOOPT)
+  // BLKIOOPT gets the optimal I/O size, e.g. the stripe width of a RAID device or the erase block of
+  // some SSDs. Most devices report 0.
+  if (ioctl(fd, BLKIOOPT, &arg.u32) == 0) {
+    geometry.iosz = arg.u32;
+  }
+#endif
+
 #else /* No raw device support on this platform. */
 
   errno = ENOTSUP;
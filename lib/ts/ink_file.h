@@ -111,6 +111,7 @@ struct ink_device_geometry {
   uint64_t totalsz; // Total device size in bytes.
   unsigned blocksz; // Preferred I/O block size.
   unsigned alignsz; // Block device alignment in bytes. Only relevant with stacked block devices.
+  unsigned iosz;    // Optimal I/O size in bytes, 0 if the device doesn't report one.
 };
 
 bool ink_file_get_geometry(int fd, ink_device_geometry &geometry);
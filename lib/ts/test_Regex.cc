@@ -55,3 +55,82 @@ REGRESSION_TEST(Regex_basic)(RegressionTest *t, int /* atype ATS_UNUSED */, int
     }
   }
 }
+
+typedef struct {
+  char regex[100];
+  char literal[100]; // empty if there should be none
+} literal_test_t;
+
+static const literal_test_t literal_test_data[] = {
+  {"^www\\.example\\.com$", "www.example.com"},
+  {"^(.*)\\.Example\\.com$", ".example.com"},
+  {"^images[0-9]+\\.cdn\\.net", ".cdn.net"},
+  {"colou?r-scheme", "r-scheme"},
+  {"ab+c", "ab"},
+  {"abcd{2,3}e", "abc"},
+  {"^[a-z]+\\d\\.org", ".org"},
+  {"(foo|bar)\\.com", ".com"},
+  {"foo|bar", ""},
+  {"\\x41bc", ""},
+  {"(?x) a b c", ""},
+  {"\\Qa.b\\E", ""},
+  {".*", ""},
+};
+
+REGRESSION_TEST(Regex_prefilter_literal)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  TestBox box(t, pstatus, REGRESSION_TEST_PASSED);
+
+  for (unsigned int i = 0; i < countof(literal_test_data); i++) {
+    std::string literal;
+    bool found = RegexPrefilter::required_literal(literal_test_data[i].regex, literal);
+
+    box.check(found == (literal_test_data[i].literal[0] != '\0') && literal == literal_test_data[i].literal,
+              "Regex: %s Literal: '%s' expected '%s'\n", literal_test_data[i].regex, literal.c_str(),
+              literal_test_data[i].literal);
+  }
+}
+
+REGRESSION_TEST(Regex_prefilter_match)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  TestBox box(t, pstatus, REGRESSION_TEST_PASSED);
+
+  static const char *patterns[] = {"^www\\.example\\.com$", "^(.*)\\.example\\.com$", "cdn[0-9]+\\.example\\.net",
+                                   "^[a-z]+$", "example", "he", "she", "hers", ".*"};
+  static const char *subjects[] = {"www.example.com", "img.example.com", "cdn12.example.net", "localhost", "ushers",
+                                   "EXAMPLE.ORG", "", "1.2.3.4"};
+  Regex regexes[countof(patterns)];
+  RegexPrefilter filter;
+  DFA dfa;
+
+  for (unsigned int i = 0; i < countof(patterns); i++) {
+    regexes[i].compile(patterns[i]);
+    box.check(filter.add(patterns[i]) == static_cast<int>(i), "Pattern %s got the wrong index", patterns[i]);
+  }
+  filter.compile();
+  dfa.compile(patterns + 1, countof(patterns) - 1, RE_UNANCHORED);
+
+  // Every pattern that matches must be a candidate, and the DFA must still find the first match.
+  for (unsigned int j = 0; j < countof(subjects); j++) {
+    RegexPrefilter::Candidates candidates(filter, subjects[j], strlen(subjects[j]));
+    int first = -1;
+
+    for (unsigned int i = 0; i < countof(patterns); i++) {
+      if (regexes[i].exec(subjects[j])) {
+        box.check(candidates.test(i), "Subject %s matches %s but it was filtered", subjects[j], patterns[i]);
+        if (first == -1 && i > 0) {
+          first = i - 1;
+        }
+      }
+    }
+    box.check(dfa.match(subjects[j]) == first, "Subject %s DFA match %d expected %d", subjects[j], dfa.match(subjects[j]),
+              first);
+  }
+
+  // A literal that doesn't occur rules the pattern out.
+  RegexPrefilter::Candidates none(filter, "localhost", 9);
+  box.check(!none.test(0) && !none.test(4) && none.test(3) && none.test(8), "Prefilter candidates for localhost are wrong");
+
+  RegexPrefilter::Candidates overlap(filter, "ushers", 6);
+  box.check(overlap.test(5) && overlap.test(6) && overlap.test(7), "Overlapping literals were missed");
+}
@@ -47,6 +47,7 @@ main(int argc, const char **argv)
       printf("\ttotalsz: %" PRId64 "\n", geometry.totalsz);
       printf("\tblocksz: %u\n", geometry.blocksz);
       printf("\talignsz: %u\n", geometry.alignsz);
+      printf("\tiosz: %u\n", geometry.iosz);
     } else {
       printf("%s: %s (%d)\n", argv[i], strerror(errno), errno);
     }
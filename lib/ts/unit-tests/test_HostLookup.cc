@@ -0,0 +1,147 @@
+/** @file
+
+    HostLookup unit tests.
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <ts/ink_platform.h>
+#include <ts/HostLookup.h>
+#include <catch.hpp>
+
+#include <string>
+
+namespace
+{
+// All the entries matching @a host, in match order, as a string of their tags.
+std::string
+match_all(HostLookup &hl, const char *host)
+{
+  HostLookupState s;
+  void *opaque = nullptr;
+  std::string result;
+
+  for (bool r = hl.MatchFirst(host, &s, &opaque); r; r = hl.MatchNext(&s, &opaque)) {
+    result += static_cast<const char *>(opaque);
+  }
+  return result;
+}
+}
+
+TEST_CASE("HostLookup host and domain entries", "[libts][HostLookup]")
+{
+  HostLookup hl("test");
+
+  hl.AllocateSpace(8);
+  hl.NewEntry("example.com", true, const_cast<char *>("A"));        // domain
+  hl.NewEntry("www.example.com", false, const_cast<char *>("B"));   // host
+  hl.NewEntry("EXAMPLE.com", false, const_cast<char *>("C"));       // host, case folded
+  hl.NewEntry("a.b.c.example.com", false, const_cast<char *>("D")); // deeper than the table
+  hl.NewEntry("c.example.com", true, const_cast<char *>("E"));
+  hl.NewEntry("x.y.c.example.com", true, const_cast<char *>("F")); // partial domain
+  hl.NewEntry("org", true, const_cast<char *>("G"));
+
+  REQUIRE(match_all(hl, "example.com") == "AC");
+  REQUIRE(match_all(hl, "www.example.com") == "AB");
+  REQUIRE(match_all(hl, "WWW.Example.Com") == "AB");
+  REQUIRE(match_all(hl, "mail.example.com") == "A");
+  REQUIRE(match_all(hl, "a.b.c.example.com") == "ADE");
+  REQUIRE(match_all(hl, "q.x.y.c.example.com") == "AEF");
+  REQUIRE(match_all(hl, "y.c.example.com") == "AE");
+  REQUIRE(match_all(hl, "example.org") == "G");
+  REQUIRE(match_all(hl, "example.net") == "");
+  REQUIRE(match_all(hl, "com") == "");
+  REQUIRE(match_all(hl, "") == "");
+}
+
+TEST_CASE("HostLookup negated labels", "[libts][HostLookup]")
+{
+  HostLookup hl("test");
+
+  hl.AllocateSpace(4);
+  hl.NewEntry("!internal.example.com", true, const_cast<char *>("N"));
+  hl.NewEntry("www.example.com", false, const_cast<char *>("W"));
+
+  // Any second level label other than "internal" goes down the negated branch.
+  REQUIRE(match_all(hl, "www.example.com") == "W");
+  REQUIRE(match_all(hl, "cdn.example.com") == "N");
+  REQUIRE(match_all(hl, "internal.example.com") == "");
+}
+
+TEST_CASE("HostLookup negated labels among many siblings", "[libts][HostLookup]")
+{
+  HostLookup hl("test");
+  char buf[64];
+
+  hl.AllocateSpace(HOST_ARRAY_MAX + 1);
+  hl.NewEntry("!internal.example.com", true, const_cast<char *>("N"));
+  for (int i = 1; i < HOST_ARRAY_MAX; ++i) {
+    snprintf(buf, sizeof(buf), "site%d.example.com", i);
+    hl.NewEntry(buf, true, const_cast<char *>("S"));
+  }
+
+  // Up to HOST_ARRAY_MAX siblings the negation applies ...
+  REQUIRE(match_all(hl, "cdn.example.com") == "N");
+
+  // ... past that "!internal" is just a label, like the old hash table level.
+  hl.NewEntry("www.example.com", true, const_cast<char *>("W"));
+  REQUIRE(match_all(hl, "cdn.example.com") == "");
+  REQUIRE(match_all(hl, "www.example.com") == "W");
+}
+
+TEST_CASE("HostLookup negated labels at the top level", "[libts][HostLookup]")
+{
+  HostLookup hl("test");
+
+  hl.AllocateSpace(2);
+  hl.NewEntry("!com", true, const_cast<char *>("N"));
+  hl.NewEntry("net", true, const_cast<char *>("T"));
+
+  REQUIRE(match_all(hl, "example.org") == "");
+  REQUIRE(match_all(hl, "example.net") == "T");
+}
+
+TEST_CASE("HostLookup many siblings", "[libts][HostLookup]")
+{
+  const int N = 5000;
+  HostLookup hl("test");
+  std::vector<std::string> names;
+  char buf[64];
+
+  hl.AllocateSpace(N);
+  names.reserve(N);
+  for (int i = 0; i < N; ++i) {
+    snprintf(buf, sizeof(buf), "site%d.%s", i, (i & 1) ? "com" : "net");
+    names.push_back(buf);
+  }
+  for (int i = 0; i < N; ++i) {
+    hl.NewEntry(names[i].c_str(), true, const_cast<char *>(names[i].c_str()));
+  }
+
+  for (int i = 0; i < N; i += 7) {
+    HostLookupState s;
+    void *opaque = nullptr;
+
+    snprintf(buf, sizeof(buf), "www.%s", names[i].c_str());
+    REQUIRE(hl.MatchFirst(buf, &s, &opaque));
+    REQUIRE(opaque == names[i].c_str());
+    REQUIRE_FALSE(hl.MatchNext(&s, &opaque));
+  }
+  REQUIRE(match_all(hl, "site1.net") == "");
+}
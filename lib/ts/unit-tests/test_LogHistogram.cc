@@ -0,0 +1,118 @@
+/** @file
+
+    LogHistogram unit tests.
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <ts/LogHistogram.h>
+#include <catch.hpp>
+
+using ts::LogHistogram;
+
+TEST_CASE("LogHistogram buckets", "[libts][LogHistogram]")
+{
+  // Small values are exact.
+  for (uint64_t v = 0; v < LogHistogram::SUB_BUCKETS; ++v) {
+    REQUIRE(LogHistogram::bucket_index(v) == static_cast<int>(v));
+  }
+
+  // Every value lands in a bucket whose bounds contain it, and buckets are contiguous.
+  for (uint64_t v = 1; v < (static_cast<uint64_t>(1) << LogHistogram::MAX_BITS); v = v * 3 / 2 + 1) {
+    int idx = LogHistogram::bucket_index(v);
+    REQUIRE(idx < LogHistogram::N_BUCKETS);
+    REQUIRE(LogHistogram::bucket_lower(idx) <= v);
+    REQUIRE(v <= LogHistogram::bucket_upper(idx));
+    // relative bucket width is bounded by 1/SUB_BUCKETS, except for the open ended last bucket
+    if (idx < LogHistogram::N_BUCKETS - 1) {
+      REQUIRE((LogHistogram::bucket_upper(idx) - LogHistogram::bucket_lower(idx)) * LogHistogram::SUB_BUCKETS <= v);
+    }
+  }
+  for (int idx = 1; idx < LogHistogram::N_BUCKETS; ++idx) {
+    REQUIRE(LogHistogram::bucket_lower(idx) == LogHistogram::bucket_upper(idx - 1) + 1);
+  }
+
+  // Overflow goes to the last bucket.
+  REQUIRE(LogHistogram::bucket_index(UINT64_MAX) == LogHistogram::N_BUCKETS - 1);
+}
+
+TEST_CASE("LogHistogram percentiles", "[libts][LogHistogram]")
+{
+  LogHistogram h, other;
+
+  h.clear();
+  REQUIRE(h.percentile(0.5) == 0);
+  REQUIRE(h.max() == 0);
+
+  for (uint64_t v = 1; v <= 1000; ++v) {
+    h.record(v);
+  }
+  REQUIRE(h.count == 1000);
+  REQUIRE(h.sum == 500500);
+
+  uint64_t p50 = h.percentile(0.50);
+  uint64_t p99 = h.percentile(0.99);
+  REQUIRE(p50 >= 500);
+  REQUIRE(p50 <= 500 + 500 / LogHistogram::SUB_BUCKETS);
+  REQUIRE(p99 >= 990);
+  REQUIRE(p99 <= 990 + 990 / LogHistogram::SUB_BUCKETS);
+  REQUIRE(h.max() >= 1000);
+  REQUIRE(h.percentile(1.0) == h.max());
+
+  other.clear();
+  for (int i = 0; i < 1000; ++i) {
+    other.record(1000000);
+  }
+  h.merge(other);
+  REQUIRE(h.count == 2000);
+  REQUIRE(h.percentile(0.25) <= 500 + 500 / LogHistogram::SUB_BUCKETS);
+  REQUIRE(h.percentile(0.75) >= 1000000);
+}
+
+TEST_CASE("LogHistogram intervals", "[libts][LogHistogram]")
+{
+  LogHistogram total, earlier, interval;
+
+  // A slow start, then fast samples. The interval only holds the fast ones.
+  total.clear();
+  for (int i = 0; i < 1000; ++i) {
+    total.record(1000000);
+  }
+  earlier = total;
+  for (int i = 0; i < 100; ++i) {
+    total.record(10);
+  }
+
+  interval = total;
+  interval.subtract(earlier);
+  REQUIRE(interval.count == 100);
+  REQUIRE(interval.sum == 1000);
+  REQUIRE(interval.max() == LogHistogram::bucket_upper(LogHistogram::bucket_index(10)));
+  REQUIRE(interval.percentile(0.999) == interval.max());
+  REQUIRE(total.percentile(0.5) >= 1000000);
+
+  // Merging the intervals back gives the total again.
+  interval.merge(earlier);
+  REQUIRE(memcmp(&interval, &total, sizeof(total)) == 0);
+
+  interval = earlier;
+  interval.subtract(earlier);
+  REQUIRE(interval.count == 0);
+  REQUIRE(interval.max() == 0);
+}
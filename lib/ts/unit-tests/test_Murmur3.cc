@@ -0,0 +1,69 @@
+/** @file
+
+    Murmur3Context unit tests.
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <ts/Murmur3.h>
+#include <catch.hpp>
+#include <algorithm>
+#include <cstring>
+
+TEST_CASE("Murmur3 reference values", "[libts][Murmur3]")
+{
+  CryptoHash hash;
+
+  Murmur3Context().hash_immediate(hash, "", 0);
+  REQUIRE(hash.u64[0] == 0);
+  REQUIRE(hash.u64[1] == 0);
+
+  Murmur3Context().hash_immediate(hash, "hello", 5);
+  REQUIRE(hash.u64[0] == 0xcbd8a7b341bd9b02ULL);
+  REQUIRE(hash.u64[1] == 0x5b1e906a48ae1d19ULL);
+
+  const char *fox = "The quick brown fox jumps over the lazy dog";
+  Murmur3Context().hash_immediate(hash, fox, strlen(fox));
+  REQUIRE(hash.u64[0] == 0xe34bbc7bbc071b6cULL);
+  REQUIRE(hash.u64[1] == 0x7a433ca9c49a9347ULL);
+}
+
+TEST_CASE("Murmur3 incremental", "[libts][Murmur3]")
+{
+  char data[100];
+  CryptoHash whole;
+
+  for (unsigned i = 0; i < sizeof(data); ++i) {
+    data[i] = 'a' + (i * 7) % 26;
+  }
+  Murmur3Context().hash_immediate(whole, data, sizeof(data));
+
+  // The result must not depend on how the input is split up.
+  for (int step = 1; step < 40; ++step) {
+    Murmur3Context ctx;
+    CryptoHash pieces;
+
+    for (int off = 0; off < static_cast<int>(sizeof(data)); off += step) {
+      int n = std::min(step, static_cast<int>(sizeof(data)) - off);
+      ctx.update(data + off, n);
+    }
+    ctx.finalize(pieces);
+    REQUIRE(pieces == whole);
+  }
+}
@@ -0,0 +1,101 @@
+/** @file
+
+    Trie unit tests.
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <ts/Diags.h>
+#include <ts/Trie.h>
+#include <catch.hpp>
+
+namespace
+{
+struct Item {
+  explicit Item(int n) : id(n) {}
+  void
+  Print() const
+  {
+  }
+  int id;
+  LINK(Item, link);
+};
+}
+
+TEST_CASE("Trie longest prefix by rank", "[libts][Trie]")
+{
+  Trie<Item> trie;
+
+  REQUIRE(trie.Empty());
+  REQUIRE(trie.Search("/anything") == nullptr);
+
+  REQUIRE(trie.Insert("/images/", new Item(1), 1));
+  REQUIRE(trie.Insert("/images/icons/", new Item(2), 2));
+  REQUIRE(trie.Insert("/img", new Item(3), 3));   // splits "/images/"
+  REQUIRE(trie.Insert("/im", new Item(4), 4));    // lands on an existing split point
+  REQUIRE(trie.Insert("/video", new Item(5), 0)); // lower rank than everything
+
+  Item *dup = new Item(6);
+  REQUIRE_FALSE(trie.Insert("/img", dup, 6));
+  delete dup;
+  REQUIRE_FALSE(trie.Empty());
+
+  // The lowest ranked of all the keys that are a prefix of the search wins.
+  REQUIRE(trie.Search("/images/icons/x.png")->id == 1);
+  REQUIRE(trie.Search("/images/x.png")->id == 1);
+  REQUIRE(trie.Search("/img/x.png")->id == 3);
+  REQUIRE(trie.Search("/imx")->id == 4);
+  REQUIRE(trie.Search("/im")->id == 4);
+  REQUIRE(trie.Search("/i") == nullptr);
+  REQUIRE(trie.Search("/images")->id == 4);
+  REQUIRE(trie.Search("/videos/a")->id == 5);
+  REQUIRE(trie.Search("/vid") == nullptr);
+
+  // Explicit lengths, the key doesn't have to be terminated.
+  REQUIRE(trie.Search("/img/x.png", 4)->id == 3);
+  REQUIRE(trie.Search("/img/x.png", 3)->id == 4);
+
+  trie.Clear();
+  REQUIRE(trie.Empty());
+  REQUIRE(trie.Search("/images/") == nullptr);
+}
+
+TEST_CASE("Trie shared arena", "[libts][Trie]")
+{
+  Arena arena;
+  Trie<Item> a(&arena);
+  Trie<Item> b(&arena);
+  char key[8];
+
+  // Enough siblings under one node to grow the child arrays a few times.
+  for (int i = 0; i < 200; ++i) {
+    snprintf(key, sizeof(key), "/%c%03d", 'a' + i % 26, i);
+    REQUIRE(a.Insert(key, new Item(i), i));
+  }
+  REQUIRE(b.Insert("", new Item(1000), 1000));
+
+  for (int i = 0; i < 200; ++i) {
+    snprintf(key, sizeof(key), "/%c%03d", 'a' + i % 26, i);
+    Item *item = a.Search(key);
+    REQUIRE(item != nullptr);
+    REQUIRE(item->id == i);
+  }
+  REQUIRE(b.Search("/anything")->id == 1000);
+  REQUIRE(a.Search("/z") == nullptr);
+}
@@ -24,10 +24,15 @@
 #include "ts/ink_platform.h"
 #include "ProxyConfig.h"
 #include "P_EventSystem.h"
+#include "I_RecProcess.h"
 #include "ts/TestBox.h"
 
 ConfigProcessor configProcessor;
 
+// Time from replacing a config until the config processor drops it, in milliseconds.
+static RecHistogramBlock *config_rhb = nullptr;
+enum { config_reclaim_lag_histogram, config_histogram_count };
+
 void *
 config_int_cb(void *data, void *value)
 {
@@ -90,25 +95,95 @@ config_string_alloc_cb(void *data, void *value)
   return nullptr;
 }
 
+// Drops the config processor reference to a replaced config once the timeout has expired and
+// every regular EThread has been around its event loop since the replacement, so that nothing
+// can still be using a pointer it got from ConfigProcessor::read(). The event loops are polled
+// from the replacement on, so that the reclaim lag stat measures how long that took rather than
+// the timeout.
 class ConfigInfoReleaser : public Continuation
 {
 public:
-  ConfigInfoReleaser(unsigned int id, ConfigInfo *info) : Continuation(new_ProxyMutex()), m_id(id), m_info(info)
+  ConfigInfoReleaser(unsigned int id, ConfigInfo *info, ink_hrtime hold)
+    : Continuation(new_ProxyMutex()),
+      m_id(id),
+      m_info(info),
+      m_retired(Thread::get_hrtime()),
+      m_release(m_retired + hold),
+      m_quiescent(false),
+      m_nthreads(0),
+      m_passes(nullptr)
   {
     SET_HANDLER(&ConfigInfoReleaser::handle_event);
+
+    auto threads = eventProcessor.active_ethreads();
+    int n        = threads.end() - threads.begin();
+
+    if (n > 0) {
+      m_passes = static_cast<uint64_t *>(ats_malloc(n * sizeof(uint64_t)));
+      for (EThread *et : threads) {
+        m_passes[m_nthreads++] = __atomic_load_n(&et->loop_passes, __ATOMIC_ACQUIRE);
+      }
+    }
   }
 
+  ~ConfigInfoReleaser() { ats_free(m_passes); }
+
   int
-  handle_event(int /* event ATS_UNUSED */, void * /* edata ATS_UNUSED */)
+  handle_event(int /* event ATS_UNUSED */, Event *e)
   {
+    if (!m_quiescent) {
+      if (!quiescent()) {
+        e->schedule_in(HRTIME_MSECONDS(10));
+        return EVENT_CONT;
+      }
+      m_quiescent = true;
+      if (config_rhb && this_ethread()) {
+        RecHistogramRecord(config_rhb, this_ethread(), config_reclaim_lag_histogram,
+                           ink_hrtime_to_msec(Thread::get_hrtime() - m_retired));
+      }
+    }
+
+    ink_hrtime now = Thread::get_hrtime();
+    if (now < m_release) {
+      e->schedule_in(m_release - now);
+      return EVENT_CONT;
+    }
+
     configProcessor.release(m_id, m_info);
     delete this;
     return EVENT_DONE;
   }
 
+private:
+  // True if every thread other than this one has started a new pass since the config was retired.
+  bool
+  quiescent() const
+  {
+    EThread *self = this_ethread();
+    int i         = 0;
+
+    for (EThread *et : eventProcessor.active_ethreads()) {
+      if (i >= m_nthreads) {
+        break; // Started after the retirement, can't have seen the old config.
+      }
+      if (et != self && __atomic_load_n(&et->loop_passes, __ATOMIC_ACQUIRE) == m_passes[i]) {
+        return false;
+      }
+      ++i;
+    }
+    return true;
+  }
+
 public:
   unsigned int m_id;
   ConfigInfo *m_info;
+
+private:
+  ink_hrtime m_retired; // When the config was replaced.
+  ink_hrtime m_release; // When the timeout expires.
+  bool m_quiescent;     // Every thread has been around its loop since @a m_retired.
+  int m_nthreads;       // Entries in @a m_passes.
+  uint64_t *m_passes;   // Loop passes of each regular thread when the config was replaced.
 };
 
 ConfigProcessor::ConfigProcessor() : ninfos(0)
@@ -156,7 +231,7 @@ ConfigProcessor::set(unsigned int id, ConfigInfo *info, unsigned timeout_secs)
     // The ConfigInfoReleaser now takes our refcount, but
     // someother thread might also have one ...
     ink_assert(old_info->refcount() > 0);
-    eventProcessor.schedule_in(new ConfigInfoReleaser(id, old_info), HRTIME_SECONDS(timeout_secs));
+    eventProcessor.schedule_imm(new ConfigInfoReleaser(id, old_info, HRTIME_SECONDS(timeout_secs)));
   }
 
   return id;
@@ -185,6 +260,36 @@ ConfigProcessor::get(unsigned int id)
   return info;
 }
 
+ConfigInfo *
+ConfigProcessor::read(unsigned int id, bool &ref)
+{
+  EThread *ethread = this_ethread();
+
+  if (ethread == nullptr || ethread->tt != REGULAR) {
+    ref = true;
+    return get(id);
+  }
+
+  ink_assert(id != 0);
+  ink_assert(id <= MAX_CONFIGS);
+
+  ref = false;
+  if (id == 0 || id > MAX_CONFIGS) {
+    return nullptr;
+  }
+
+  return __atomic_load_n(&infos[id - 1], __ATOMIC_ACQUIRE);
+}
+
+void
+ConfigProcessor::init_stats()
+{
+  config_rhb = RecAllocateHistogramBlock((int)config_histogram_count);
+  if (config_rhb) {
+    RecRegisterHistogram(config_rhb, RECT_PROCESS, "proxy.process.config.reclaim_lag", (int)config_reclaim_lag_histogram);
+  }
+}
+
 void
 ConfigProcessor::release(unsigned int id, ConfigInfo *info)
 {
@@ -351,4 +456,33 @@ EXCLUSIVE_REGRESSION_TEST(ProxyConfig_Release)(RegressionTest *test, int /* atyp
   RegressionConfig::defer(2, ProxyConfig_Release_Completion(configid, config));
 }
 
+// Test that ConfigProcessor::read() hands out the current config without a reference count on a
+// regular EThread, and with one anywhere else.
+REGRESSION_TEST(ProxyConfig_Read)(RegressionTest *test, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  TestBox box(test, pstatus);
+  EThread *ethread = this_ethread();
+  ConfigInfo *config;
+  int configid;
+  bool ref;
+
+  box = REGRESSION_TEST_PASSED;
+
+  configid = configProcessor.set(0, new ConfigInfo, 1);
+  config   = configProcessor.read(configid, ref);
+
+  box.check(config == configProcessor.infos[configid - 1], "read() returned %p, the current config is %p", config,
+            configProcessor.infos[configid - 1]);
+  box.check(ref == (ethread == nullptr || ethread->tt != REGULAR), "read() %s a reference on this thread",
+            ref ? "took" : "did not take");
+  box.check(config->refcount() == (ref ? 2 : 1), "invalid refcount %d", config->refcount());
+
+  if (ref) {
+    configProcessor.release(configid, config);
+  }
+
+  // Replace it, the old one goes away once this thread is back in its event loop.
+  configProcessor.set(configid, new ConfigInfo, 1);
+}
+
 #endif /* TS_HAS_TESTS */
@@ -65,6 +65,9 @@ void *config_string_alloc_cb(void *data, void *value);
 
 typedef RefCountObj ConfigInfo;
 
+class ConfigProcessor;
+extern ConfigProcessor configProcessor;
+
 class ConfigProcessor
 {
 public:
@@ -76,14 +79,22 @@ public:
     CONFIG_PROCESSOR_RELEASE_SECS = 60
   };
 
+  // The config for the lifetime of a scope. On a regular EThread this doesn't touch the reference
+  // count, see read(). The class needs a static configid and release().
   template <typename ClassType, typename ConfigType> struct scoped_config {
-    scoped_config() : ptr(ClassType::acquire()) {}
-    ~scoped_config() { ClassType::release(ptr); }
+    scoped_config() : ptr(static_cast<ConfigType *>(configProcessor.read(ClassType::configid, ref))) {}
+    ~scoped_config()
+    {
+      if (ref) {
+        ClassType::release(ptr);
+      }
+    }
     operator bool() const { return ptr != 0; }
     operator const ConfigType *() const { return ptr; }
     const ConfigType *operator->() const { return ptr; }
 
   private:
+    bool ref;
     ConfigType *ptr;
   };
 
@@ -91,6 +102,18 @@ public:
   ConfigInfo *get(unsigned int id);
   void release(unsigned int id, ConfigInfo *data);
 
+  /** Get the current config for @a id without a reference count if that is safe.
+
+      On a regular EThread the current pointer is just loaded and @a ref is set to @c false. The
+      config stays valid until the thread goes back to its event loop, because a replaced config is
+      only released after every regular thread has been around its loop since the replacement.
+      Anywhere else this is @c get, @a ref is set and the caller must @c release the config.
+   */
+  ConfigInfo *read(unsigned int id, bool &ref);
+
+  /// Register the config processor stats, before the event threads start.
+  void init_stats();
+
 public:
   ConfigInfo *infos[MAX_CONFIGS];
   int ninfos;
@@ -139,6 +162,4 @@ private:
   Ptr<ProxyMutex> mutex;
 };
 
-extern ConfigProcessor configProcessor;
-
 #endif
@@ -25,6 +25,7 @@
 #include "Utils.h"
 
 #include <cctype>
+#include <cstring>
 
 using std::string;
 using namespace EsiLib;
@@ -95,7 +96,7 @@ EsiParser::parseChunk(const char *data, DocNodeList &node_list, int data_len /*
   if (!_setup(_data, _parse_start_pos, _orig_output_list_size, node_list, data, data_len)) {
     return false;
   }
-  if (!_parse(_data, _parse_start_pos, node_list)) {
+  if (!_parse(_data, _parse_start_pos, node_list, false, &_scan_start_pos)) {
     _errorLog("[%s] Failed to parse chunk of size %d starting with [%.5s]...", __FUNCTION__, data_len,
               (data_len ? data : "(null)"));
     return false;
@@ -127,35 +128,30 @@ EsiParser::MATCH_TYPE
 EsiParser::_searchData(const string &data, size_t start_pos, const char *str, int str_len, size_t &pos) const
 {
   const char *data_ptr = data.data() + start_pos;
-  int data_len         = data.size() - start_pos;
-  int i_data = 0, i_str = 0;
-
-  while (i_data < data_len) {
-    if (data_ptr[i_data] == str[i_str]) {
-      ++i_str;
-      if (i_str == str_len) {
-        break;
+  const char *data_end = data.data() + data.size();
+  const char *p        = data_ptr;
+
+  // jump between occurrences of the first char instead of walking every byte
+  while ((p = static_cast<const char *>(memchr(p, str[0], data_end - p))) != nullptr) {
+    int avail = data_end - p;
+    if (avail >= str_len) {
+      if (memcmp(p, str, str_len) == 0) {
+        pos = p - data.data();
+        _debugLog(_debug_tag, "[%s] Found full match of %.*s in [%.5s...] at position %d", __FUNCTION__, str_len, str, data_ptr,
+                  pos);
+        return COMPLETE_MATCH;
       }
-    } else {
-      i_data -= i_str;
-      i_str = 0;
+    } else if (memcmp(p, str, avail) == 0) {
+      pos = p - data.data();
+      _debugLog(_debug_tag, "[%s] Found partial match of %.*s in [%.5s...] at position %d", __FUNCTION__, str_len, str, data_ptr,
+                pos);
+      return PARTIAL_MATCH;
     }
-    ++i_data;
+    ++p;
   }
 
-  if (i_str == str_len) {
-    pos = start_pos + i_data + 1 - i_str;
-    _debugLog(_debug_tag, "[%s] Found full match of %.*s in [%.5s...] at position %d", __FUNCTION__, str_len, str, data_ptr, pos);
-    return COMPLETE_MATCH;
-  } else if (i_str) {
-    pos = start_pos + i_data - i_str;
-    _debugLog(_debug_tag, "[%s] Found partial match of %.*s in [%.5s...] at position %d", __FUNCTION__, str_len, str, data_ptr,
-              pos);
-    return PARTIAL_MATCH;
-  } else {
-    _debugLog(_debug_tag, "[%s] Found no match of %.*s in [%.5s...]", __FUNCTION__, str_len, str, data_ptr);
-    return NO_MATCH;
-  }
+  _debugLog(_debug_tag, "[%s] Found no match of %.*s in [%.5s...]", __FUNCTION__, str_len, str, data_ptr);
+  return NO_MATCH;
 }
 
 EsiParser::MATCH_TYPE
@@ -182,68 +178,43 @@ EsiParser::_compareData(const string &data, size_t pos, const char *str, int str
   return PARTIAL_MATCH;
 }
 
-/** This implementation is optimized but not completely correct.  If
- * the opening tag were to have a repeating opening sequence ('<e<esi'
- * or something like that), this will break. However that is not the
- * case for the two opening tags we are looking for */
+/** Both opening tags start with '<', so only the positions of that char
+ * need to be looked at. A tag that is cut off by the end of the data is
+ * reported as a partial match at its '<'. */
 EsiParser::MATCH_TYPE
 EsiParser::_findOpeningTag(const string &data, size_t start_pos, size_t &opening_tag_pos, bool &is_html_comment_node) const
 {
-  size_t i_data = start_pos;
-  int i_esi = 0, i_html_comment = 0;
-
-  while (i_data < data.size()) {
-    if (data[i_data] == ESI_TAG_PREFIX[i_esi]) {
-      if (++i_esi == ESI_TAG_PREFIX_LEN) {
-        is_html_comment_node = false;
-        opening_tag_pos      = i_data - i_esi + 1;
-        return COMPLETE_MATCH;
-      }
-    } else {
-      if (i_esi) {
-        i_esi = 0;
-        --i_data; // we do this to reexamine the current char as target string might start from here
-        if (i_html_comment) {
-          --i_html_comment; // in case other target string has started matching, adjust it's index
-        }
-      }
+  const char *data_start = data.data();
+  const char *data_end   = data_start + data.size();
+  const char *p          = data_start + start_pos;
+  const char *comment    = HTML_COMMENT_NODE_INFO.tag_suffix;
+  int comment_len        = HTML_COMMENT_NODE_INFO.tag_suffix_len;
+
+  while (p < data_end && (p = static_cast<const char *>(memchr(p, '<', data_end - p))) != nullptr) {
+    int avail = data_end - p;
+
+    if (avail >= ESI_TAG_PREFIX_LEN ? memcmp(p, ESI_TAG_PREFIX, ESI_TAG_PREFIX_LEN) == 0 : memcmp(p, ESI_TAG_PREFIX, avail) == 0) {
+      is_html_comment_node = false;
+      opening_tag_pos      = p - data_start;
+      return avail >= ESI_TAG_PREFIX_LEN ? COMPLETE_MATCH : PARTIAL_MATCH;
     }
-    // doing the exact same thing for the other target string
-    if (i_html_comment < HTML_COMMENT_NODE_INFO.tag_suffix_len &&
-        data[i_data] == HTML_COMMENT_NODE_INFO.tag_suffix[i_html_comment]) {
-      if (++i_html_comment == HTML_COMMENT_NODE_INFO.tag_suffix_len && i_data + 1 < data.size()) {
-        char ch = data[i_data + 1]; //<!--esi must follow by a space char
+
+    if (avail > comment_len) {
+      if (memcmp(p, comment, comment_len) == 0) {
+        char ch = p[comment_len]; //<!--esi must follow by a space char
         if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n') {
           is_html_comment_node = true;
-          opening_tag_pos      = i_data - i_html_comment + 1;
+          opening_tag_pos      = p - data_start;
           return COMPLETE_MATCH;
         }
       }
-    } else {
-      if (i_html_comment) {
-        i_html_comment = 0;
-        --i_data; // same comments from above applies
-        if (i_esi) {
-          --i_esi;
-        }
-      }
+    } else if (memcmp(p, comment, avail) == 0) {
+      // cannot tell yet whether the space char follows
+      is_html_comment_node = true;
+      opening_tag_pos      = p - data_start;
+      return PARTIAL_MATCH;
     }
-    ++i_data;
-  }
-  // partial matches; with the nature of our current opening tags, the
-  // only way we can have a partial match for both target strings is
-  // if the last char of the input string is '<' and that is not
-  // enough information to differentiate the tags; Anyway, the parser
-  // takes no action for a partial match
-  if (i_esi) {
-    is_html_comment_node = false;
-    opening_tag_pos      = i_data - i_esi;
-    return PARTIAL_MATCH;
-  }
-  if (i_html_comment) {
-    is_html_comment_node = true;
-    opening_tag_pos      = i_data - i_html_comment;
-    return PARTIAL_MATCH;
+    ++p;
   }
   return NO_MATCH;
 }
@@ -261,7 +232,8 @@ EsiParser::_processSimpleContentTag(DocNode::TYPE node_type, const char *data, i
 }
 
 bool
-EsiParser::_parse(const string &data, int &parse_start_pos, DocNodeList &node_list, bool last_chunk /* = false */) const
+EsiParser::_parse(const string &data, int &parse_start_pos, DocNodeList &node_list, bool last_chunk /* = false */,
+                  size_t *scan_start_pos /* = nullptr */) const
 {
   size_t orig_list_size = node_list.size();
   size_t curr_pos, end_pos;
@@ -273,8 +245,16 @@ EsiParser::_parse(const string &data, int &parse_start_pos, DocNodeList &node_li
   bool parse_result;
 
   while (parse_start_pos < static_cast<int>(data_size)) {
-    search_result = _findOpeningTag(data, static_cast<int>(parse_start_pos), curr_pos, is_html_comment_node);
+    // skip what earlier chunks already showed to hold no tag
+    curr_pos = parse_start_pos;
+    if (scan_start_pos && *scan_start_pos > curr_pos) {
+      curr_pos = *scan_start_pos;
+    }
+    search_result = _findOpeningTag(data, curr_pos, curr_pos, is_html_comment_node);
     if (search_result == NO_MATCH) {
+      if (scan_start_pos) {
+        *scan_start_pos = data_size;
+      }
       // we could add this chunk as a PRE node, but it might be
       // possible that the next chunk is also a PRE node, in which
       // case it is more correct to create one PRE node than two PRE
@@ -285,6 +265,9 @@ EsiParser::_parse(const string &data, int &parse_start_pos, DocNodeList &node_li
       break;
     }
     if (search_result == PARTIAL_MATCH) {
+      if (scan_start_pos) {
+        *scan_start_pos = curr_pos;
+      }
       goto lPartialMatch;
     }
 
@@ -595,6 +578,7 @@ EsiParser::clear()
 {
   _data.clear();
   _parse_start_pos = -1;
+  _scan_start_pos  = 0;
 }
 
 EsiParser::~EsiParser()
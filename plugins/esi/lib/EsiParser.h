@@ -95,6 +95,7 @@ private:
   std::string _data;
   int _parse_start_pos;
   size_t _orig_output_list_size = 0;
+  size_t _scan_start_pos        = 0; ///< no opening tag starts in [_parse_start_pos, _scan_start_pos)
 
   static const EsiNodeInfo ESI_NODES[];
   static const EsiNodeInfo HTML_COMMENT_NODE_INFO;
@@ -120,7 +121,8 @@ private:
 
   MATCH_TYPE _findOpeningTag(const std::string &data, size_t start_pos, size_t &opening_tag_pos, bool &is_html_comment_node) const;
 
-  bool _parse(const std::string &data, int &parse_start_pos, EsiLib::DocNodeList &node_list, bool last_chunk = false) const;
+  bool _parse(const std::string &data, int &parse_start_pos, EsiLib::DocNodeList &node_list, bool last_chunk = false,
+              size_t *scan_start_pos = nullptr) const;
 
   bool _processIncludeTag(const std::string &data, size_t curr_pos, size_t end_pos, EsiLib::DocNodeList &node_list) const;
 
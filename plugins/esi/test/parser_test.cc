@@ -1579,6 +1579,40 @@ main()
     assert(strncmp(attr_iter->value, "c >= d", attr_iter->value_len) == 0);
   }
 
+  {
+    cout << endl << "===================== Test 59) byte at a time matches whole document" << endl;
+    string input_data("a < b <e <!-- plain --> <!--esx <!--esi <esi:vars>$(HTTP_HOST)</esi:vars> -->"
+                      "<esi:include src=\"http://www.example.com/frag\"/><esi:comment text=\"bleh\"/>"
+                      "trailing text <esi:remove> gone </esi:remove> and a final <");
+    for (int i = 0; i < 200; ++i) {
+      input_data.append("filler text without any tags in it; ");
+    }
+    input_data.append("<esi:include src=last/>end");
+
+    EsiParser whole_parser("parser_test", &Debug, &Error);
+    DocNodeList whole_list;
+    assert(whole_parser.completeParse(whole_list, input_data) == true);
+
+    EsiParser chunk_parser("parser_test", &Debug, &Error);
+    DocNodeList chunk_list;
+    for (size_t i = 0; i < input_data.size(); ++i) {
+      assert(chunk_parser.parseChunk(input_data.data() + i, chunk_list, 1) == true);
+    }
+    assert(chunk_parser.completeParse(chunk_list) == true);
+
+    assert(whole_list.size() == chunk_list.size());
+    DocNodeList::iterator whole_iter = whole_list.begin();
+    DocNodeList::iterator chunk_iter = chunk_list.begin();
+    for (; whole_iter != whole_list.end(); ++whole_iter, ++chunk_iter) {
+      assert(whole_iter->type == chunk_iter->type);
+      assert(whole_iter->data_len == chunk_iter->data_len);
+      assert(strncmp(whole_iter->data, chunk_iter->data, whole_iter->data_len) == 0);
+      assert(whole_iter->attr_list.size() == chunk_iter->attr_list.size());
+    }
+    assert(whole_list.back().type == DocNode::TYPE_PRE);
+    assert(whole_list.back().data_len == 3);
+  }
+
   cout << endl << "All tests passed!" << endl;
   return 0;
 }
@@ -25,12 +25,24 @@
 
 #define TS_LUA_MAX_STATE_COUNT 256
 
-static uint64_t ts_lua_http_next_id   = 0;
-static uint64_t ts_lua_g_http_next_id = 0;
+static int ts_lua_thread_next_slot       = 0;
+static __thread int ts_lua_thread_slot = -1;
 
 static ts_lua_main_ctx *ts_lua_main_ctx_array;
 static ts_lua_main_ctx *ts_lua_g_main_ctx_array;
 
+/* Each thread sticks to one lua state, so the state mutex is only
+ * contended when a transaction continues on another thread. */
+static inline int
+ts_lua_get_thread_slot()
+{
+  if (ts_lua_thread_slot < 0) {
+    ts_lua_thread_slot = __sync_fetch_and_add(&ts_lua_thread_next_slot, 1);
+  }
+
+  return ts_lua_thread_slot;
+}
+
 TSReturnCode
 TSRemapInit(TSRemapInterface *api_info, char *errbuf, int errbuf_size)
 {
@@ -153,7 +165,6 @@ static TSRemapStatus
 ts_lua_remap_plugin_init(void *ih, TSHttpTxn rh, TSRemapRequestInfo *rri)
 {
   int ret;
-  uint64_t req_id;
 
   TSCont contp;
   lua_State *L;
@@ -166,9 +177,8 @@ ts_lua_remap_plugin_init(void *ih, TSHttpTxn rh, TSRemapRequestInfo *rri)
 
   int remap     = (rri == NULL ? 0 : 1);
   instance_conf = (ts_lua_instance_conf *)ih;
-  req_id        = __sync_fetch_and_add(&ts_lua_http_next_id, 1);
 
-  main_ctx = &ts_lua_main_ctx_array[req_id % instance_conf->states];
+  main_ctx = &ts_lua_main_ctx_array[ts_lua_get_thread_slot() % instance_conf->states];
 
   TSMutexLock(main_ctx->mutexp);
 
@@ -246,7 +256,7 @@ globalHookHandler(TSCont contp, TSEvent event ATS_UNUSED, void *edata)
   TSMLoc url_loc;
 
   int ret;
-  uint64_t req_id;
+  int slot;
   TSCont txn_contp;
 
   lua_State *l;
@@ -257,11 +267,11 @@ globalHookHandler(TSCont contp, TSEvent event ATS_UNUSED, void *edata)
 
   ts_lua_instance_conf *conf = (ts_lua_instance_conf *)TSContDataGet(contp);
 
-  req_id = __sync_fetch_and_add(&ts_lua_g_http_next_id, 1);
+  slot = ts_lua_get_thread_slot() % conf->states;
 
-  main_ctx = &ts_lua_g_main_ctx_array[req_id % conf->states];
+  main_ctx = &ts_lua_g_main_ctx_array[slot];
 
-  TSDebug(TS_LUA_DEBUG_TAG, "[%s] req_id: %" PRId64, __FUNCTION__, req_id);
+  TSDebug(TS_LUA_DEBUG_TAG, "[%s] lua state: %d", __FUNCTION__, slot);
   TSMutexLock(main_ctx->mutexp);
 
   http_ctx           = ts_lua_create_http_ctx(main_ctx, conf);
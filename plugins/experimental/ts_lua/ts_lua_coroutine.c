@@ -71,6 +71,46 @@ ts_lua_async_create_item(TSCont cont, async_clean func, void *d, ts_lua_cont_inf
   return ai;
 }
 
+/* Must be called with mctx->mutexp held. */
+lua_State *
+ts_lua_coroutine_acquire(ts_lua_main_ctx *mctx, int *ref)
+{
+  lua_State *l;
+
+  if (mctx->idle_count > 0) {
+    mctx->idle_count--;
+    *ref = mctx->idle_ref[mctx->idle_count];
+    return mctx->idle_lua[mctx->idle_count];
+  }
+
+  l    = lua_newthread(mctx->lua);
+  *ref = luaL_ref(mctx->lua, LUA_REGISTRYINDEX);
+
+  return l;
+}
+
+static void
+ts_lua_coroutine_release(ts_lua_coroutine *crt)
+{
+  ts_lua_main_ctx *mctx = crt->mctx;
+
+  /* only a thread which ran to completion can be resumed from scratch */
+  if (crt->recycle && mctx->idle_count < TS_LUA_MAX_IDLE_COROUTINES && lua_status(crt->lua) == 0) {
+    lua_settop(crt->lua, 0);
+
+    /* drop the per transaction globals until the thread is handed out again */
+    lua_rawgeti(crt->lua, LUA_REGISTRYINDEX, mctx->gref);
+    lua_replace(crt->lua, LUA_GLOBALSINDEX);
+
+    mctx->idle_lua[mctx->idle_count] = crt->lua;
+    mctx->idle_ref[mctx->idle_count] = crt->ref;
+    mctx->idle_count++;
+    return;
+  }
+
+  luaL_unref(crt->lua, LUA_REGISTRYINDEX, crt->ref);
+}
+
 void
 ts_lua_release_cont_info(ts_lua_cont_info *ci)
 {
@@ -89,7 +129,7 @@ ts_lua_release_cont_info(ts_lua_cont_info *ci)
   }
 
   if (crt->lua) {
-    luaL_unref(crt->lua, LUA_REGISTRYINDEX, crt->ref);
+    ts_lua_coroutine_release(crt);
   }
 
   TSMutexUnlock(mctx->mutexp);
@@ -28,11 +28,17 @@
 struct async_item;
 typedef int (*async_clean)(struct async_item *item);
 
+#define TS_LUA_MAX_IDLE_COROUTINES 32
+
 /* main context*/
 typedef struct {
   lua_State *lua; // basic lua vm, injected
   TSMutex mutexp; // mutex for lua vm
   int gref;       // reference for lua vm self, in reg table
+
+  lua_State *idle_lua[TS_LUA_MAX_IDLE_COROUTINES]; // finished lua_threads kept for reuse
+  int idle_ref[TS_LUA_MAX_IDLE_COROUTINES];        // references for idle_lua, in REG Table
+  int idle_count;
 } ts_lua_main_ctx;
 
 /* coroutine */
@@ -40,6 +46,7 @@ typedef struct {
   ts_lua_main_ctx *mctx;
   lua_State *lua; // derived lua_thread
   int ref;        // reference for lua_thread, in REG Table
+  int recycle;    // return lua_thread to mctx on release
 } ts_lua_coroutine;
 
 /* continuation info */
@@ -64,5 +71,6 @@ typedef struct async_item {
 
 ts_lua_async_item *ts_lua_async_create_item(TSCont cont, async_clean func, void *d, ts_lua_cont_info *ci);
 void ts_lua_release_cont_info(ts_lua_cont_info *ci);
+lua_State *ts_lua_coroutine_acquire(ts_lua_main_ctx *mctx, int *ref);
 
 #endif
@@ -98,12 +98,75 @@ ts_lua_new_state()
   return L;
 }
 
+typedef struct {
+  char *buf;
+  size_t len;
+  size_t size;
+} ts_lua_chunk;
+
+static int
+ts_lua_chunk_writer(lua_State *L ATS_UNUSED, const void *p, size_t sz, void *ud)
+{
+  ts_lua_chunk *chunk = (ts_lua_chunk *)ud;
+
+  if (chunk->len + sz > chunk->size) {
+    chunk->size = (chunk->len + sz) * 2;
+    chunk->buf  = TSrealloc(chunk->buf, chunk->size);
+  }
+
+  memcpy(chunk->buf + chunk->len, p, sz);
+  chunk->len += sz;
+
+  return 0;
+}
+
+/* Parse the script in the first state only, every other state loads the
+ * bytecode dumped from it. */
+static int
+ts_lua_load_chunk(ts_lua_instance_conf *conf, lua_State *L, ts_lua_chunk *chunk, char *errbuf, int errbuf_size)
+{
+  if (chunk->len) {
+    if (luaL_loadbuffer(L, chunk->buf, chunk->len, conf->script)) {
+      snprintf(errbuf, errbuf_size - 1, "[%s] luaL_loadbuffer %s failed: %s", __FUNCTION__, conf->script, lua_tostring(L, -1));
+      lua_pop(L, 1);
+      return -1;
+    }
+
+    return 0;
+  }
+
+  if (conf->content) {
+    if (luaL_loadstring(L, conf->content)) {
+      snprintf(errbuf, errbuf_size - 1, "[%s] luaL_loadstring %s failed: %s", __FUNCTION__, conf->script, lua_tostring(L, -1));
+      lua_pop(L, 1);
+      return -1;
+    }
+
+  } else if (strlen(conf->script)) {
+    if (luaL_loadfile(L, conf->script)) {
+      snprintf(errbuf, errbuf_size - 1, "[%s] luaL_loadfile %s failed: %s", __FUNCTION__, conf->script, lua_tostring(L, -1));
+      lua_pop(L, 1);
+      return -1;
+    }
+
+  } else {
+    return 0;
+  }
+
+  if (lua_dump(L, ts_lua_chunk_writer, chunk)) {
+    chunk->len = 0; /* fall back to parsing in every state */
+  }
+
+  return 0;
+}
+
 int
 ts_lua_add_module(ts_lua_instance_conf *conf, ts_lua_main_ctx *arr, int n, int argc, char *argv[], char *errbuf, int errbuf_size)
 {
   int i, ret;
   int t;
   lua_State *L;
+  ts_lua_chunk chunk = {NULL, 0, 0};
 
   for (i = 0; i < n; i++) {
     conf->_first = (i == 0) ? 1 : 0;
@@ -124,28 +187,14 @@ ts_lua_add_module(ts_lua_instance_conf *conf, ts_lua_main_ctx *arr, int n, int a
 
     ts_lua_set_instance_conf(L, conf);
 
-    if (conf->content) {
-      if (luaL_loadstring(L, conf->content)) {
-        snprintf(errbuf, errbuf_size - 1, "[%s] luaL_loadstring %s failed: %s", __FUNCTION__, conf->script, lua_tostring(L, -1));
-        lua_pop(L, 1);
-        TSMutexUnlock(arr[i].mutexp);
-        return -1;
-      }
-
-    } else if (strlen(conf->script)) {
-      if (luaL_loadfile(L, conf->script)) {
-        snprintf(errbuf, errbuf_size - 1, "[%s] luaL_loadfile %s failed: %s", __FUNCTION__, conf->script, lua_tostring(L, -1));
-        lua_pop(L, 1);
-        TSMutexUnlock(arr[i].mutexp);
-        return -1;
-      }
+    if (ts_lua_load_chunk(conf, L, &chunk, errbuf, errbuf_size)) {
+      goto fail;
     }
 
     if (lua_pcall(L, 0, 0, 0)) {
       snprintf(errbuf, errbuf_size - 1, "[%s] lua_pcall %s failed: %s", __FUNCTION__, conf->script, lua_tostring(L, -1));
       lua_pop(L, 1);
-      TSMutexUnlock(arr[i].mutexp);
-      return -1;
+      goto fail;
     }
 
     /* call "__init__", to parse parameters */
@@ -163,16 +212,14 @@ ts_lua_add_module(ts_lua_instance_conf *conf, ts_lua_main_ctx *arr, int n, int a
       if (lua_pcall(L, 1, 1, 0)) {
         snprintf(errbuf, errbuf_size - 1, "[%s] lua_pcall %s failed: %s", __FUNCTION__, conf->script, lua_tostring(L, -1));
         lua_pop(L, 1);
-        TSMutexUnlock(arr[i].mutexp);
-        return -1;
+        goto fail;
       }
 
       ret = lua_tonumber(L, -1);
       lua_pop(L, 1);
 
       if (ret) {
-        TSMutexUnlock(arr[i].mutexp);
-        return -1; /* script parse error */
+        goto fail; /* script parse error */
       }
 
     } else {
@@ -191,7 +238,13 @@ ts_lua_add_module(ts_lua_instance_conf *conf, ts_lua_main_ctx *arr, int n, int a
     TSMutexUnlock(arr[i].mutexp);
   }
 
+  TSfree(chunk.buf);
   return 0;
+
+fail:
+  TSMutexUnlock(arr[i].mutexp);
+  TSfree(chunk.buf);
+  return -1;
 }
 
 int
@@ -416,9 +469,9 @@ ts_lua_create_http_ctx(ts_lua_main_ctx *main_ctx, ts_lua_instance_conf *conf)
   http_ctx = TSmalloc(sizeof(ts_lua_http_ctx));
   memset(http_ctx, 0, sizeof(ts_lua_http_ctx));
 
-  // create coroutine for http_ctx
+  // create coroutine for http_ctx, reusing a finished one when possible
   crt = &http_ctx->cinfo.routine;
-  l   = lua_newthread(L);
+  l   = ts_lua_coroutine_acquire(main_ctx, &crt->ref);
 
   lua_pushlightuserdata(L, conf);
   lua_rawget(L, LUA_REGISTRYINDEX);
@@ -435,9 +488,9 @@ ts_lua_create_http_ctx(ts_lua_main_ctx *main_ctx, ts_lua_instance_conf *conf)
   lua_replace(l, LUA_GLOBALSINDEX);
 
   // init coroutine
-  crt->ref  = luaL_ref(L, LUA_REGISTRYINDEX);
-  crt->lua  = l;
-  crt->mctx = main_ctx;
+  crt->lua     = l;
+  crt->mctx    = main_ctx;
+  crt->recycle = 1;
 
   http_ctx->instance_conf = conf;
 
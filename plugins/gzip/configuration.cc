@@ -96,7 +96,9 @@ enum ParserState {
   kParseDisallow,
   kParseFlush,
   kParseAlgorithms,
-  kParseAllow
+  kParseAllow,
+  kParseSharedVariants,
+  kParseAdaptiveLevel
 };
 
 void
@@ -321,6 +323,10 @@ Configuration::Parse(const char *path)
           state = kParseAlgorithms;
         } else if (token == "allow") {
           state = kParseAllow;
+        } else if (token == "shared-variants") {
+          state = kParseSharedVariants;
+        } else if (token == "adaptive-level") {
+          state = kParseAdaptiveLevel;
         } else {
           warning("failed to interpret \"%s\" at line %zu", token.c_str(), lineno);
         }
@@ -357,6 +363,14 @@ Configuration::Parse(const char *path)
         current_host_configuration->add_allow(token);
         state = kParseStart;
         break;
+      case kParseSharedVariants:
+        current_host_configuration->set_shared_variants(token == "true");
+        state = kParseStart;
+        break;
+      case kParseAdaptiveLevel:
+        current_host_configuration->set_adaptive_level(token == "true");
+        state = kParseStart;
+        break;
       }
     }
   }
@@ -49,6 +49,8 @@ public:
       cache_(true),
       remove_accept_encoding_(false),
       flush_(false),
+      shared_variants_(true),
+      adaptive_level_(false),
       compression_algorithms_(ALGORITHM_GZIP),
       ref_count_(0)
   {
@@ -85,6 +87,26 @@ public:
     flush_ = x;
   }
   bool
+  shared_variants()
+  {
+    return shared_variants_;
+  }
+  void
+  set_shared_variants(bool x)
+  {
+    shared_variants_ = x;
+  }
+  bool
+  adaptive_level()
+  {
+    return adaptive_level_;
+  }
+  void
+  set_adaptive_level(bool x)
+  {
+    adaptive_level_ = x;
+  }
+  bool
   remove_accept_encoding()
   {
     return remove_accept_encoding_;
@@ -140,6 +162,8 @@ private:
   bool cache_;
   bool remove_accept_encoding_;
   bool flush_;
+  bool shared_variants_;
+  bool adaptive_level_;
   int compression_algorithms_;
   volatile int ref_count_;
 
@@ -68,16 +68,18 @@ Configuration *cur_config  = nullptr;
 Configuration *prev_config = nullptr;
 
 static Data *
-data_alloc(int compression_type, int compression_algorithms)
+data_alloc(int compression_type, int compression_algorithms, HostConfiguration *hc)
 {
   Data *data;
   int err;
+  int level;
 
   data                         = (Data *)TSmalloc(sizeof(Data));
   data->downstream_vio         = nullptr;
   data->downstream_buffer      = nullptr;
   data->downstream_reader      = nullptr;
   data->downstream_length      = 0;
+  data->hc                     = hc;
   data->state                  = transform_state_initialized;
   data->compression_type       = compression_type;
   data->compression_algorithms = compression_algorithms;
@@ -91,13 +93,18 @@ data_alloc(int compression_type, int compression_algorithms)
   data->zstrm.zfree            = gzip_free;
   data->zstrm.opaque           = (voidpf) nullptr;
   data->zstrm.data_type        = Z_ASCII;
+  data->variant                = nullptr;
+  data->variant_role           = variant_role_none;
+  data->pending_buffer         = nullptr;
+  data->pending_reader         = nullptr;
 
   int window_bits = WINDOW_BITS_GZIP;
   if (compression_type & COMPRESSION_TYPE_DEFLATE) {
     window_bits = WINDOW_BITS_DEFLATE;
   }
 
-  err = deflateInit2(&data->zstrm, ZLIB_COMPRESSION_LEVEL, Z_DEFLATED, window_bits, ZLIB_MEMLEVEL, Z_DEFAULT_STRATEGY);
+  level = hc->adaptive_level() ? adaptive_compression_level(ZLIB_COMPRESSION_LEVEL) : ZLIB_COMPRESSION_LEVEL;
+  err   = deflateInit2(&data->zstrm, level, Z_DEFLATED, window_bits, ZLIB_MEMLEVEL, Z_DEFAULT_STRATEGY);
 
   if (err != Z_OK) {
     fatal("gzip-transform: ERROR: deflateInit (%d)!", err);
@@ -117,7 +124,8 @@ data_alloc(int compression_type, int compression_algorithms)
     if (!data->bstrm.br) {
       fatal("gzip-transform: ERROR: Brotli Encoder Instance Failed");
     }
-    BrotliEncoderSetParameter(data->bstrm.br, BROTLI_PARAM_QUALITY, BROTLI_COMPRESSION_LEVEL);
+    level = hc->adaptive_level() ? adaptive_compression_level(BROTLI_COMPRESSION_LEVEL) : BROTLI_COMPRESSION_LEVEL;
+    BrotliEncoderSetParameter(data->bstrm.br, BROTLI_PARAM_QUALITY, level);
     BrotliEncoderSetParameter(data->bstrm.br, BROTLI_PARAM_LGWIN, BROTLI_LGW);
     data->bstrm.next_in   = nullptr;
     data->bstrm.avail_in  = 0;
@@ -143,6 +151,18 @@ data_destroy(Data *data)
     TSIOBufferDestroy(data->downstream_buffer);
   }
 
+  if (data->pending_buffer) {
+    TSIOBufferDestroy(data->pending_buffer);
+  }
+
+  if (data->variant) {
+    // a leader that did not get to the end leaves nothing to share
+    if (data->variant_role == variant_role_leader) {
+      VariantStore::instance().abandon(data->variant);
+    }
+    VariantStore::instance().release(data->variant);
+  }
+
 // brotlidestory
 #if HAVE_BROTLI_ENCODE_H
   BrotliEncoderDestroyInstance(data->bstrm.br);
@@ -267,6 +287,207 @@ etag_header(TSMBuffer bufp, TSMLoc hdr_loc)
   return ret;
 }
 
+static const char *
+variant_encoding(Data *data)
+{
+  if (data->compression_type & COMPRESSION_TYPE_BROTLI && (data->compression_algorithms & ALGORITHM_BROTLI)) {
+    return TS_HTTP_VALUE_BROTLI;
+  } else if (data->compression_type & COMPRESSION_TYPE_GZIP && (data->compression_algorithms & ALGORITHM_GZIP)) {
+    return TS_HTTP_VALUE_GZIP;
+  } else if (data->compression_type & COMPRESSION_TYPE_DEFLATE && (data->compression_algorithms & ALGORITHM_DEFLATE)) {
+    return TS_HTTP_VALUE_DEFLATE;
+  }
+  return nullptr;
+}
+
+// Whether any value of the field name in the header satisfies match.
+template <typename Match>
+static bool
+field_value_any(TSMBuffer bufp, TSMLoc hdr_loc, const char *name, int name_len, Match match)
+{
+  TSMLoc field_loc = TSMimeHdrFieldFind(bufp, hdr_loc, name, name_len);
+  bool found       = false;
+
+  while (field_loc != TS_NULL_MLOC && !found) {
+    int count = TSMimeHdrFieldValuesCount(bufp, hdr_loc, field_loc);
+
+    for (int i = 0; i < count && !found; i++) {
+      int len;
+      const char *value = TSMimeHdrFieldValueStringGet(bufp, hdr_loc, field_loc, i, &len);
+
+      found = value && match(value, len);
+    }
+
+    TSMLoc next_loc = TSMimeHdrFieldNextDup(bufp, hdr_loc, field_loc);
+    TSHandleMLocRelease(bufp, hdr_loc, field_loc);
+    field_loc = next_loc;
+  }
+  if (field_loc != TS_NULL_MLOC) {
+    TSHandleMLocRelease(bufp, hdr_loc, field_loc);
+  }
+
+  return found;
+}
+
+static bool
+value_is(const char *value, int len, const char *token, int token_len)
+{
+  return len >= token_len && strncasecmp(value, token, token_len) == 0 && (len == token_len || value[token_len] == '=');
+}
+
+// Responses which are personal, or which other request fields may change, are
+// never shared.
+static bool
+variant_shareable(TSMBuffer bufp, TSMLoc hdr_loc)
+{
+  TSMLoc field_loc = TSMimeHdrFieldFind(bufp, hdr_loc, TS_MIME_FIELD_SET_COOKIE, TS_MIME_LEN_SET_COOKIE);
+
+  if (field_loc != TS_NULL_MLOC) {
+    TSHandleMLocRelease(bufp, hdr_loc, field_loc);
+    return false;
+  }
+
+  if (field_value_any(bufp, hdr_loc, TS_MIME_FIELD_CACHE_CONTROL, TS_MIME_LEN_CACHE_CONTROL, [](const char *value, int len) {
+        return value_is(value, len, TS_HTTP_VALUE_PRIVATE, TS_HTTP_LEN_PRIVATE) ||
+               value_is(value, len, TS_HTTP_VALUE_NO_STORE, TS_HTTP_LEN_NO_STORE);
+      })) {
+    return false;
+  }
+
+  return !field_value_any(bufp, hdr_loc, TS_MIME_FIELD_VARY, TS_MIME_LEN_VARY, [](const char *value, int len) {
+    return !(len == TS_MIME_LEN_ACCEPT_ENCODING && strncasecmp(value, TS_MIME_FIELD_ACCEPT_ENCODING, len) == 0);
+  });
+}
+
+// The compressed body can only be shared between responses which are known to
+// be byte for byte identical, i.e. the same URL with the same strong ETag.
+static bool
+variant_key(Data *data, TSMBuffer bufp, TSMLoc hdr_loc, string &key)
+{
+  const char *encoding  = variant_encoding(data);
+  const char *validator = nullptr;
+  int validator_len     = 0;
+  TSMLoc field_loc;
+  char *url;
+  int url_len;
+
+  if (!encoding || !variant_shareable(bufp, hdr_loc)) {
+    return false;
+  }
+
+  if ((field_loc = TSMimeHdrFieldFind(bufp, hdr_loc, TS_MIME_FIELD_ETAG, TS_MIME_LEN_ETAG)) != TS_NULL_MLOC) {
+    validator = TSMimeHdrFieldValueStringGet(bufp, hdr_loc, field_loc, -1, &validator_len);
+    if (validator_len >= 2 && (validator[0] == 'w' || validator[0] == 'W') && validator[1] == '/') {
+      validator_len = 0;
+    }
+    TSHandleMLocRelease(bufp, hdr_loc, field_loc);
+  }
+
+  if (validator_len == 0 || (url = TSHttpTxnEffectiveUrlStringGet(data->txn, &url_len)) == nullptr) {
+    return false;
+  }
+
+  key.assign(url, url_len);
+  key.append(1, '\n').append(validator, validator_len);
+  key.append(1, '\n').append(encoding);
+  TSfree(url);
+
+  return true;
+}
+
+static void
+variant_join(Data *data, TSMBuffer bufp, TSMLoc hdr_loc)
+{
+  string key;
+  bool leader;
+
+  if (!variant_key(data, bufp, hdr_loc, key)) {
+    return;
+  }
+
+  data->variant = VariantStore::instance().acquire(key, leader);
+
+  if (leader) {
+    data->variant_role = variant_role_leader;
+  } else if (VariantStore::instance().state(data->variant) == VARIANT_COMPLETE) {
+    data->variant_role = variant_role_replay;
+  } else {
+    data->variant_role   = variant_role_waiter;
+    data->pending_buffer = TSIOBufferCreate();
+    data->pending_reader = TSIOBufferReaderAlloc(data->pending_buffer);
+  }
+  debug("shared variant role %d for %s", data->variant_role, key.c_str());
+}
+
+// Append what the leader just produced, dropping out of sharing once the body
+// grows past what the store would keep.
+static void
+variant_record(Data *data, const char *buf, int64_t len)
+{
+  if (data->variant_role != variant_role_leader) {
+    return;
+  }
+
+  if (data->variant->body.size() + len > VariantStore::MAX_BODY_BYTES) {
+    VariantStore::instance().abandon(data->variant);
+    VariantStore::instance().release(data->variant);
+    data->variant      = nullptr;
+    data->variant_role = variant_role_none;
+    return;
+  }
+
+  data->variant->body.append(buf, len);
+}
+
+static void
+variant_replay(Data *data)
+{
+  const string &body = data->variant->body;
+
+  TSIOBufferWrite(data->downstream_buffer, body.data(), body.size());
+  data->downstream_length += body.size();
+  data->state = transform_state_finished;
+  debug("replayed %zu bytes of shared variant", body.size());
+}
+
+static void compress_transform_one(Data *data, TSIOBufferReader upstream_reader, int amount);
+
+// Give up on the leader and compress what was held back so far.
+static void
+variant_stop_waiting(Data *data)
+{
+  VariantStore::instance().release(data->variant);
+  data->variant      = nullptr;
+  data->variant_role = variant_role_none;
+
+  compress_transform_one(data, data->pending_reader, (int)TSIOBufferReaderAvail(data->pending_reader));
+
+  TSIOBufferDestroy(data->pending_buffer);
+  data->pending_buffer = nullptr;
+  data->pending_reader = nullptr;
+}
+
+// A waiter sends the shared body as soon as the leader is done with it, not
+// when its own origin response ends, and stops waiting once the leader fails.
+static void
+variant_poll(Data *data)
+{
+  switch (VariantStore::instance().state(data->variant)) {
+  case VARIANT_COMPLETE:
+    TSIOBufferDestroy(data->pending_buffer);
+    data->pending_buffer = nullptr;
+    data->pending_reader = nullptr;
+    data->variant_role   = variant_role_replay;
+    variant_replay(data);
+    break;
+  case VARIANT_FAILED:
+    variant_stop_waiting(data);
+    break;
+  case VARIANT_PENDING:
+    break;
+  }
+}
+
 // FIXME: some things are potentially compressible. those responses
 static void
 compress_transform_init(TSCont contp, Data *data)
@@ -285,12 +506,21 @@ compress_transform_init(TSCont contp, Data *data)
     return;
   }
 
+  // look for a shared body before the etag gets altered below
+  if (data->hc->shared_variants()) {
+    variant_join(data, bufp, hdr_loc);
+  }
+
   if (content_encoding_header(bufp, hdr_loc, data->compression_type, data->compression_algorithms) == TS_SUCCESS &&
       vary_header(bufp, hdr_loc) == TS_SUCCESS && etag_header(bufp, hdr_loc) == TS_SUCCESS) {
     downstream_conn         = TSTransformOutputVConnGet(contp);
     data->downstream_buffer = TSIOBufferCreate();
     data->downstream_reader = TSIOBufferReaderAlloc(data->downstream_buffer);
     data->downstream_vio    = TSVConnWrite(downstream_conn, contp, data->downstream_reader, INT64_MAX);
+
+    if (data->variant_role == variant_role_replay) {
+      variant_replay(data);
+    }
   }
 
   TSHandleMLocRelease(bufp, TS_NULL_MLOC, hdr_loc);
@@ -326,6 +556,7 @@ gzip_transform_one(Data *data, const char *upstream_buffer, int64_t upstream_len
     if (downstream_length > data->zstrm.avail_out) {
       TSIOBufferProduce(data->downstream_buffer, downstream_length - data->zstrm.avail_out);
       data->downstream_length += (downstream_length - data->zstrm.avail_out);
+      variant_record(data, downstream_buffer, downstream_length - data->zstrm.avail_out);
     }
 
     if (data->zstrm.avail_out > 0) {
@@ -373,6 +604,7 @@ brotli_transform_one(Data *data, const char *upstream_buffer, int64_t upstream_l
     if (downstream_length > (int64_t)data->bstrm.avail_out) {
       TSIOBufferProduce(data->downstream_buffer, downstream_length - data->bstrm.avail_out);
       data->downstream_length += (downstream_length - data->bstrm.avail_out);
+      variant_record(data, downstream_buffer, downstream_length - data->bstrm.avail_out);
     }
 
     if (data->bstrm.avail_out > 0) {
@@ -393,6 +625,26 @@ compress_transform_one(Data *data, TSIOBufferReader upstream_reader, int amount)
   TSIOBufferBlock downstream_blkp;
   const char *upstream_buffer;
   int64_t upstream_length;
+
+  if (data->variant_role == variant_role_waiter) {
+    variant_poll(data);
+  }
+
+  if (data->variant_role == variant_role_replay) {
+    TSIOBufferReaderConsume(upstream_reader, amount);
+    return;
+  }
+
+  // hold back only a little, a slow leader shouldn't hold up the client
+  if (data->variant_role == variant_role_waiter) {
+    TSIOBufferCopy(data->pending_buffer, upstream_reader, amount, 0);
+    TSIOBufferReaderConsume(upstream_reader, amount);
+    if (TSIOBufferReaderAvail(data->pending_reader) > (int64_t)VariantStore::MAX_WAIT_BYTES) {
+      variant_stop_waiting(data);
+    }
+    return;
+  }
+
   while (amount > 0) {
     downstream_blkp = TSIOBufferReaderStart(upstream_reader);
     if (!downstream_blkp) {
@@ -447,6 +699,7 @@ gzip_transform_finish(Data *data)
       if (downstream_length > (int64_t)data->zstrm.avail_out) {
         TSIOBufferProduce(data->downstream_buffer, downstream_length - data->zstrm.avail_out);
         data->downstream_length += (downstream_length - data->zstrm.avail_out);
+        variant_record(data, downstream_buffer, downstream_length - data->zstrm.avail_out);
       }
 
       if (err == Z_OK) { /* some more data to encode */
@@ -493,6 +746,7 @@ brotli_transform_finish(Data *data)
       if (downstream_length > (int64_t)data->bstrm.avail_out) {
         TSIOBufferProduce(data->downstream_buffer, downstream_length - data->bstrm.avail_out);
         data->downstream_length += (downstream_length - data->bstrm.avail_out);
+        variant_record(data, downstream_buffer, downstream_length - data->bstrm.avail_out);
       }
       if (!BrotliEncoderIsFinished(data->bstrm.br)) {
         continue;
@@ -519,6 +773,17 @@ brotli_transform_finish(Data *data)
 static void
 compress_transform_finish(Data *data)
 {
+  if (data->variant_role == variant_role_waiter) {
+    variant_poll(data);
+  }
+  if (data->variant_role == variant_role_waiter) {
+    variant_stop_waiting(data);
+  }
+
+  if (data->variant_role == variant_role_replay) {
+    return;
+  }
+
   if (data->compression_type & COMPRESSION_TYPE_BROTLI && data->compression_algorithms & ALGORITHM_BROTLI) {
     brotli_transform_finish(data);
     debug("brotli-transform: Brotli compression finish.");
@@ -529,6 +794,13 @@ compress_transform_finish(Data *data)
   } else {
     warning("No Compression matched, shouldn't come here.");
   }
+
+  if (data->variant_role == variant_role_leader) {
+    VariantStore::instance().publish(data->variant);
+    VariantStore::instance().release(data->variant);
+    data->variant      = nullptr;
+    data->variant_role = variant_role_none;
+  }
 }
 
 static void
@@ -540,13 +812,15 @@ compress_transform_do(TSCont contp)
   int64_t upstream_avail;
   int64_t downstream_bytes_written;
 
-  data = (Data *)TSContDataGet(contp);
+  data                     = (Data *)TSContDataGet(contp);
+  downstream_bytes_written = data->downstream_length;
+
+  // a replayed variant is written out during init already
   if (data->state == transform_state_initialized) {
     compress_transform_init(contp, data);
   }
 
-  upstream_vio             = TSVConnWriteVIOGet(contp);
-  downstream_bytes_written = data->downstream_length;
+  upstream_vio = TSVConnWriteVIOGet(contp);
 
   if (!TSVIOBufferGet(upstream_vio)) {
     compress_transform_finish(data);
@@ -782,9 +1056,8 @@ compress_transform_add(TSHttpTxn txnp, HostConfiguration *hc, int compress_type,
   }
 
   connp     = TSTransformCreate(compress_transform, txnp);
-  data      = data_alloc(compress_type, algorithms);
+  data      = data_alloc(compress_type, algorithms, hc);
   data->txn = txnp;
-  data->hc  = hc;
 
   TSContDataSet(connp, data);
   TSHttpTxnHookAdd(txnp, TS_HTTP_RESPONSE_TRANSFORM_HOOK, connp);
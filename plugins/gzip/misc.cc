@@ -27,6 +27,8 @@
 #include "misc.h"
 #include <cstring>
 #include <cinttypes>
+#include <ctime>
+#include <unistd.h>
 #include "debug_macros.h"
 
 voidpf
@@ -170,3 +172,25 @@ gzip_log_ratio(int64_t in, int64_t out)
     debug("Compressed size %" PRId64 " (bytes), Original size %" PRId64 ", ratio: %f", out, in, 0.0F);
   }
 }
+
+int
+adaptive_compression_level(int level)
+{
+  static time_t sampled_at = 0;
+  static int headroom      = 100; // percent of the CPUs that are idle
+  time_t now               = time(nullptr);
+
+  // sample the load at most once a second, racing threads just sample twice
+  if (__atomic_load_n(&sampled_at, __ATOMIC_RELAXED) != now) {
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    double load;
+
+    if (ncpu > 0 && getloadavg(&load, 1) == 1) {
+      int h = 100 - static_cast<int>(load * 100 / ncpu);
+      __atomic_store_n(&headroom, h < 0 ? 0 : (h > 100 ? 100 : h), __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&sampled_at, now, __ATOMIC_RELAXED);
+  }
+
+  return 1 + (level - 1) * __atomic_load_n(&headroom, __ATOMIC_RELAXED) / 100;
+}
@@ -34,6 +34,7 @@
 #endif
 
 #include "configuration.h"
+#include "variant_store.h"
 
 using namespace Gzip;
 
@@ -61,6 +62,13 @@ enum transform_state {
   transform_state_finished,
 };
 
+enum variant_role {
+  variant_role_none,   // compress, nothing shared
+  variant_role_leader, // compress and record the output for others
+  variant_role_waiter, // hold the upstream until the leader finishes
+  variant_role_replay, // send the leader's output, ignore the upstream
+};
+
 #if HAVE_BROTLI_ENCODE_H
 typedef struct {
   BrotliEncoderState *br;
@@ -87,6 +95,10 @@ typedef struct {
 #if HAVE_BROTLI_ENCODE_H
   b_stream bstrm;
 #endif
+  SharedVariant *variant;          // shared compressed body, if any
+  enum variant_role variant_role; // how this transform uses it
+  TSIOBuffer pending_buffer;      // upstream held while waiting on the leader
+  TSIOBufferReader pending_reader;
 } Data;
 
 voidpf gzip_alloc(voidpf opaque, uInt items, uInt size);
@@ -98,5 +110,7 @@ const char *init_hidden_header_name();
 int check_ts_version();
 int register_plugin();
 void gzip_log_ratio(int64_t in, int64_t out);
+// Scale a compression level towards 1 as the idle CPU share shrinks.
+int adaptive_compression_level(int level);
 
 #endif
@@ -0,0 +1,170 @@
+/** @file
+
+  Unit tests for the shared store of compressed response bodies
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <ts/TestBox.h>
+#include <cstdarg>
+#include <cstdio>
+#include <mutex>
+
+#include "variant_store.h"
+
+using namespace Gzip;
+
+TSMutex
+TSMutexCreate()
+{
+  return reinterpret_cast<TSMutex>(new std::mutex);
+}
+
+void
+TSMutexLock(TSMutex mutexp)
+{
+  reinterpret_cast<std::mutex *>(mutexp)->lock();
+}
+
+void
+TSMutexUnlock(TSMutex mutexp)
+{
+  reinterpret_cast<std::mutex *>(mutexp)->unlock();
+}
+
+void
+TSDebug(const char *tag, const char *fmt, ...)
+{
+  va_list args;
+
+  fprintf(stderr, "%s", tag);
+  va_start(args, fmt);
+  vfprintf(stderr, fmt, args);
+  va_end(args);
+  fprintf(stderr, "\n");
+}
+
+REGRESSION_TEST(VariantStoreShare)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  TestBox box(t, pstatus);
+  VariantStore &store = VariantStore::instance();
+  bool leader;
+
+  box = REGRESSION_TEST_PASSED;
+
+  SharedVariant *first = store.acquire("share", leader);
+  box.check(leader, "the first transaction leads");
+  box.check(store.state(first) == VARIANT_PENDING, "a new variant is pending");
+
+  SharedVariant *waiter = store.acquire("share", leader);
+  box.check(!leader && waiter == first, "a second transaction waits on the same variant");
+  box.check(store.state(waiter) == VARIANT_PENDING, "the waiter sees it pending");
+
+  first->body = "compressed";
+  store.publish(first);
+  box.check(store.state(waiter) == VARIANT_COMPLETE, "the waiter sees it complete once published");
+
+  SharedVariant *replay = store.acquire("share", leader);
+  box.check(!leader && replay == first, "a later transaction gets the published variant");
+  box.check(store.state(replay) == VARIANT_COMPLETE && replay->body == "compressed", "and can replay its body");
+
+  SharedVariant *other = store.acquire("share-other", leader);
+  box.check(leader && other != first, "other keys have their own variant");
+  store.abandon(other);
+  store.release(other);
+
+  store.release(replay);
+  store.release(waiter);
+  store.release(first);
+}
+
+REGRESSION_TEST(VariantStoreAbandon)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  TestBox box(t, pstatus);
+  VariantStore &store = VariantStore::instance();
+  bool leader;
+
+  box = REGRESSION_TEST_PASSED;
+
+  SharedVariant *first  = store.acquire("abandon", leader);
+  SharedVariant *waiter = store.acquire("abandon", leader);
+
+  first->body = "partial";
+  store.abandon(first);
+  box.check(store.state(waiter) == VARIANT_FAILED, "waiters see an abandoned variant fail");
+
+  store.publish(first);
+  box.check(store.state(waiter) == VARIANT_FAILED, "an abandoned variant can't be published");
+
+  SharedVariant *next = store.acquire("abandon", leader);
+  box.check(leader && next != first, "the next transaction leads a fresh variant");
+  store.abandon(next);
+  store.release(next);
+
+  store.release(first);
+  box.check(store.state(waiter) == VARIANT_FAILED, "a waiter's reference outlives the leader's");
+  store.release(waiter);
+}
+
+REGRESSION_TEST(VariantStoreEvict)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  TestBox box(t, pstatus);
+  VariantStore &store = VariantStore::instance();
+  const int n         = VariantStore::MAX_BYTES / VariantStore::MAX_BODY_BYTES;
+  bool leader;
+
+  box = REGRESSION_TEST_PASSED;
+
+  // fill the store with the largest bodies it shares
+  for (int i = 0; i < n; i++) {
+    SharedVariant *v = store.acquire("evict-" + std::to_string(i), leader);
+    v->body.assign(VariantStore::MAX_BODY_BYTES, 'x');
+    store.publish(v);
+    store.release(v);
+  }
+
+  // a replay makes the oldest the most recently used
+  SharedVariant *v = store.acquire("evict-0", leader);
+  box.check(!leader && store.state(v) == VARIANT_COMPLETE, "a full store keeps every body");
+  store.release(v);
+
+  v = store.acquire("evict-new", leader);
+  v->body.assign(VariantStore::MAX_BODY_BYTES, 'y');
+  store.publish(v);
+  store.release(v);
+
+  v = store.acquire("evict-0", leader);
+  box.check(!leader, "a recently replayed body is kept");
+  store.release(v);
+
+  v = store.acquire("evict-1", leader);
+  box.check(leader, "the least recently used body is evicted");
+  store.abandon(v);
+  store.release(v);
+
+  v = store.acquire("evict-new", leader);
+  box.check(!leader && v->body.size() == VariantStore::MAX_BODY_BYTES, "the new body is kept");
+  store.release(v);
+}
+
+int
+main(int argc, const char **argv)
+{
+  return RegressionTest::main(argc, argv, REGRESSION_TEST_QUICK);
+}
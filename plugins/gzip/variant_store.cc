@@ -0,0 +1,144 @@
+/** @file
+
+  Shared store of compressed response bodies
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "variant_store.h"
+
+using namespace std;
+
+namespace Gzip
+{
+VariantStore &
+VariantStore::instance()
+{
+  static VariantStore store;
+  return store;
+}
+
+VariantStore::VariantStore() : mutex_(TSMutexCreate()), bytes_(0)
+{
+}
+
+SharedVariant *
+VariantStore::acquire(const string &key, bool &leader)
+{
+  SharedVariant *v;
+
+  TSMutexLock(mutex_);
+
+  auto it = variants_.find(key);
+  if (it != variants_.end()) {
+    v = it->second;
+    ++v->ref_count;
+    if (v->state == VARIANT_COMPLETE) {
+      lru_.splice(lru_.begin(), lru_, v->lru);
+    }
+    leader = false;
+  } else {
+    v            = new SharedVariant();
+    v->key       = key;
+    v->state     = VARIANT_PENDING;
+    v->ref_count = 2; // the store and the leader
+    variants_.emplace(key, v);
+    leader = true;
+  }
+
+  TSMutexUnlock(mutex_);
+
+  return v;
+}
+
+VariantState
+VariantStore::state(SharedVariant *v)
+{
+  VariantState s;
+
+  TSMutexLock(mutex_);
+  s = v->state;
+  TSMutexUnlock(mutex_);
+
+  return s;
+}
+
+void
+VariantStore::publish(SharedVariant *v)
+{
+  TSMutexLock(mutex_);
+
+  if (v->state == VARIANT_PENDING) {
+    v->state = VARIANT_COMPLETE;
+    v->lru   = lru_.insert(lru_.begin(), v);
+    bytes_ += v->body.size();
+
+    while (bytes_ > MAX_BYTES && !lru_.empty()) {
+      SharedVariant *victim = lru_.back();
+
+      debug("evicting shared variant of %zu bytes", victim->body.size());
+      unlink(victim);
+      unref(victim);
+    }
+  }
+
+  TSMutexUnlock(mutex_);
+}
+
+void
+VariantStore::abandon(SharedVariant *v)
+{
+  TSMutexLock(mutex_);
+
+  if (v->state == VARIANT_PENDING) {
+    v->state = VARIANT_FAILED;
+    unlink(v);
+    unref(v);
+  }
+
+  TSMutexUnlock(mutex_);
+}
+
+void
+VariantStore::release(SharedVariant *v)
+{
+  TSMutexLock(mutex_);
+  unref(v);
+  TSMutexUnlock(mutex_);
+}
+
+void
+VariantStore::unlink(SharedVariant *v)
+{
+  variants_.erase(v->key);
+  if (v->state == VARIANT_COMPLETE) {
+    lru_.erase(v->lru);
+    bytes_ -= v->body.size();
+  }
+}
+
+void
+VariantStore::unref(SharedVariant *v)
+{
+  if (--v->ref_count == 0) {
+    delete v;
+  }
+}
+
+} // namespace
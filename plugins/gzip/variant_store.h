@@ -0,0 +1,86 @@
+/** @file
+
+  Shared store of compressed response bodies
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#ifndef GZIP_VARIANT_STORE_H_
+#define GZIP_VARIANT_STORE_H_
+
+#include <list>
+#include <string>
+#include <unordered_map>
+#include "debug_macros.h"
+
+namespace Gzip
+{
+enum VariantState {
+  VARIANT_PENDING,  // the leader is still compressing
+  VARIANT_COMPLETE, // body holds the whole compressed response
+  VARIANT_FAILED,   // the leader gave up, waiters must compress themselves
+};
+
+// One compressed response body, keyed by URL, validator and encoding. Only the
+// transaction that created it (the leader) appends to the body, everybody else
+// reads it once the state is VARIANT_COMPLETE, after which it never changes.
+struct SharedVariant {
+  std::string key;
+  std::string body;
+  VariantState state;
+  int ref_count;
+  std::list<SharedVariant *>::iterator lru;
+};
+
+class VariantStore
+{
+public:
+  // Total bytes of completed bodies kept, and the largest single body.
+  static const size_t MAX_BYTES      = 32 * 1024 * 1024;
+  static const size_t MAX_BODY_BYTES = MAX_BYTES / 8;
+  // Origin data a waiter holds back before it compresses on its own.
+  static const size_t MAX_WAIT_BYTES = 64 * 1024;
+
+  static VariantStore &instance();
+
+  // Get a held reference to the variant for key, creating it if needed. When
+  // leader is set on return the caller must either publish or abandon it.
+  SharedVariant *acquire(const std::string &key, bool &leader);
+  VariantState state(SharedVariant *v);
+  void publish(SharedVariant *v);
+  void abandon(SharedVariant *v);
+  void release(SharedVariant *v);
+
+private:
+  VariantStore();
+
+  void unlink(SharedVariant *v);
+  void unref(SharedVariant *v);
+
+  TSMutex mutex_;
+  size_t bytes_;
+  std::unordered_map<std::string, SharedVariant *> variants_;
+  std::list<SharedVariant *> lru_; // completed variants, most recent first
+
+  DISALLOW_COPY_AND_ASSIGN(VariantStore);
+};
+
+} // namespace
+
+#endif
@@ -30,126 +30,126 @@
 #include "expander.h"
 #include "conditions.h"
 
-// Main expander method
-std::string
-VariableExpander::expand(const Resources &res)
+// Append the value of one variable
+static void
+resolve_variable(std::string &resolved_variable, ExpandVariable var, const Resources &res)
 {
-  std::string result;
-
-  result.reserve(512); // TODO: Can be optimized
-  result.assign(_source);
-
-  while (true) {
-    std::string::size_type start = result.find("%<");
-    if (start == std::string::npos) {
-      break;
-    }
-
-    std::string::size_type end = result.find('>', start);
-    if (end == std::string::npos) {
-      break;
-    }
-
-    std::string first_part = result.substr(0, start);
-    std::string last_part  = result.substr(end + 1);
-
-    // Now evaluate the variable
-    std::string variable = result.substr(start, end - start + 1);
-
-    // This will be the value to replace the "variable" section of the string with
-    std::string resolved_variable = "";
-
-    // Initialize some stuff
-    TSMBuffer bufp;
-    TSMLoc hdr_loc;
-    TSMLoc url_loc;
-
-    if (variable == "%<proto>") {
-      // Protocol of the incoming request
-      if (TSHttpTxnPristineUrlGet(res.txnp, &bufp, &url_loc) == TS_SUCCESS) {
-        int len;
-        const char *tmp = TSUrlSchemeGet(bufp, url_loc, &len);
-        if ((tmp != nullptr) && (len > 0)) {
-          resolved_variable.assign(tmp, len);
-        } else {
-          resolved_variable.assign("");
-        }
-        TSHandleMLocRelease(bufp, TS_NULL_MLOC, url_loc);
-      }
-    } else if (variable == "%<port>") {
-      // Original port of the incoming request
-      if (TSHttpTxnClientReqGet(res.txnp, &bufp, &hdr_loc) == TS_SUCCESS) {
-        if (TSHttpHdrUrlGet(bufp, hdr_loc, &url_loc) == TS_SUCCESS) {
-          std::stringstream out;
-          out << TSUrlPortGet(bufp, url_loc);
-          resolved_variable = out.str();
-          TSHandleMLocRelease(bufp, hdr_loc, url_loc);
-        }
-        TSHandleMLocRelease(bufp, TS_NULL_MLOC, hdr_loc);
-      }
-    } else if (variable == "%<chi>") {
-      // IP address of the client's host machine
-      resolved_variable = getIP(TSHttpTxnClientAddrGet(res.txnp));
-    } else if (variable == "%<cqhl>") {
-      // The client request header length; the header length in the client request to Traffic Server.
-      std::stringstream out;
-      out << TSHttpHdrLengthGet(res.client_bufp, res.client_hdr_loc);
-      resolved_variable = out.str();
-    } else if (variable == "%<cqhm>") {
-      // The HTTP method in the client request to Traffic Server: GET, POST, and so on (subset of cqtx).
-      int method_len;
-      const char *methodp = TSHttpHdrMethodGet(res.client_bufp, res.client_hdr_loc, &method_len);
-      if (methodp && method_len) {
-        resolved_variable.assign(methodp, method_len);
+  // Initialize some stuff
+  TSMBuffer bufp;
+  TSMLoc hdr_loc;
+  TSMLoc url_loc;
+
+  switch (var) {
+  case EXPAND_PROTO:
+    // Protocol of the incoming request
+    if (TSHttpTxnPristineUrlGet(res.txnp, &bufp, &url_loc) == TS_SUCCESS) {
+      int len;
+      const char *tmp = TSUrlSchemeGet(bufp, url_loc, &len);
+      if ((tmp != nullptr) && (len > 0)) {
+        resolved_variable.append(tmp, len);
       }
-    } else if (variable == "%<cquup>") {
-      // The client request unmapped URL path. This field records a URL path
-      // before it is remapped (reverse proxy mode).
-      if (TSHttpTxnPristineUrlGet(res.txnp, &bufp, &url_loc) == TS_SUCCESS) {
-        int path_len;
-        const char *path = TSUrlPathGet(bufp, url_loc, &path_len);
-
-        if (path && path_len) {
-          resolved_variable.assign(path, path_len);
-        }
-        TSHandleMLocRelease(bufp, TS_NULL_MLOC, url_loc);
+      TSHandleMLocRelease(bufp, TS_NULL_MLOC, url_loc);
+    }
+    break;
+  case EXPAND_PORT:
+    // Original port of the incoming request
+    if (TSHttpTxnClientReqGet(res.txnp, &bufp, &hdr_loc) == TS_SUCCESS) {
+      if (TSHttpHdrUrlGet(bufp, hdr_loc, &url_loc) == TS_SUCCESS) {
+        std::stringstream out;
+        out << TSUrlPortGet(bufp, url_loc);
+        resolved_variable += out.str();
+        TSHandleMLocRelease(bufp, hdr_loc, url_loc);
       }
-    } else if (variable == "%<cque>") {
-      // The client request effective URL.
-      int url_len = 0;
-      char *url   = TSHttpTxnEffectiveUrlStringGet(res.txnp, &url_len);
-      if (url && url_len) {
-        resolved_variable.assign(url, url_len);
+      TSHandleMLocRelease(bufp, TS_NULL_MLOC, hdr_loc);
+    }
+    break;
+  case EXPAND_CHI:
+    // IP address of the client's host machine
+    resolved_variable += getIP(TSHttpTxnClientAddrGet(res.txnp));
+    break;
+  case EXPAND_CQHL: {
+    // The client request header length; the header length in the client request to Traffic Server.
+    std::stringstream out;
+    out << TSHttpHdrLengthGet(res.client_bufp, res.client_hdr_loc);
+    resolved_variable += out.str();
+  } break;
+  case EXPAND_CQHM: {
+    // The HTTP method in the client request to Traffic Server: GET, POST, and so on (subset of cqtx).
+    int method_len;
+    const char *methodp = TSHttpHdrMethodGet(res.client_bufp, res.client_hdr_loc, &method_len);
+    if (methodp && method_len) {
+      resolved_variable.append(methodp, method_len);
+    }
+  } break;
+  case EXPAND_CQUUP:
+    // The client request unmapped URL path. This field records a URL path
+    // before it is remapped (reverse proxy mode).
+    if (TSHttpTxnPristineUrlGet(res.txnp, &bufp, &url_loc) == TS_SUCCESS) {
+      int path_len;
+      const char *path = TSUrlPathGet(bufp, url_loc, &path_len);
+
+      if (path && path_len) {
+        resolved_variable.append(path, path_len);
       }
-      free(url);
-      url = nullptr;
-    } else if (variable == "%<INBOUND:REMOTE-ADDR>") {
-      ConditionInbound::append_value(resolved_variable, res, NET_QUAL_REMOTE_ADDR);
-    } else if (variable == "%<INBOUND:REMOTE-PORT>") {
-      ConditionInbound::append_value(resolved_variable, res, NET_QUAL_REMOTE_PORT);
-    } else if (variable == "%<INBOUND:LOCAL-ADDR>") {
-      ConditionInbound::append_value(resolved_variable, res, NET_QUAL_LOCAL_ADDR);
-    } else if (variable == "%<INBOUND:LOCAL-PORT>") {
-      ConditionInbound::append_value(resolved_variable, res, NET_QUAL_LOCAL_PORT);
-    } else if (variable == "%<INBOUND:TLS>") {
-      ConditionInbound::append_value(resolved_variable, res, NET_QUAL_TLS);
-    } else if (variable == "%<INBOUND:H2>") {
-      ConditionInbound::append_value(resolved_variable, res, NET_QUAL_H2);
-    } else if (variable == "%<INBOUND:IPV4>") {
-      ConditionInbound::append_value(resolved_variable, res, NET_QUAL_IPV4);
-    } else if (variable == "%<INBOUND:IPV6>") {
-      ConditionInbound::append_value(resolved_variable, res, NET_QUAL_IPV6);
-    } else if (variable == "%<INBOUND:IP-FAMILY>") {
-      ConditionInbound::append_value(resolved_variable, res, NET_QUAL_IP_FAMILY);
-    } else if (variable == "%<INBOUND:STACK>") {
-      ConditionInbound::append_value(resolved_variable, res, NET_QUAL_STACK);
+      TSHandleMLocRelease(bufp, TS_NULL_MLOC, url_loc);
     }
-
-    // TODO(SaveTheRbtz): Can be optimized
-    result.assign(first_part);
-    result.append(resolved_variable);
-    result.append(last_part);
+    break;
+  case EXPAND_CQUE: {
+    // The client request effective URL.
+    int url_len = 0;
+    char *url   = TSHttpTxnEffectiveUrlStringGet(res.txnp, &url_len);
+    if (url && url_len) {
+      resolved_variable.append(url, url_len);
+    }
+    free(url);
+  } break;
+  case EXPAND_INBOUND_REMOTE_ADDR:
+    ConditionInbound::append_value(resolved_variable, res, NET_QUAL_REMOTE_ADDR);
+    break;
+  case EXPAND_INBOUND_REMOTE_PORT:
+    ConditionInbound::append_value(resolved_variable, res, NET_QUAL_REMOTE_PORT);
+    break;
+  case EXPAND_INBOUND_LOCAL_ADDR:
+    ConditionInbound::append_value(resolved_variable, res, NET_QUAL_LOCAL_ADDR);
+    break;
+  case EXPAND_INBOUND_LOCAL_PORT:
+    ConditionInbound::append_value(resolved_variable, res, NET_QUAL_LOCAL_PORT);
+    break;
+  case EXPAND_INBOUND_TLS:
+    ConditionInbound::append_value(resolved_variable, res, NET_QUAL_TLS);
+    break;
+  case EXPAND_INBOUND_H2:
+    ConditionInbound::append_value(resolved_variable, res, NET_QUAL_H2);
+    break;
+  case EXPAND_INBOUND_IPV4:
+    ConditionInbound::append_value(resolved_variable, res, NET_QUAL_IPV4);
+    break;
+  case EXPAND_INBOUND_IPV6:
+    ConditionInbound::append_value(resolved_variable, res, NET_QUAL_IPV6);
+    break;
+  case EXPAND_INBOUND_IP_FAMILY:
+    ConditionInbound::append_value(resolved_variable, res, NET_QUAL_IP_FAMILY);
+    break;
+  case EXPAND_INBOUND_STACK:
+    ConditionInbound::append_value(resolved_variable, res, NET_QUAL_STACK);
+    break;
+  case EXPAND_NONE:
+    break;
   }
+}
+
+// Main expander method, the template was split into literals and variables when it was set.
+void
+VariableExpander::expand(std::string &s, const Resources &res) const
+{
+  _template.expand(s, [&res](std::string &out, ExpandVariable var) { resolve_variable(out, var, res); });
+}
+
+std::string
+VariableExpander::expand(const Resources &res) const
+{
+  std::string result;
 
+  expand(result, res);
   return result;
 }
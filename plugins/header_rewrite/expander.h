@@ -26,15 +26,25 @@
 
 #include "ts/ts.h"
 #include "resources.h"
+#include "parser.h"
 
 class VariableExpander
 {
 public:
-  VariableExpander(const std::string &source) : _source(source) {}
-  std::string expand(const Resources &res);
+  VariableExpander() {}
+  explicit VariableExpander(const std::string &source) : _template(source) {}
+
+  void
+  set_source(const std::string &source)
+  {
+    _template.compile(source);
+  }
+
+  void expand(std::string &s, const Resources &res) const;
+  std::string expand(const Resources &res) const;
 
 private:
-  std::string _source;
+  ExpandTemplate _template;
 };
 
 #endif // __EXPANDER_H
@@ -20,8 +20,10 @@
  * These are misc unit tests for header rewrite
  */
 
+#include <chrono>
 #include <cstdio>
 #include <cstdarg>
+#include <cstring>
 #include <iostream>
 #include <ostream>
 
@@ -424,10 +426,152 @@ test_processing()
 
   return errors;
 }
+// Stand in values for the %<...> variables, there are no transactions here.
+static void
+fake_resolve(std::string &s, ExpandVariable var)
+{
+  switch (var) {
+  case EXPAND_PROTO:
+    s += "https";
+    break;
+  case EXPAND_PORT:
+    s += "8443";
+    break;
+  case EXPAND_CHI:
+    s += "192.168.1.10";
+    break;
+  case EXPAND_CQHM:
+    s += "GET";
+    break;
+  case EXPAND_CQUUP:
+    s += "/path/to/object.jpg";
+    break;
+  default:
+    s += "x";
+    break;
+  }
+}
+
+// The expansion as it was done before values were compiled: rescan the whole
+// string for every variable. Kept as the reference for the tests and the benchmark.
+static std::string
+reference_expand(const std::string &source)
+{
+  static const struct {
+    const char *name;
+    ExpandVariable var;
+  } vars[] = {{"%<proto>", EXPAND_PROTO}, {"%<port>", EXPAND_PORT}, {"%<chi>", EXPAND_CHI}, {"%<cqhl>", EXPAND_CQHL},
+              {"%<cqhm>", EXPAND_CQHM},   {"%<cquup>", EXPAND_CQUUP}, {"%<cque>", EXPAND_CQUE}};
+  std::string result(source);
+
+  while (true) {
+    std::string::size_type start = result.find("%<");
+    if (start == std::string::npos) {
+      break;
+    }
+    std::string::size_type end = result.find('>', start);
+    if (end == std::string::npos) {
+      break;
+    }
+
+    std::string variable = result.substr(start, end - start + 1);
+    std::string resolved;
+
+    for (const auto &v : vars) {
+      if (variable == v.name) {
+        fake_resolve(resolved, v.var);
+      }
+    }
+    result = result.substr(0, start) + resolved + result.substr(end + 1);
+  }
+
+  return result;
+}
+
+static const char *expand_sources[] = {
+  "%<proto>://example.com:%<port>%<cquup>",
+  "plain value without variables",
+  "client=%<chi>; method=%<cqhm>",
+  "%<unknown>gone",
+  "trailing %<proto",
+  "%<chi>",
+  "",
+};
+
 int
-main()
+test_expansion()
 {
-  if (test_parsing() || test_processing()) {
+  int errors = 0;
+
+  for (const char *source : expand_sources) {
+    ExpandTemplate t(source);
+    std::string s;
+
+    t.expand(s, fake_resolve);
+    if (s != reference_expand(source)) {
+      std::cerr << "CHECK FAILED expanding \"" << source << "\": " << s << " != " << reference_expand(source) << std::endl;
+      ++errors;
+    }
+  }
+
+  {
+    ExpandTemplate t("a%<chi>b%<nope>c");
+
+    if (t.size() != 3 || !t.has_variables()) { // "a", %<chi>, "bc"
+      std::cerr << "CHECK FAILED template split into " << t.size() << " segments" << std::endl;
+      ++errors;
+    }
+  }
+
+  return errors;
+}
+
+// Run with -b to compare expanding compiled values against rescanning the string.
+static void
+bench_expansion(int iterations)
+{
+  typedef std::chrono::steady_clock clock;
+  size_t total = 0;
+
+  auto start = clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    for (const char *source : expand_sources) {
+      total += reference_expand(source).size();
+    }
+  }
+  auto mid = clock::now();
+
+  std::vector<ExpandTemplate> compiled;
+  for (const char *source : expand_sources) {
+    compiled.emplace_back(source);
+  }
+  for (int i = 0; i < iterations; ++i) {
+    for (const ExpandTemplate &t : compiled) {
+      std::string s;
+
+      t.expand(s, fake_resolve);
+      total -= s.size();
+    }
+  }
+  auto end = clock::now();
+
+  double n = static_cast<double>(iterations) * (sizeof(expand_sources) / sizeof(*expand_sources));
+  std::cout << "rescan:   " << std::chrono::duration<double, std::nano>(mid - start).count() / n << " ns/value" << std::endl;
+  std::cout << "compiled: " << std::chrono::duration<double, std::nano>(end - mid).count() / n << " ns/value" << std::endl;
+  if (total != 0) {
+    std::cout << "expansions differ" << std::endl;
+  }
+}
+
+int
+main(int argc, const char *argv[])
+{
+  if (argc > 1 && strcmp(argv[1], "-b") == 0) {
+    bench_expansion(argc > 2 ? atoi(argv[2]) : 1000000);
+    return 0;
+  }
+
+  if (test_parsing() || test_processing() || test_expansion()) {
     return 1;
   }
 
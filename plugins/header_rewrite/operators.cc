@@ -278,7 +278,7 @@ OperatorSetRedirect::initialize(Parser &p)
   Operator::initialize(p);
 
   _status.set_value(p.get_arg());
-  _location.set_value(p.get_value());
+  _location.set_value(p.get_value(), true);
 
   if ((_status.get_int_value() != (int)TS_HTTP_STATUS_MOVED_PERMANENTLY) &&
       (_status.get_int_value() != (int)TS_HTTP_STATUS_MOVED_TEMPORARILY)) {
@@ -299,11 +299,6 @@ OperatorSetRedirect::exec(const Resources &res) const
 
     _location.append_value(value, res);
 
-    if (_location.need_expansion()) {
-      VariableExpander ve(value);
-      value = ve.expand(res);
-    }
-
     bool remap = false;
     if (nullptr != res._rri) {
       remap = true;
@@ -488,7 +483,7 @@ OperatorAddHeader::initialize(Parser &p)
 {
   OperatorHeaders::initialize(p);
 
-  _value.set_value(p.get_value());
+  _value.set_value(p.get_value(), true);
 }
 
 void
@@ -498,12 +493,6 @@ OperatorAddHeader::exec(const Resources &res) const
 
   _value.append_value(value, res);
 
-  if (_value.need_expansion()) {
-    VariableExpander ve(value);
-
-    value = ve.expand(res);
-  }
-
   // Never set an empty header (I don't think that ever makes sense?)
   if (value.empty()) {
     TSDebug(PLUGIN_NAME, "Would set header %s to an empty value, skipping", _header.c_str());
@@ -530,7 +519,7 @@ OperatorSetHeader::initialize(Parser &p)
 {
   OperatorHeaders::initialize(p);
 
-  _value.set_value(p.get_value());
+  _value.set_value(p.get_value(), true);
 }
 
 void
@@ -540,12 +529,6 @@ OperatorSetHeader::exec(const Resources &res) const
 
   _value.append_value(value, res);
 
-  if (_value.need_expansion()) {
-    VariableExpander ve(value);
-
-    value = ve.expand(res);
-  }
-
   // Never set an empty header (I don't think that ever makes sense?)
   if (value.empty()) {
     TSDebug(PLUGIN_NAME, "Would set header %s to an empty value, skipping", _header.c_str());
@@ -658,7 +641,7 @@ void
 OperatorAddCookie::initialize(Parser &p)
 {
   OperatorCookies::initialize(p);
-  _value.set_value(p.get_value());
+  _value.set_value(p.get_value(), true);
 }
 
 void
@@ -668,12 +651,6 @@ OperatorAddCookie::exec(const Resources &res) const
 
   _value.append_value(value, res);
 
-  if (_value.need_expansion()) {
-    VariableExpander ve(value);
-
-    value = ve.expand(res);
-  }
-
   if (res.bufp && res.hdr_loc) {
     TSDebug(PLUGIN_NAME, "OperatorAddCookie::exec() invoked on cookie %s", _cookie.c_str());
     TSMLoc field_loc;
@@ -709,7 +686,7 @@ void
 OperatorSetCookie::initialize(Parser &p)
 {
   OperatorCookies::initialize(p);
-  _value.set_value(p.get_value());
+  _value.set_value(p.get_value(), true);
 }
 
 void
@@ -719,12 +696,6 @@ OperatorSetCookie::exec(const Resources &res) const
 
   _value.append_value(value, res);
 
-  if (_value.need_expansion()) {
-    VariableExpander ve(value);
-
-    value = ve.expand(res);
-  }
-
   if (res.bufp && res.hdr_loc) {
     TSDebug(PLUGIN_NAME, "OperatorSetCookie::exec() invoked on cookie %s", _cookie.c_str());
     TSMLoc field_loc;
@@ -234,3 +234,66 @@ Parser::cond_is_hook(TSHttpHookID &hook) const
 
   return false;
 }
+
+// Names of the %<...> variables, the name includes the delimiters.
+static const struct {
+  const char *name;
+  ExpandVariable var;
+} expand_variables[] = {
+  {"%<proto>", EXPAND_PROTO},
+  {"%<port>", EXPAND_PORT},
+  {"%<chi>", EXPAND_CHI},
+  {"%<cqhl>", EXPAND_CQHL},
+  {"%<cqhm>", EXPAND_CQHM},
+  {"%<cquup>", EXPAND_CQUUP},
+  {"%<cque>", EXPAND_CQUE},
+  {"%<INBOUND:REMOTE-ADDR>", EXPAND_INBOUND_REMOTE_ADDR},
+  {"%<INBOUND:REMOTE-PORT>", EXPAND_INBOUND_REMOTE_PORT},
+  {"%<INBOUND:LOCAL-ADDR>", EXPAND_INBOUND_LOCAL_ADDR},
+  {"%<INBOUND:LOCAL-PORT>", EXPAND_INBOUND_LOCAL_PORT},
+  {"%<INBOUND:TLS>", EXPAND_INBOUND_TLS},
+  {"%<INBOUND:H2>", EXPAND_INBOUND_H2},
+  {"%<INBOUND:IPV4>", EXPAND_INBOUND_IPV4},
+  {"%<INBOUND:IPV6>", EXPAND_INBOUND_IPV6},
+  {"%<INBOUND:IP-FAMILY>", EXPAND_INBOUND_IP_FAMILY},
+  {"%<INBOUND:STACK>", EXPAND_INBOUND_STACK},
+};
+
+void
+ExpandTemplate::compile(const std::string &source)
+{
+  std::string literal;
+  std::string::size_type pos = 0;
+
+  _segments.clear();
+  _has_variables = false;
+
+  while (pos < source.size()) {
+    std::string::size_type start = source.find("%<", pos);
+    std::string::size_type end   = (start == std::string::npos) ? std::string::npos : source.find('>', start);
+
+    if (end == std::string::npos) {
+      literal.append(source, pos, std::string::npos);
+      break;
+    }
+
+    literal.append(source, pos, start - pos);
+    pos = end + 1;
+
+    for (const auto &v : expand_variables) {
+      if (source.compare(start, pos - start, v.name) == 0) {
+        if (!literal.empty()) {
+          _segments.push_back({EXPAND_NONE, literal});
+          literal.clear();
+        }
+        _segments.push_back({v.var, std::string()});
+        _has_variables = true;
+        break;
+      }
+    }
+  }
+
+  if (!literal.empty()) {
+    _segments.push_back({EXPAND_NONE, literal});
+  }
+}
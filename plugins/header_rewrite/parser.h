@@ -89,4 +89,79 @@ protected:
   std::vector<std::string> _tokens;
 };
 
+///////////////////////////////////////////////////////////////////////////////
+// The %<...> variables a value can expand.
+//
+enum ExpandVariable {
+  EXPAND_NONE, // Literal text
+  EXPAND_PROTO,
+  EXPAND_PORT,
+  EXPAND_CHI,
+  EXPAND_CQHL,
+  EXPAND_CQHM,
+  EXPAND_CQUUP,
+  EXPAND_CQUE,
+  EXPAND_INBOUND_REMOTE_ADDR,
+  EXPAND_INBOUND_REMOTE_PORT,
+  EXPAND_INBOUND_LOCAL_ADDR,
+  EXPAND_INBOUND_LOCAL_PORT,
+  EXPAND_INBOUND_TLS,
+  EXPAND_INBOUND_H2,
+  EXPAND_INBOUND_IPV4,
+  EXPAND_INBOUND_IPV6,
+  EXPAND_INBOUND_IP_FAMILY,
+  EXPAND_INBOUND_STACK,
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// A value with %<...> variables, split once at load time into runs of literal
+// text and variable references. Expanding it is then a single pass that only
+// does work for the variables, instead of rescanning the string for each one.
+// Unknown variables expand to nothing and are dropped here, an unterminated
+// "%<" is kept as literal text.
+//
+class ExpandTemplate
+{
+public:
+  ExpandTemplate() {}
+  explicit ExpandTemplate(const std::string &source) { compile(source); }
+
+  void compile(const std::string &source);
+
+  // Append the expansion to s, resolve(s, var) appends the value of a variable.
+  template <typename Resolver>
+  void
+  expand(std::string &s, Resolver resolve) const
+  {
+    for (const Segment &seg : _segments) {
+      if (EXPAND_NONE == seg.var) {
+        s += seg.text;
+      } else {
+        resolve(s, seg.var);
+      }
+    }
+  }
+
+  size_t
+  size() const
+  {
+    return _segments.size();
+  }
+
+  bool
+  has_variables() const
+  {
+    return _has_variables;
+  }
+
+private:
+  struct Segment {
+    ExpandVariable var;
+    std::string text;
+  };
+
+  std::vector<Segment> _segments;
+  bool _has_variables = false;
+};
+
 #endif // __PARSER_H
@@ -31,6 +31,7 @@
 #include "condition.h"
 #include "factory.h"
 #include "parser.h"
+#include "expander.h"
 
 ///////////////////////////////////////////////////////////////////////////////
 // Base class for all Values (this is also the interface).
@@ -46,8 +47,10 @@ public:
     TSDebug(PLUGIN_NAME_DBG, "Calling CTOR for Value");
   }
 
+  // Only the operators that take %<...> variables pass expand, for everyone
+  // else the value is used as written.
   void
-  set_value(const std::string &val)
+  set_value(const std::string &val, bool expand = false)
   {
     _value = val;
     if (_value.substr(0, 2) == "%{") {
@@ -59,8 +62,10 @@ public:
       }
     } else if (_value.find("%<") != std::string::npos) { // It has a Variable to expand
       _need_expander = true;                             // And this is clearly not an integer or float ...
-      // TODO: This is still not optimal, we should pre-parse the _value string here,
-      // and perhaps populate a per-Value VariableExpander that holds state.
+      if (expand) {
+        _expander.set_source(_value);
+        _expand = true;
+      }
     } else {
       _int_value   = strtol(_value.c_str(), NULL, 10);
       _float_value = strtod(_value.c_str(), NULL);
@@ -72,6 +77,8 @@ public:
   {
     if (_cond_val) {
       _cond_val->append_value(s, res);
+    } else if (_expand) {
+      _expander.expand(s, res);
     } else {
       s += _value;
     }
@@ -117,10 +124,12 @@ private:
   DISALLOW_COPY_AND_ASSIGN(Value);
 
   bool _need_expander;
+  bool _expand = false;
   std::string _value;
   int _int_value;
   double _float_value;
   Condition *_cond_val;
+  VariableExpander _expander;
 };
 
 #endif // __VALUE_H
@@ -43,6 +43,7 @@
 #include "ts/ink_atomic.h"
 #include "ts/ink_time.h"
 #include "ts/ink_inet.h"
+#include "ts/Regex.h"
 
 #ifdef HAVE_PCRE_PCRE_H
 #include <pcre/pcre.h>
@@ -659,6 +660,7 @@ struct RemapInstance {
 
   RemapRegex *first;
   RemapRegex *last;
+  RegexPrefilter filter; // indexed by rule order - 1
   bool profile;
   bool method;
   bool query_string;
@@ -860,6 +862,7 @@ TSRemapNewInstance(int argc, char *argv[], void **ih, char * /* errbuf ATS_UNUSE
     } else {
       TSDebug(PLUGIN_NAME, "Added regex=%s with subs=%s and options `%s'", regex.c_str(), subst.c_str(), options.c_str());
       cur->set_order(++count);
+      ri->filter.add(cur->regex());
       auto tmp = cur.get();
       if (ri->first == nullptr) {
         ri->first = cur.release();
@@ -870,6 +873,8 @@ TSRemapNewInstance(int argc, char *argv[], void **ih, char * /* errbuf ATS_UNUSE
     }
   }
 
+  ri->filter.compile();
+
   // Make sure we got something...
   if (ri->first == nullptr) {
     TSError("[%s] no regular expressions from the maps", PLUGIN_NAME);
@@ -1004,10 +1009,13 @@ TSRemapDoRemap(void *ih, TSHttpTxn txnp, TSRemapRequestInfo *rri)
   match_buf[match_len] = '\0'; // NULL terminate the match string
   TSDebug(PLUGIN_NAME, "Target match string is `%s'", match_buf);
 
+  // Find the rules that can possibly match in one pass, only those get executed.
+  RegexPrefilter::Candidates candidates(ri->filter, match_buf, match_len);
+
   // Apply the regular expressions, in order. First one wins.
   while (re) {
     // Since we check substitutions on parse time, we don't need to reset ovector
-    if (re->match(match_buf, match_len, ovector) != -1) {
+    if (candidates.test(re->order() - 1) && re->match(match_buf, match_len, ovector) != -1) {
       int new_len = re->get_lengths(ovector, lengths, rri, &req_url);
 
       // Set timeouts
@@ -33,6 +33,8 @@
 #include <string.h>
 #include <inttypes.h>
 #include <getopt.h>
+#include <time.h>
+#include <sys/time.h>
 
 #include "ts/ink_defs.h"
 
@@ -45,6 +47,12 @@ static int url_path_len;
 static bool integer_counters = false;
 static bool wrap_counters    = false;
 
+typedef enum {
+  STATS_FORMAT_JSON,
+  STATS_FORMAT_PROMETHEUS,
+  STATS_FORMAT_PROTOBUF,
+} stats_format;
+
 typedef struct stats_state_t {
   TSVConn net_vc;
   TSVIO read_vio;
@@ -55,9 +63,59 @@ typedef struct stats_state_t {
   TSIOBufferReader resp_reader;
 
   int output_bytes;
-  int body_written;
+
+  /* Request options, from the query string */
+  stats_format format;
+  char *prefix;
+  int prefix_len;
+  uint64_t since;
+
+  struct stats_snapshot_t *snapshot;
 } stats_state;
 
+/* One entry per record, in TSRecordDump() order. The names are formatted once, when the record is
+   first seen, and the value is kept so that a scrape can ask for only what changed. */
+typedef struct stat_entry_t {
+  char *name;
+  int name_len;
+  char *prom_name; /* name sanitized for the Prometheus formats */
+  int prom_name_len;
+  TSRecordDataType data_type;
+  TSRecordData value;  /* strings are owned copies */
+  uint64_t generation; /* table generation in which the value last changed */
+} stat_entry;
+
+/* A copy of the table taken after a refresh. Scrapes of the same generation share it and format
+   their response from it without holding stats_table.mutex. */
+typedef struct stats_snapshot_t {
+  int refcount; /* under stats_table.mutex */
+  uint64_t generation;
+  int count;
+  stat_entry *entries; /* names and string values point into strings */
+  char *strings;
+} stats_snapshot;
+
+typedef struct stat_table_t {
+  stat_entry *entries;
+  int count;
+  int capacity;
+  int cursor; /* position of the refresh in progress */
+  int *prom_index; /* open addressing index of the entries by Prometheus name */
+  int prom_index_size;
+  uint64_t generation;
+  time_t refreshed;
+  stats_snapshot *snapshot; /* of the current generation */
+  TSMutex mutex;
+} stat_table;
+
+static stat_table stats_table;
+
+/* The records are only synced every few seconds, so scrapes within this interval share one
+   refresh of the table. */
+#define STATS_TABLE_REFRESH_INTERVAL 1
+
+static void stats_snapshot_release(stats_snapshot *snap);
+
 static void
 stats_cleanup(TSCont contp, stats_state *my_state)
 {
@@ -71,6 +129,8 @@ stats_cleanup(TSCont contp, stats_state *my_state)
     my_state->resp_buffer = NULL;
   }
   TSVConnClose(my_state->net_vc);
+  stats_snapshot_release(my_state->snapshot);
+  TSfree(my_state->prefix);
   TSfree(my_state);
   TSContDestroy(contp);
 }
@@ -94,22 +154,44 @@ stats_add_data_to_resp_buffer(const char *s, stats_state *my_state)
   return s_len;
 }
 
-static const char RESP_HEADER[] = "HTTP/1.0 200 Ok\r\nContent-Type: text/javascript\r\nCache-Control: no-cache\r\n\r\n";
+static const char RESP_HEADER_FMT[] =
+  "HTTP/1.0 200 Ok\r\nContent-Type: %s\r\nCache-Control: no-cache\r\nX-Stats-Generation: %" PRIu64 "\r\n\r\n";
+
+static const char *const CONTENT_TYPE[] = {
+  "text/javascript",
+  "text/plain; version=0.0.4",
+  "application/vnd.google.protobuf; proto=io.prometheus.client.MetricFamily; encoding=delimited",
+};
 
 static int
 stats_add_resp_header(stats_state *my_state)
 {
-  return stats_add_data_to_resp_buffer(RESP_HEADER, my_state);
+  char b[256];
+
+  snprintf(b, sizeof(b), RESP_HEADER_FMT, CONTENT_TYPE[my_state->format], my_state->snapshot->generation);
+  return stats_add_data_to_resp_buffer(b, my_state);
 }
 
+static stats_snapshot *stats_snapshot_acquire(void);
+static void stats_out(stats_state *my_state);
+
 static void
 stats_process_read(TSCont contp, TSEvent event, stats_state *my_state)
 {
   TSDebug(PLUGIN_NAME, "stats_process_read(%d)", event);
   if (event == TS_EVENT_VCONN_READ_READY) {
+    /* The whole response is built up front from one snapshot, so the generation in the header
+       matches the body. */
+    my_state->snapshot = stats_snapshot_acquire();
+    if (my_state->since > my_state->snapshot->generation) {
+      /* Not one of ours, e.g. from another server. Everything is newer than the client knows. */
+      my_state->since = 0;
+    }
     my_state->output_bytes = stats_add_resp_header(my_state);
+    stats_out(my_state);
+
     TSVConnShutdown(my_state->net_vc, 1, 0);
-    my_state->write_vio = TSVConnWrite(my_state->net_vc, contp, my_state->resp_reader, INT64_MAX);
+    my_state->write_vio = TSVConnWrite(my_state->net_vc, contp, my_state->resp_reader, my_state->output_bytes);
   } else if (event == TS_EVENT_ERROR) {
     TSError("[%s] stats_process_read: Received TS_EVENT_ERROR", PLUGIN_NAME);
   } else if (event == TS_EVENT_VCONN_EOS) {
@@ -124,24 +206,10 @@ stats_process_read(TSCont contp, TSEvent event, stats_state *my_state)
 }
 
 #define APPEND(a) my_state->output_bytes += stats_add_data_to_resp_buffer(a, my_state)
-#define APPEND_STAT(a, fmt, v)                                                   \
-  do {                                                                           \
-    char b[256];                                                                 \
-    if (snprintf(b, sizeof(b), "\"%s\": \"" fmt "\",\n", a, v) < (int)sizeof(b)) \
-      APPEND(b);                                                                 \
-  } while (0)
-#define APPEND_STAT_NUMERIC(a, fmt, v)                                               \
-  do {                                                                               \
-    char b[256];                                                                     \
-    if (integer_counters) {                                                          \
-      if (snprintf(b, sizeof(b), "\"%s\": " fmt ",\n", a, v) < (int)sizeof(b)) {     \
-        APPEND(b);                                                                   \
-      }                                                                              \
-    } else {                                                                         \
-      if (snprintf(b, sizeof(b), "\"%s\": \"" fmt "\",\n", a, v) < (int)sizeof(b)) { \
-        APPEND(b);                                                                   \
-      }                                                                              \
-    }                                                                                \
+#define APPEND_LEN(a, len)                          \
+  do {                                              \
+    TSIOBufferWrite(my_state->resp_buffer, a, len); \
+    my_state->output_bytes += len;                  \
   } while (0)
 
 // This wraps uint64_t values to the int64_t range to fit into a Java long. Java 8 has an unsigned long which
@@ -156,37 +224,387 @@ wrap_unsigned_counter(uint64_t value)
   }
 }
 
+/* Name table maintenance. All of this runs with stats_table.mutex held. */
+
 static void
-json_out_stat(TSRecordType rec_type ATS_UNUSED, void *edata, int registered ATS_UNUSED, const char *name,
-              TSRecordDataType data_type, TSRecordData *datum)
+stat_entry_free_value(stat_entry *e)
 {
-  stats_state *my_state = edata;
+  if (e->data_type == TS_RECORDDATATYPE_STRING) {
+    TSfree(e->value.rec_string);
+    e->value.rec_string = NULL;
+  }
+}
+
+static void
+stat_entry_set_value(stat_entry *e, TSRecordDataType data_type, TSRecordData *datum)
+{
+  stat_entry_free_value(e);
+  e->data_type = data_type;
+  if (data_type == TS_RECORDDATATYPE_STRING) {
+    e->value.rec_string = datum->rec_string ? TSstrdup(datum->rec_string) : NULL;
+  } else {
+    e->value = *datum;
+  }
+}
+
+static bool
+stat_entry_changed(const stat_entry *e, TSRecordDataType data_type, TSRecordData *datum)
+{
+  if (e->data_type != data_type) {
+    return true;
+  }
 
   switch (data_type) {
   case TS_RECORDDATATYPE_COUNTER:
-    APPEND_STAT_NUMERIC(name, "%" PRIu64, wrap_unsigned_counter(datum->rec_counter));
-    break;
+    return e->value.rec_counter != datum->rec_counter;
+  case TS_RECORDDATATYPE_INT:
+    return e->value.rec_int != datum->rec_int;
+  case TS_RECORDDATATYPE_FLOAT:
+    return e->value.rec_float != datum->rec_float;
+  case TS_RECORDDATATYPE_STRING:
+    if (e->value.rec_string == NULL || datum->rec_string == NULL) {
+      return e->value.rec_string != datum->rec_string;
+    }
+    return strcmp(e->value.rec_string, datum->rec_string) != 0;
+  default:
+    return false;
+  }
+}
+
+static void
+stat_entry_init(stat_entry *e, const char *name)
+{
+  int i;
+
+  memset(e, 0, sizeof(*e));
+  e->name     = TSstrdup(name);
+  e->name_len = strlen(name);
+
+  /* Prometheus metric names are [a-zA-Z_:][a-zA-Z0-9_:]* */
+  e->prom_name     = TSstrdup(name);
+  e->prom_name_len = e->name_len;
+  for (i = 0; i < e->prom_name_len; ++i) {
+    char c = e->prom_name[i];
+    if (!(isalnum((unsigned char)c) || c == '_' || c == ':') || (i == 0 && isdigit((unsigned char)c))) {
+      e->prom_name[i] = '_';
+    }
+  }
+}
+
+static void
+stat_entry_destroy(stat_entry *e)
+{
+  stat_entry_free_value(e);
+  TSfree(e->name);
+  TSfree(e->prom_name);
+}
+
+/* Sanitizing can map different stat names to one Prometheus name, e.g. a.b_c and a_b.c. The
+   index finds those, and all but the first such stat get a numeric suffix. */
+
+static uint32_t
+prom_name_hash(const char *name, int len)
+{
+  uint32_t h = 2166136261u; /* FNV-1a */
+  int i;
+
+  for (i = 0; i < len; ++i) {
+    h = (h ^ (unsigned char)name[i]) * 16777619u;
+  }
+  return h;
+}
+
+static int
+stats_table_prom_find(const char *name, int len)
+{
+  stat_table *t = &stats_table;
+  uint32_t i    = prom_name_hash(name, len);
+
+  for (;; ++i) {
+    int n = t->prom_index[i & (t->prom_index_size - 1)];
+    if (n < 0) {
+      return -1;
+    }
+    if (t->entries[n].prom_name_len == len && !memcmp(t->entries[n].prom_name, name, len)) {
+      return n;
+    }
+  }
+}
+
+static void
+stats_table_prom_insert(int n)
+{
+  stat_table *t = &stats_table;
+  uint32_t i    = prom_name_hash(t->entries[n].prom_name, t->entries[n].prom_name_len);
+
+  while (t->prom_index[i & (t->prom_index_size - 1)] >= 0) {
+    ++i;
+  }
+  t->prom_index[i & (t->prom_index_size - 1)] = n;
+}
+
+/* Rebuild the index, sized for the table's capacity. */
+static void
+stats_table_prom_rebuild(void)
+{
+  stat_table *t = &stats_table;
+  int i;
+
+  if (t->prom_index_size < 2 * t->capacity) {
+    t->prom_index_size = 2 * t->capacity;
+    t->prom_index      = TSrealloc(t->prom_index, t->prom_index_size * sizeof(int));
+  }
+  for (i = 0; i < t->prom_index_size; ++i) {
+    t->prom_index[i] = -1;
+  }
+  for (i = 0; i < t->count; ++i) {
+    stats_table_prom_insert(i);
+  }
+}
+
+static void
+stats_table_prom_add(int n)
+{
+  stat_table *t = &stats_table;
+  stat_entry *e = &t->entries[n];
+  int taken, suffix;
+
+  if ((taken = stats_table_prom_find(e->prom_name, e->prom_name_len)) >= 0) {
+    char *base = e->prom_name;
+    char *name = TSmalloc(e->prom_name_len + 16);
+    int len;
+
+    for (suffix = 2;; ++suffix) {
+      len = sprintf(name, "%s_%d", base, suffix);
+      if (stats_table_prom_find(name, len) < 0) {
+        break;
+      }
+    }
+    TSError("[%s] %s is exported to Prometheus as %s, %s already uses %s", PLUGIN_NAME, e->name, name, t->entries[taken].name,
+            base);
+    e->prom_name     = name;
+    e->prom_name_len = len;
+    TSfree(base);
+  }
+  stats_table_prom_insert(n);
+}
+
+static void
+stats_table_update(TSRecordType rec_type ATS_UNUSED, void *edata ATS_UNUSED, int registered ATS_UNUSED, const char *name,
+                   TSRecordDataType data_type, TSRecordData *datum)
+{
+  stat_table *t = &stats_table;
+  stat_entry *e;
+
+  /* Records are dumped in registration order and never removed, so the entry at the cursor is
+     normally this record. If not, drop the rest of the table and rebuild it from here. */
+  if (t->cursor < t->count && strcmp(t->entries[t->cursor].name, name) != 0) {
+    int i;
+
+    for (i = t->cursor; i < t->count; ++i) {
+      stat_entry_destroy(&t->entries[i]);
+    }
+    t->count = t->cursor;
+    stats_table_prom_rebuild();
+  }
+
+  if (t->cursor == t->count) {
+    if (t->count == t->capacity) {
+      t->capacity = t->capacity ? t->capacity * 2 : 1024;
+      t->entries  = TSrealloc(t->entries, t->capacity * sizeof(stat_entry));
+      stats_table_prom_rebuild();
+    }
+    stat_entry_init(&t->entries[t->count++], name);
+    e             = &t->entries[t->cursor];
+    e->data_type  = data_type;
+    e->generation = t->generation;
+    stat_entry_set_value(e, data_type, datum);
+    stats_table_prom_add(t->cursor);
+  } else {
+    e = &t->entries[t->cursor];
+    if (stat_entry_changed(e, data_type, datum)) {
+      e->generation = t->generation;
+      stat_entry_set_value(e, data_type, datum);
+    }
+  }
+  ++t->cursor;
+}
+
+static stats_snapshot *
+stats_snapshot_create(void)
+{
+  stats_snapshot *snap = TSmalloc(sizeof(*snap));
+  size_t size          = 0;
+  char *p;
+  int i;
+
+  for (i = 0; i < stats_table.count; ++i) {
+    const stat_entry *e = &stats_table.entries[i];
+
+    size += e->name_len + 1 + e->prom_name_len + 1;
+    if (e->data_type == TS_RECORDDATATYPE_STRING && e->value.rec_string) {
+      size += strlen(e->value.rec_string) + 1;
+    }
+  }
+
+  snap->refcount   = 1;
+  snap->generation = stats_table.generation;
+  snap->count      = stats_table.count;
+  snap->entries    = TSmalloc(snap->count * sizeof(stat_entry) + 1);
+  snap->strings    = p = TSmalloc(size + 1);
+
+  for (i = 0; i < snap->count; ++i) {
+    const stat_entry *e = &stats_table.entries[i];
+    stat_entry *c       = &snap->entries[i];
+
+    *c      = *e;
+    c->name = p;
+    memcpy(p, e->name, e->name_len + 1);
+    p += e->name_len + 1;
+    c->prom_name = p;
+    memcpy(p, e->prom_name, e->prom_name_len + 1);
+    p += e->prom_name_len + 1;
+    if (e->data_type == TS_RECORDDATATYPE_STRING && e->value.rec_string) {
+      c->value.rec_string = p;
+      strcpy(p, e->value.rec_string);
+      p += strlen(p) + 1;
+    }
+  }
+  return snap;
+}
+
+static void
+stats_snapshot_unref(stats_snapshot *snap)
+{
+  if (snap && --snap->refcount == 0) {
+    TSfree(snap->entries);
+    TSfree(snap->strings);
+    TSfree(snap);
+  }
+}
+
+/* Generations are wall clock microseconds, bumped on every refresh. Refreshes are at least a
+   second apart, so a generation handed out before a restart is older than any after it. */
+static uint64_t
+stats_table_next_generation(void)
+{
+  struct timeval tv;
+  uint64_t now;
+
+  gettimeofday(&tv, NULL);
+  now = (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+  return now > stats_table.generation ? now : stats_table.generation + 1;
+}
+
+static void
+stats_table_refresh(void)
+{
+  time_t now = time(NULL);
+
+  if (stats_table.snapshot != NULL && now - stats_table.refreshed < STATS_TABLE_REFRESH_INTERVAL) {
+    return;
+  }
+
+  stats_table.generation = stats_table_next_generation();
+  stats_table.refreshed  = now;
+  stats_table.cursor     = 0;
+  TSRecordDump((TSRecordType)(TS_RECORDTYPE_PLUGIN | TS_RECORDTYPE_NODE | TS_RECORDTYPE_PROCESS), stats_table_update, NULL);
+  TSDebug(PLUGIN_NAME, "refreshed %d stats, generation %" PRIu64, stats_table.count, stats_table.generation);
+
+  stats_snapshot_unref(stats_table.snapshot);
+  stats_table.snapshot = stats_snapshot_create();
+}
+
+/* The snapshot to format a response from, refreshed first if it's stale. */
+static stats_snapshot *
+stats_snapshot_acquire(void)
+{
+  stats_snapshot *snap;
+
+  TSMutexLock(stats_table.mutex);
+  stats_table_refresh();
+  snap = stats_table.snapshot;
+  ++snap->refcount;
+  TSMutexUnlock(stats_table.mutex);
+  return snap;
+}
+
+static void
+stats_snapshot_release(stats_snapshot *snap)
+{
+  if (snap) {
+    TSMutexLock(stats_table.mutex);
+    stats_snapshot_unref(snap);
+    TSMutexUnlock(stats_table.mutex);
+  }
+}
+
+/* Whether entry @a e is part of the response for @a my_state. */
+static bool
+stats_selected(const stats_state *my_state, const stat_entry *e)
+{
+  if (my_state->since && e->generation <= my_state->since) {
+    return false;
+  }
+  if (my_state->prefix_len && (e->name_len < my_state->prefix_len || memcmp(e->name, my_state->prefix, my_state->prefix_len))) {
+    return false;
+  }
+  return true;
+}
+
+/* JSON output */
+
+static void
+json_out_stat(stats_state *my_state, const stat_entry *e)
+{
+  char b[256];
+  int len = 0;
+
+  APPEND("\"");
+  APPEND_LEN(e->name, e->name_len);
+  APPEND("\": ");
+
+  switch (e->data_type) {
+  case TS_RECORDDATATYPE_COUNTER:
   case TS_RECORDDATATYPE_INT:
-    APPEND_STAT_NUMERIC(name, "%" PRIu64, wrap_unsigned_counter(datum->rec_int));
+    len = snprintf(b, sizeof(b), integer_counters ? "%" PRIu64 ",\n" : "\"%" PRIu64 "\",\n",
+                   wrap_unsigned_counter(e->data_type == TS_RECORDDATATYPE_COUNTER ? e->value.rec_counter : e->value.rec_int));
     break;
   case TS_RECORDDATATYPE_FLOAT:
-    APPEND_STAT_NUMERIC(name, "%f", datum->rec_float);
+    len = snprintf(b, sizeof(b), integer_counters ? "%f,\n" : "\"%f\",\n", e->value.rec_float);
     break;
   case TS_RECORDDATATYPE_STRING:
-    APPEND_STAT(name, "%s", datum->rec_string);
-    break;
+    APPEND("\"");
+    if (e->value.rec_string) {
+      APPEND(e->value.rec_string);
+    }
+    APPEND("\",\n");
+    return;
   default:
-    TSDebug(PLUGIN_NAME, "unknown type for %s: %d", name, data_type);
-    break;
+    TSDebug(PLUGIN_NAME, "unknown type for %s: %d", e->name, e->data_type);
+    APPEND("\"\",\n");
+    return;
+  }
+
+  if (len >= (int)sizeof(b)) {
+    len = sizeof(b) - 1;
   }
+  APPEND_LEN(b, len);
 }
+
 static void
 json_out_stats(stats_state *my_state)
 {
   const char *version;
+  int i;
+
   APPEND("{ \"global\": {\n");
 
-  TSRecordDump((TSRecordType)(TS_RECORDTYPE_PLUGIN | TS_RECORDTYPE_NODE | TS_RECORDTYPE_PROCESS), json_out_stat, my_state);
+  for (i = 0; i < my_state->snapshot->count; ++i) {
+    if (stats_selected(my_state, &my_state->snapshot->entries[i])) {
+      json_out_stat(my_state, &my_state->snapshot->entries[i]);
+    }
+  }
   version = TSTrafficServerVersionGet();
   APPEND("\"server\": \"");
   APPEND(version);
@@ -194,16 +612,157 @@ json_out_stats(stats_state *my_state)
   APPEND("  }\n}\n");
 }
 
+/* Prometheus text exposition format. Strings can't be represented and are skipped. Only true
+   counters are typed as such, integer stats may be either counters or gauges. */
+
+static bool
+stat_numeric_value(const stat_entry *e, double *value)
+{
+  switch (e->data_type) {
+  case TS_RECORDDATATYPE_COUNTER:
+    *value = (double)e->value.rec_counter;
+    return true;
+  case TS_RECORDDATATYPE_INT:
+    *value = (double)e->value.rec_int;
+    return true;
+  case TS_RECORDDATATYPE_FLOAT:
+    *value = e->value.rec_float;
+    return true;
+  default:
+    return false;
+  }
+}
+
+static void
+prometheus_out_stats(stats_state *my_state)
+{
+  char b[64];
+  int i, len;
+
+  len = snprintf(b, sizeof(b), "# generation %" PRIu64 "\n", my_state->snapshot->generation);
+  APPEND_LEN(b, len);
+
+  for (i = 0; i < my_state->snapshot->count; ++i) {
+    const stat_entry *e = &my_state->snapshot->entries[i];
+    double value;
+
+    if (!stats_selected(my_state, e) || !stat_numeric_value(e, &value)) {
+      continue;
+    }
+
+    APPEND("# TYPE ");
+    APPEND_LEN(e->prom_name, e->prom_name_len);
+    APPEND(e->data_type == TS_RECORDDATATYPE_COUNTER ? " counter\n" : " untyped\n");
+    APPEND_LEN(e->prom_name, e->prom_name_len);
+    if (e->data_type == TS_RECORDDATATYPE_FLOAT) {
+      len = snprintf(b, sizeof(b), " %f\n", value);
+    } else {
+      len = snprintf(b, sizeof(b), " %" PRId64 "\n",
+                     e->data_type == TS_RECORDDATATYPE_COUNTER ? e->value.rec_counter : e->value.rec_int);
+    }
+    APPEND_LEN(b, len);
+  }
+}
+
+/* Prometheus protobuf format, a sequence of varint length delimited io.prometheus.client.MetricFamily
+   messages. The messages are small and fixed in shape, so they are encoded by hand:
+
+     MetricFamily { name = 1 (string), type = 3 (enum), metric = 4 (Metric) }
+     Metric { counter = 3 (Counter), untyped = 5 (Untyped) }
+     Counter, Untyped { value = 1 (double) }
+*/
+
+#define PB_TYPE_COUNTER 0
+#define PB_TYPE_UNTYPED 3
+
+static int
+pb_varint(unsigned char *buf, uint64_t v)
+{
+  int n = 0;
+
+  while (v >= 0x80) {
+    buf[n++] = (unsigned char)(v | 0x80);
+    v >>= 7;
+  }
+  buf[n++] = (unsigned char)v;
+  return n;
+}
+
+static int
+pb_double(unsigned char *buf, double value)
+{
+  uint64_t bits;
+  int i;
+
+  memcpy(&bits, &value, sizeof(bits));
+  for (i = 0; i < 8; ++i) {
+    buf[i] = (unsigned char)(bits >> (8 * i));
+  }
+  return 8;
+}
+
+static void
+protobuf_out_stats(stats_state *my_state)
+{
+  int i;
+
+  for (i = 0; i < my_state->snapshot->count; ++i) {
+    const stat_entry *e = &my_state->snapshot->entries[i];
+    unsigned char metric[16], head[32];
+    int metric_len = 0, head_len = 0, family_len;
+    bool counter;
+    double value;
+
+    if (!stats_selected(my_state, e) || !stat_numeric_value(e, &value)) {
+      continue;
+    }
+    counter = e->data_type == TS_RECORDDATATYPE_COUNTER;
+
+    /* Metric { counter|untyped { value } } */
+    metric[metric_len++] = counter ? 0x1a : 0x2a; /* field 3 or 5, length delimited */
+    metric[metric_len++] = 9;
+    metric[metric_len++] = 0x09; /* field 1, 64 bit */
+    metric_len += pb_double(metric + metric_len, value);
+
+    /* Length of MetricFamily, the name bytes are written straight from the table. */
+    family_len = 1 + pb_varint(head, e->prom_name_len) + e->prom_name_len + 2 + 2 + metric_len;
+
+    head_len         = pb_varint(head, family_len);
+    head[head_len++] = 0x0a; /* field 1, length delimited */
+    head_len += pb_varint(head + head_len, e->prom_name_len);
+    APPEND_LEN((const char *)head, head_len);
+    APPEND_LEN(e->prom_name, e->prom_name_len);
+
+    head_len         = 0;
+    head[head_len++] = 0x18; /* field 3, varint */
+    head[head_len++] = counter ? PB_TYPE_COUNTER : PB_TYPE_UNTYPED;
+    head[head_len++] = 0x22; /* field 4, length delimited */
+    head[head_len++] = metric_len;
+    APPEND_LEN((const char *)head, head_len);
+    APPEND_LEN((const char *)metric, metric_len);
+  }
+}
+
+static void
+stats_out(stats_state *my_state)
+{
+  switch (my_state->format) {
+  case STATS_FORMAT_PROMETHEUS:
+    prometheus_out_stats(my_state);
+    break;
+  case STATS_FORMAT_PROTOBUF:
+    protobuf_out_stats(my_state);
+    break;
+  default:
+    json_out_stats(my_state);
+    break;
+  }
+}
+
 static void
 stats_process_write(TSCont contp, TSEvent event, stats_state *my_state)
 {
   if (event == TS_EVENT_VCONN_WRITE_READY) {
-    if (my_state->body_written == 0) {
-      TSDebug(PLUGIN_NAME, "plugin adding response body");
-      my_state->body_written = 1;
-      json_out_stats(my_state);
-      TSVIONBytesSet(my_state->write_vio, my_state->output_bytes);
-    }
     TSVIOReenable(my_state->write_vio);
   } else if (TS_EVENT_VCONN_WRITE_COMPLETE) {
     stats_cleanup(contp, my_state);
@@ -231,6 +790,49 @@ stats_dostuff(TSCont contp, TSEvent event, void *edata)
   return 0;
 }
 
+/* Parse the request options: format=json|prometheus|protobuf, prefix=<stat name prefix> and
+   since=<generation>, where the generation is from the X-Stats-Generation of an earlier response. */
+static void
+stats_parse_query(stats_state *my_state, const char *query, int query_len)
+{
+  const char *end = query + query_len;
+
+  while (query < end) {
+    const char *amp     = memchr(query, '&', end - query);
+    const char *arg_end = amp ? amp : end;
+    const char *eq      = memchr(query, '=', arg_end - query);
+
+    if (eq) {
+      int key_len       = eq - query;
+      const char *value = eq + 1;
+      int value_len     = arg_end - value;
+
+      if (key_len == 6 && !memcmp(query, "format", 6)) {
+        if (value_len == 10 && !memcmp(value, "prometheus", 10)) {
+          my_state->format = STATS_FORMAT_PROMETHEUS;
+        } else if (value_len == 8 && !memcmp(value, "protobuf", 8)) {
+          my_state->format = STATS_FORMAT_PROTOBUF;
+        } else {
+          my_state->format = STATS_FORMAT_JSON;
+        }
+      } else if (key_len == 6 && !memcmp(query, "prefix", 6)) {
+        TSfree(my_state->prefix);
+        my_state->prefix     = TSstrndup(value, value_len);
+        my_state->prefix_len = value_len;
+      } else if (key_len == 5 && !memcmp(query, "since", 5)) {
+        char buf[32];
+
+        if (value_len < (int)sizeof(buf)) {
+          memcpy(buf, value, value_len);
+          buf[value_len]  = '\0';
+          my_state->since = strtoull(buf, NULL, 10);
+        }
+      }
+    }
+    query = arg_end + 1;
+  }
+}
+
 static int
 stats_origin(TSCont contp ATS_UNUSED, TSEvent event ATS_UNUSED, void *edata)
 {
@@ -267,6 +869,13 @@ stats_origin(TSCont contp ATS_UNUSED, TSEvent event ATS_UNUSED, void *edata)
   icontp   = TSContCreate(stats_dostuff, TSMutexCreate());
   my_state = (stats_state *)TSmalloc(sizeof(*my_state));
   memset(my_state, 0, sizeof(*my_state));
+
+  int query_len     = 0;
+  const char *query = TSUrlHttpQueryGet(reqp, url_loc, &query_len);
+  if (query && query_len > 0) {
+    stats_parse_query(my_state, query, query_len);
+  }
+
   TSContDataSet(icontp, my_state);
   TSHttpTxnIntercept(icontp, txnp);
   goto cleanup;
@@ -327,6 +936,8 @@ init:
   }
   url_path_len = strlen(url_path);
 
+  stats_table.mutex = TSMutexCreate();
+
   /* Create a continuation with a mutex as there is a shared global structure
      containing the headers to add */
   TSHttpHookAdd(TS_HTTP_READ_REQUEST_HDR_HOOK, TSContCreate(stats_origin, NULL));
@@ -83,6 +83,27 @@ HttpRequestData::get_client_ip()
   return &src_ip.sa;
 }
 
+const char *
+HttpRequestData::get_match_string(int *length)
+{
+  URLImpl *url = hdr->url_get()->m_url_impl;
+
+  // The target has to be looked at as well as the URL, the printed URL takes the host and port
+  // from the Host header if the URL doesn't have them.
+  if (match_str == nullptr || match_hdr != hdr || match_url != url || match_url_generation != url->m_generation ||
+      match_target_generation != hdr->target_generation()) {
+    RequestData::get_match_string(length);
+
+    match_hdr               = hdr;
+    match_url               = url;
+    match_url_generation    = url->m_generation;
+    match_target_generation = hdr->target_generation();
+  }
+
+  *length = match_len;
+  return match_str;
+}
+
 /*************************************************************
  *   Begin class HostMatcher
  *************************************************************/
@@ -341,29 +362,22 @@ template <class Data, class MatchResult>
 void
 UrlMatcher<Data, MatchResult>::Match(RequestData *rdata, MatchResult *result)
 {
-  char *url_str;
+  const char *url_str;
+  int url_len;
   int *value;
 
-  // Check to see there is any work to before we copy the
-  //   URL
+  // Check to see there is any work to before we get
+  //   the URL
   if (num_el <= 0) {
     return;
   }
 
-  url_str = rdata->get_string();
-
-  // Can't do a regex match with a NULL string so
-  //  use an empty one instead
-  if (url_str == nullptr) {
-    url_str = ats_strdup("");
-  }
+  url_str = rdata->get_match_string(&url_len);
 
   if (ink_hash_table_lookup(url_ht, url_str, (void **)&value)) {
     Debug("matcher", "%s Matched %s with url at line %d", matcher_name, url_str, data_array[*value].line_num);
     data_array[*value].UpdateMatch(result, rdata);
   }
-
-  ats_free(url_str);
 }
 
 //
@@ -473,12 +487,28 @@ RegexMatcher<Data, MatchResult>::NewEntry(matcher_line *line_info)
     pcre_free(re_array[num_el]);
     re_array[num_el] = nullptr;
   } else {
+    filter.add(re_str[num_el]);
     num_el++;
   }
 
   return error;
 }
 
+//
+// void RegexMatcher<Data,MatchResult>::CompileFilter()
+//
+//   Builds the literal prefilter once all of the entries
+//     have been added
+//
+template <class Data, class MatchResult>
+void
+RegexMatcher<Data, MatchResult>::CompileFilter()
+{
+  if (!filter.is_compiled()) {
+    filter.compile();
+  }
+}
+
 //
 // void RegexMatcher<Data,MatchResult>::Match(RequestData* rdata, MatchResult* result)
 //
@@ -489,38 +519,50 @@ template <class Data, class MatchResult>
 void
 RegexMatcher<Data, MatchResult>::Match(RequestData *rdata, MatchResult *result)
 {
-  char *url_str;
-  int r;
+  const char *url_str;
+  int url_len;
 
-  // Check to see there is any work to before we copy the
-  //   URL
+  // Check to see there is any work to before we get
+  //   the URL
   if (num_el <= 0) {
     return;
   }
 
-  url_str = rdata->get_string();
-
-  // Can't do a regex match with a NULL string so
-  //  use an empty one instead
-  if (url_str == nullptr) {
-    url_str = ats_strdup("");
-  }
+  url_str = rdata->get_match_string(&url_len);
   // INKqa12980
   // The function unescapifyStr() is already called in
   // HttpRequestData::get_string(); therefore, no need to call again here.
   // unescapifyStr(url_str);
 
+  MatchList(url_str, url_len, rdata, result);
+}
+
+//
+// void RegexMatcher<Data,MatchResult>::MatchList(const char* str, int len, RequestData* rdata, MatchResult* result)
+//
+//   Runs the regexs that the prefilter can't rule out against
+//     arg str, in table order, and updates arg result for each match
+//
+template <class Data, class MatchResult>
+void
+RegexMatcher<Data, MatchResult>::MatchList(const char *str, int len, RequestData *rdata, MatchResult *result)
+{
+  RegexPrefilter::Candidates candidates(filter, str, len);
+  int r;
+
   for (int i = 0; i < num_el; i++) {
-    r = pcre_exec(re_array[i], nullptr, url_str, strlen(url_str), 0, 0, nullptr, 0);
+    if (!candidates.test(i)) {
+      continue;
+    }
+    r = pcre_exec(re_array[i], nullptr, str, len, 0, 0, nullptr, 0);
     if (r > -1) {
-      Debug("matcher", "%s Matched %s with regex at line %d", matcher_name, url_str, data_array[i].line_num);
+      Debug("matcher", "%s Matched %s with regex at line %d", matcher_name, str, data_array[i].line_num);
       data_array[i].UpdateMatch(result, rdata);
     } else if (r < -1) {
       // An error has occured
       Warning("Error [%d] matching regex at line %d.", r, data_array[i].line_num);
     } // else it's -1 which means no match was found.
   }
-  ats_free(url_str);
 }
 
 //
@@ -543,7 +585,6 @@ void
 HostRegexMatcher<Data, MatchResult>::Match(RequestData *rdata, MatchResult *result)
 {
   const char *url_str;
-  int r;
 
   // Check to see there is any work to before we copy the
   //   URL
@@ -558,17 +599,7 @@ HostRegexMatcher<Data, MatchResult>::Match(RequestData *rdata, MatchResult *resu
   if (url_str == nullptr) {
     url_str = "";
   }
-  for (int i = 0; i < this->num_el; i++) {
-    r = pcre_exec(this->re_array[i], nullptr, url_str, strlen(url_str), 0, 0, nullptr, 0);
-    if (r != -1) {
-      Debug("matcher", "%s Matched %s with regex at line %d", const_cast<char *>(this->matcher_name), url_str,
-            this->data_array[i].line_num);
-      this->data_array[i].UpdateMatch(result, rdata);
-    } else {
-      // An error has occured
-      Warning("error matching regex at line %d", this->data_array[i].line_num);
-    }
-  }
+  this->MatchList(url_str, strlen(url_str), rdata, result);
 }
 
 //
@@ -931,6 +962,13 @@ ControlMatcher<Data, MatchResult>::BuildTableFromString(char *file_buf)
 
   ink_assert(second_pass == numEntries);
 
+  if (reMatch != nullptr) {
+    reMatch->CompileFilter();
+  }
+  if (hrMatch != nullptr) {
+    hrMatch->CompileFilter();
+  }
+
   if (is_debug_tag_set("matcher")) {
     Print();
   }
@@ -122,12 +122,48 @@ public:
   //  get_ip() can be either client_ip or server_ip
   //  depending on how the module user wants to key
   //  the table
-  virtual ~RequestData() {}
+  virtual ~RequestData() { ats_free(match_str); }
   virtual char *get_string()       = 0;
   virtual const char *get_host()   = 0;
   virtual sockaddr const *get_ip() = 0;
 
   virtual sockaddr const *get_client_ip() = 0;
+
+  /** The string the URL and regex tables match against, with its length in @a length.
+
+      This is @c get_string (or an empty string if that is @c NULL) but owned by the request data,
+      callers must not free it. It stays valid until the next call or @c clear_match_string.
+      Subclasses whose string can be computed once per request override this to keep it.
+  */
+  virtual const char *
+  get_match_string(int *length)
+  {
+    ats_free(match_str);
+    match_str = get_string();
+
+    // Can't do a regex match with a NULL string so
+    //  use an empty one instead
+    if (match_str == nullptr) {
+      match_str = ats_strdup("");
+    }
+    match_len = strlen(match_str);
+
+    *length = match_len;
+    return match_str;
+  }
+
+  /// Release the match string.
+  void
+  clear_match_string()
+  {
+    ats_free(match_str);
+    match_str = nullptr;
+    match_len = 0;
+  }
+
+protected:
+  char *match_str = nullptr; ///< Cached match string.
+  int match_len   = 0;       ///< Length of @a match_str.
 };
 
 class HttpRequestData : public RequestData
@@ -137,6 +173,7 @@ public:
   inkcoreapi const char *get_host();
   inkcoreapi sockaddr const *get_ip();
   inkcoreapi sockaddr const *get_client_ip();
+  inkcoreapi const char *get_match_string(int *length);
 
   HttpRequestData()
     : hdr(NULL),
@@ -164,6 +201,15 @@ public:
   bool internal_txn;
   URL **cache_info_lookup_url;
   URL **cache_info_parent_selection_url;
+
+private:
+  // What the match string was computed from. While the URL and the target it is printed with
+  // keep their generations the string is reused by every ControlMatcher consulted for the
+  // transaction (cache.config, parent.config and so on).
+  HTTPHdr *match_hdr               = nullptr;
+  URLImpl *match_url               = nullptr;
+  uint32_t match_url_generation    = 0;
+  uint32_t match_target_generation = 0;
 };
 
 // Mixin class for shared info across all templates. This just wraps the
@@ -219,6 +265,7 @@ public:
   void Match(RequestData *rdata, MatchResult *result);
   void AllocateSpace(int num_entries);
   Result NewEntry(matcher_line *line_info);
+  void CompileFilter();
   void Print();
 
   using super::num_el;
@@ -228,8 +275,11 @@ public:
   using super::array_len;
 
 protected:
+  void MatchList(const char *str, int len, RequestData *rdata, MatchResult *result);
+
   pcre **re_array = nullptr; // array of compiled regexs
   char **re_str   = nullptr; // array of uncompiled regex strings
+  RegexPrefilter filter;     // literal prefilter over re_array, same indices
 };
 
 template <class Data, class MatchResult> class HostRegexMatcher : public RegexMatcher<Data, MatchResult>
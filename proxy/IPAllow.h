@@ -154,6 +154,7 @@ public:
   }
 
   typedef ConfigProcessor::scoped_config<IpAllow, IpAllow> scoped_config;
+  friend scoped_config;
 
 private:
   static int configid;
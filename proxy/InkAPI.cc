@@ -85,6 +85,8 @@
 // Globals for new librecords stats
 static volatile int api_rsb_index = 0;
 static RecRawStatBlock *api_rsb;
+static volatile int api_rhb_index = 0;
+static RecHistogramBlock *api_rhb;
 
 // Globals for the Sessions/Transaction index registry
 static volatile int next_argv_index = 0;
@@ -1658,6 +1660,11 @@ api_init()
       api_rsb = nullptr;
     }
 
+    api_rhb = RecAllocateHistogramBlock(TS_MAX_API_HISTOGRAMS);
+    if (nullptr == api_rhb) {
+      Warning("Can't allocate API histogram block");
+    }
+
     memset(state_arg_table, 0, sizeof(state_arg_table));
 
     // Setup the version string for returning to plugins
@@ -7033,6 +7040,30 @@ TSStatFindName(const char *name, int *idp)
   return TS_SUCCESS;
 }
 
+int
+TSStatHistogramCreate(const char *the_name)
+{
+  int id = ink_atomic_increment(&api_rhb_index, 1);
+
+  if ((sdk_sanity_check_null_ptr((void *)the_name) != TS_SUCCESS) || (sdk_sanity_check_null_ptr((void *)api_rhb) != TS_SUCCESS) ||
+      (id >= api_rhb->max_histograms)) {
+    return TS_ERROR;
+  }
+
+  if (RecRegisterHistogram(api_rhb, RECT_PLUGIN, the_name, id) != REC_ERR_OKAY) {
+    return TS_ERROR;
+  }
+
+  return id;
+}
+
+void
+TSStatHistogramRecord(int id, TSMgmtInt value)
+{
+  sdk_assert(api_rhb != nullptr && id >= 0 && id < api_rhb->max_histograms);
+  RecHistogramRecord(api_rhb, nullptr, id, value);
+}
+
 /**************************    Stats API    ****************************/
 // THESE APIS ARE DEPRECATED, USE THE REC APIs INSTEAD
 // #define ink_sanity_check_stat_structure(_x) TS_SUCCESS
@@ -7740,7 +7771,7 @@ TSAIOThreadNumSet(int thread_num)
 void
 TSRecordDump(int rec_type, TSRecordDumpCb callback, void *edata)
 {
-  RecDumpRecords((RecT)rec_type, (RecDumpEntryCb)callback, edata);
+  RecDumpRecordsSnapshot((RecT)rec_type, (RecDumpEntryCb)callback, edata);
 }
 
 /* ability to skip the remap phase of the State Machine
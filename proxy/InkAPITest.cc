@@ -39,6 +39,8 @@
 #include <unistd.h>
 #include <cstdio>
 #include <cstring>
+#include <atomic>
+#include <thread>
 
 #include "ts/Regression.h"
 #include "api/ts/ts.h"
@@ -8086,3 +8088,70 @@ REGRESSION_TEST(SDK_API_TSStatCreate)(RegressionTest *test, int level, int *psta
 
   box.check(expected >= value, "TSStatIntGet(%s) gave %" PRId64 ", expected at least %" PRId64, name, value, expected);
 }
+
+static void
+raw_stat_snapshot_dump_cb(TSRecordType /* type ATS_UNUSED */, void *edata, int /* registered ATS_UNUSED */, const char *name,
+                          TSRecordDataType /* type ATS_UNUSED */, TSRecordData *datum)
+{
+  if (strcmp(name, "proxy.process.regression.raw_stat_snapshot") == 0) {
+    *static_cast<TSMgmtInt *>(edata) = datum->rec_int;
+  }
+}
+
+// Read the raw stat snapshot from another thread while sync passes publish new
+// values. Each pass publishes count == 2 * sum, so a torn read shows up as a
+// pair that breaks that, or as a sum going backwards.
+REGRESSION_TEST(SDK_API_TSRecordDump_snapshot)(RegressionTest *test, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  const int64_t passes = 200;
+  TestBox box(test, pstatus);
+  RecRawStatBlock *rsb = RecAllocateRawStatBlock(1);
+  RecRawStatTotal total;
+  TSMgmtInt dumped = -1;
+  std::atomic<bool> done{false};
+  std::atomic<int64_t> torn{0}, reads{0};
+
+  box = REGRESSION_TEST_PASSED;
+
+  if (!box.check(rsb != nullptr, "could not allocate a raw stat block")) {
+    return;
+  }
+  RecRegisterRawStat(rsb, RECT_PROCESS, "proxy.process.regression.raw_stat_snapshot", RECD_INT, RECP_NON_PERSISTENT, 0,
+                     RecRawStatSyncSum);
+
+  std::thread reader([&]() {
+    int64_t last = 0;
+    RecRawStatTotal snap;
+
+    while (!done.load()) {
+      if (RecGetRawStatSnapshot(rsb, 0, &snap) == REC_ERR_OKAY) {
+        if (snap.count != 2 * snap.sum || snap.sum < last) {
+          ++torn;
+        }
+        last = snap.sum;
+        ++reads;
+      }
+    }
+  });
+
+  for (int64_t i = 1; i <= passes; ++i) {
+    {
+      // The sync reads the globals under this lock, so it sees both or neither
+      ink_scoped_mutex_lock lock(rsb->mutex);
+      RecSetGlobalRawStatSum(rsb, 0, i);
+      RecSetGlobalRawStatCount(rsb, 0, 2 * i);
+    }
+    RecExecRawStatSyncCbs();
+  }
+  done = true;
+  reader.join();
+
+  box.check(reads > 0, "the snapshot was never read during the sync passes");
+  box.check(torn == 0, "%" PRId64 " of %" PRId64 " snapshot reads were inconsistent", torn.load(), reads.load());
+  box.check(RecGetRawStatSnapshot(rsb, 0, &total) == REC_ERR_OKAY, "no snapshot after a sync");
+  box.check(total.sum == passes && total.count == 2 * passes,
+            "last snapshot is %" PRId64 "/%" PRId64 ", expected %" PRId64 "/%" PRId64, total.sum, total.count, passes, 2 * passes);
+
+  TSRecordDump(TS_RECORDTYPE_PROCESS, raw_stat_snapshot_dump_cb, &dumped);
+  box.check(dumped == passes, "TSRecordDump gave %" PRId64 ", expected %" PRId64, dumped, passes);
+}
@@ -672,6 +672,14 @@ CB_After_Cache_Init()
     }
   }
 
+  // Stripes initialized from version 24.2 on are keyed by the Murmur3 URL hash, older ones by MD5. There
+  // is one hash for the whole cache, so switch only once every stripe is new enough. Older stripes stay
+  // readable and keep MD5 until they are cleared.
+  if (URLHashContext::Setting == URLHashContext::MD5 && !(cacheProcessor.min_stripe_version < VersionNumber(24, 2))) {
+    Debug("cache_bc", "All stripes are cache version 24.2 or later, using Murmur3 hash for cache URLs");
+    URLHashContext::Setting = URLHashContext::MURMUR3;
+  }
+
   if (1 == start) {
     Debug("http_listen", "Delayed listen enable, cache initialization finished");
     start_HttpProxyServer();
@@ -1688,6 +1696,9 @@ main(int /* argc ATS_UNUSED */, const char **argv)
     ::exit(0);
   }
 
+  // Thread local stats have to be allocated before the event threads start.
+  configProcessor.init_stats();
+
   // We need to do this early so we can initialize the Machine
   // singleton, which depends on configuration values loaded in this.
   // We want to initialize Machine as early as possible because it
@@ -1386,6 +1386,31 @@ EXCLUSIVE_REGRESSION_TEST(PARENTSELECTION)(RegressionTest * /* t ATS_UNUSED */,
   sleep(1);
   RE(verify(result, PARENT_SPECIFIED, "fuzzy", 80), 183);
 
+  // Test 184 - 186, the URL changes within one transaction, as with remap or a redirect. The
+  // match string kept by the request data must follow it.
+  tbl[0] = '\0';
+  T("url_regex=snoopy parent=odie:80\n");
+  T("url_regex=miffy parent=nintje:80\n");
+  T("dest_domain=. parent=garfield:80\n");
+  REBUILD;
+  ST(184);
+  REINIT;
+  br(request, "www.snoopy.net");
+  request->hdr->url_set(snoopy_dog, strlen(snoopy_dog));
+  FP;
+  RE(verify(result, PARENT_SPECIFIED, "odie", 80), 184);
+  ST(185);
+  const char *miffy = "http://www.miffy.com/";
+  request->hdr->url_set(miffy, strlen(miffy));
+  result->reset();
+  FP;
+  RE(verify(result, PARENT_SPECIFIED, "nintje", 80), 185);
+  ST(186);
+  request->hdr->url_get()->host_set("www.odie.com", 12);
+  result->reset();
+  FP;
+  RE(verify(result, PARENT_SPECIFIED, "garfield", 80), 186);
+
   delete request;
   delete result;
   delete params;
@@ -2008,6 +2008,10 @@ tsapi void TSStatIntSet(int the_stat, TSMgmtInt value);
 
 tsapi TSReturnCode TSStatFindName(const char *name, int *idp);
 
+/* Histograms are exposed as the stats <name>.count, .sum, .p50, .p90, .p99, .p999 and .max. */
+tsapi int TSStatHistogramCreate(const char *the_name);
+tsapi void TSStatHistogramRecord(int the_histogram, TSMgmtInt value);
+
 /* --------------------------------------------------------------------------
    tracing api */
 
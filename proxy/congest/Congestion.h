@@ -223,7 +223,7 @@ struct CongestionEntry : public RequestData {
   virtual char *
   get_string()
   {
-    return pRecord->prefix;
+    return ats_strdup(pRecord->prefix);
   }
   virtual const char *
   get_host()
@@ -1567,7 +1567,10 @@ HTTPHdr::_fill_target_cache() const
     m_port           = url_canonicalize_port(url->m_url_impl->m_url_type, m_port);
   }
 
-  m_target_cached = true;
+  static uint32_t generation = 0;
+
+  m_target_cached     = true;
+  m_target_generation = ink_atomic_increment(&generation, 1) + 1;
 }
 
 void
@@ -1810,13 +1813,14 @@ ClassAllocator<HTTPCacheAlt> httpCacheAltAllocator("httpCacheAltAllocator");
 /*-------------------------------------------------------------------------
   -------------------------------------------------------------------------*/
 int constexpr HTTPCacheAlt::N_INTEGRAL_FRAG_OFFSETS;
+uint32_t constexpr HTTPCacheAlt::NO_VARY_SIGNATURE;
 
 HTTPCacheAlt::HTTPCacheAlt()
   : m_magic(CACHE_ALT_MAGIC_ALIVE),
     m_writeable(1),
     m_unmarshal_len(-1),
     m_id(-1),
-    m_rid(-1),
+    m_vary_signature(NO_VARY_SIGNATURE),
     m_request_hdr(),
     m_response_hdr(),
     m_request_sent_time(0),
@@ -1857,7 +1861,7 @@ HTTPCacheAlt::copy(HTTPCacheAlt *to_copy)
   // m_writeable =      to_copy->m_writeable;
   m_unmarshal_len  = to_copy->m_unmarshal_len;
   m_id             = to_copy->m_id;
-  m_rid            = to_copy->m_rid;
+  m_vary_signature = to_copy->m_vary_signature;
   m_object_key[0]  = to_copy->m_object_key[0];
   m_object_key[1]  = to_copy->m_object_key[1];
   m_object_key[2]  = to_copy->m_object_key[2];
@@ -1928,6 +1932,24 @@ HTTPInfo::copy_frag_offsets_from(HTTPInfo *src)
   }
 }
 
+// Every cache hit copies its headers out of the stored alternate
+//  and shares the stored string heap rather than copying the
+//  strings.  Dropping dead strings and extra string heaps once
+//  per write lets those hits inherit a single compact heap that
+//  never has to be coalesced.  This rewrites the heaps in place,
+//  so it must be called before the alternate is shared with
+//  readers.
+void
+HTTPInfo::compact_str_heaps()
+{
+  if (m_alt->m_request_hdr.valid()) {
+    m_alt->m_request_hdr.m_heap->compact_str_heaps();
+  }
+  if (m_alt->m_response_hdr.valid()) {
+    m_alt->m_response_hdr.m_heap->compact_str_heaps();
+  }
+}
+
 int
 HTTPInfo::marshal_length()
 {
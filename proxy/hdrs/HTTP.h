@@ -492,6 +492,7 @@ public:
   mutable int m_port                   = 0;     ///< Target port.
   mutable bool m_target_cached         = false; ///< Whether host name and port are cached.
   mutable bool m_target_in_url         = false; ///< Whether host name and port are in the URL.
+  mutable uint32_t m_target_generation = 0;     ///< Stamped when the target is cached.
   mutable bool m_100_continue_required = false; ///< Whether 100_continue is in the Expect header.
   /// Set if the port was effectively specified in the header.
   /// @c true if the target (in the URL or the HOST field) also specified
@@ -609,6 +610,11 @@ public:
   /// header internals, they must be able to do this.
   void mark_target_dirty() const;
 
+  /// Changes whenever the target cache is filled again, i.e. after the target
+  /// may have changed. With the URL's generation it tells whether the printed
+  /// URL can be different.
+  uint32_t target_generation() const;
+
   HTTPStatus status_get();
   void status_set(HTTPStatus status);
 
@@ -920,6 +926,13 @@ HTTPHdr::mark_target_dirty() const
 {
   m_target_cached = false;
 }
+
+inline uint32_t
+HTTPHdr::target_generation() const
+{
+  this->_test_and_fill_target_cache();
+  return m_target_generation;
+}
 /*-------------------------------------------------------------------------
   -------------------------------------------------------------------------*/
 
@@ -1315,7 +1328,12 @@ struct HTTPCacheAlt {
   int32_t m_unmarshal_len;
 
   int32_t m_id;
-  int32_t m_rid;
+  /// Hash of the request fields this alternate was selected by, see
+  /// HttpTransactCache::calculate_vary_signature.
+  uint32_t m_vary_signature;
+  /// Alternates that can't be matched by signature (Vary: *, or written
+  /// before signatures were kept, where this slot was always -1).
+  static uint32_t constexpr NO_VARY_SIGNATURE = 0xFFFFFFFF;
 
   int32_t m_object_key[4];
   int32_t m_object_size[2];
@@ -1384,6 +1402,7 @@ public:
   void copy_frag_offsets_from(HTTPInfo *src);
   HTTPInfo &operator=(const HTTPInfo &m);
 
+  void compact_str_heaps();
   inkcoreapi int marshal_length();
   inkcoreapi int marshal(char *buf, int len);
   static int unmarshal(char *buf, int len, RefCountObj *block_ref);
@@ -1395,10 +1414,10 @@ public:
   {
     return m_alt->m_id;
   }
-  int32_t
-  rid_get()
+  uint32_t
+  vary_signature_get()
   {
-    return m_alt->m_rid;
+    return m_alt->m_vary_signature;
   }
 
   void
@@ -1407,9 +1426,9 @@ public:
     m_alt->m_id = id;
   }
   void
-  rid_set(int32_t id)
+  vary_signature_set(uint32_t signature)
   {
-    m_alt->m_rid = id;
+    m_alt->m_vary_signature = signature;
   }
 
   INK_MD5 object_key_get();
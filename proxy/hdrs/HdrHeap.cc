@@ -44,6 +44,27 @@ static HdrHeap proto_heap;
 
 Allocator strHeapAllocator("hdrStrHeap", HDR_STR_HEAP_DEFAULT_SIZE);
 
+// Header values common enough that every heap can point at one
+//  shared copy instead of duplicating them.  Keep this list short,
+//  the whole intern heap is carried along when a heap holding an
+//  interned string is marshalled without being compacted first.
+static const char *const hdr_intern_values[] = {
+  "close", "keep-alive", "chunked", "gzip", "deflate", "br", "identity", "bytes", "none", "no-cache", "no-store", "private",
+  "public", "must-revalidate", "max-age=0", "Accept-Encoding", "Origin", "text/html", "text/plain", "text/css",
+  "text/javascript", "application/javascript", "application/json", "application/octet-stream", "image/gif", "image/jpeg",
+  "image/png", "text/html; charset=utf-8", "text/html; charset=UTF-8", "nosniff", "SAMEORIGIN", "*", "0"};
+
+#define HDR_INTERN_COUNT (sizeof(hdr_intern_values) / sizeof(hdr_intern_values[0]))
+#define HDR_INTERN_MAX_LEN 32
+
+struct HdrInternStr {
+  const char *str;
+  int len;
+};
+
+HdrStrHeap *hdr_intern_str_heap = nullptr;
+static HdrInternStr hdr_intern_strs[HDR_INTERN_COUNT];
+
 /*-------------------------------------------------------------------------
   -------------------------------------------------------------------------*/
 
@@ -133,6 +154,46 @@ new_HdrHeap(int size)
   return h;
 }
 
+// void hdr_heap_intern_init()
+//
+//   Builds the intern string heap.  It is allocated directly
+//    rather than from the thread allocator since it may be
+//    created before any EThread exists, and holds a reference
+//    of its own so it is never freed.
+//
+void
+hdr_heap_intern_init()
+{
+  if (hdr_intern_str_heap) {
+    return;
+  }
+
+  int total = 0;
+  for (auto v : hdr_intern_values) {
+    total += strlen(v);
+  }
+
+  int alloc_size = ROUND(STR_HEAP_HDR_SIZE + total, HDR_PTR_SIZE);
+  HdrStrHeap *sh = new (ats_malloc(alloc_size)) HdrStrHeap();
+
+  sh->m_heap_size  = alloc_size;
+  sh->m_free_size  = alloc_size - STR_HEAP_HDR_SIZE;
+  sh->m_free_start = ((char *)sh) + STR_HEAP_HDR_SIZE;
+  sh->refcount_inc();
+
+  for (unsigned i = 0; i < HDR_INTERN_COUNT; i++) {
+    int len = strlen(hdr_intern_values[i]);
+    ink_release_assert(len <= HDR_INTERN_MAX_LEN);
+
+    char *str = sh->allocate(len);
+    memcpy(str, hdr_intern_values[i], len);
+    hdr_intern_strs[i].str = str;
+    hdr_intern_strs[i].len = len;
+  }
+
+  hdr_intern_str_heap = sh;
+}
+
 HdrStrHeap *
 new_HdrStrHeap(int requested_size)
 {
@@ -319,6 +380,49 @@ HdrHeap::duplicate_str(const char *str, int nbytes)
   return (new_str);
 }
 
+// const char* HdrHeap::intern_str(const char* str, int nbytes)
+//
+//  Returns the shared interned copy of str if it is one of
+//   the interned header values, attaching the intern heap as
+//   a read only heap if needed.  Returns NULL if the string is
+//   not interned or there is no read only slot left for the
+//   intern heap, the caller should then copy the string.
+//
+const char *
+HdrHeap::intern_str(const char *str, int nbytes)
+{
+  if (hdr_intern_str_heap == nullptr || nbytes <= 0 || nbytes > HDR_INTERN_MAX_LEN) {
+    return nullptr;
+  }
+
+  const char *interned = nullptr;
+  for (const auto &i : hdr_intern_strs) {
+    if (i.len == nbytes && memcmp(i.str, str, nbytes) == 0) {
+      interned = i.str;
+      break;
+    }
+  }
+  if (interned == nullptr) {
+    return nullptr;
+  }
+
+  char *h_start = ((char *)hdr_intern_str_heap) + STR_HEAP_HDR_SIZE;
+  int slot;
+
+  // Heaps are allocated from the front of the array
+  for (slot = 0; slot < HDR_BUF_RONLY_HEAPS && m_ronly_heap[slot].m_heap_start != nullptr; slot++) {
+    if (m_ronly_heap[slot].m_heap_start == h_start) {
+      return interned;
+    }
+  }
+
+  int h_len = hdr_intern_str_heap->m_heap_size - STR_HEAP_HDR_SIZE - hdr_intern_str_heap->m_free_size;
+  if (!attach_str_heap(h_start, h_len, hdr_intern_str_heap, &slot)) {
+    return nullptr;
+  }
+  return interned;
+}
+
 // int HdrHeap::demote_rw_str_heap()
 //
 //  Returns 0 on success and non-zero failure
@@ -391,6 +495,29 @@ HdrHeap::coalesce_str_heaps(int incoming_size)
   ink_assert(heaps_removed > 0 || incoming_size > 0 || m_ronly_heap[0].m_heap_start == nullptr);
 }
 
+// void HdrHeap::compact_str_heaps()
+//
+//    Collapse all string heaps into a single one holding only
+//      live strings.  Used before marshalling a header that
+//      will be shared read only, so that every copy made from
+//      it inherits one string heap and no lost string space
+//
+void
+HdrHeap::compact_str_heaps()
+{
+  if (!m_writeable || (m_lost_string_space == 0 && m_ronly_heap[0].m_heap_start == nullptr)) {
+    return;
+  }
+
+  for (auto &i : m_ronly_heap) {
+    if (i.m_locked) {
+      return;
+    }
+  }
+
+  coalesce_str_heaps();
+}
+
 void
 HdrHeap::evacuate_from_str_heaps(HdrStrHeap *new_heap)
 {
@@ -968,10 +1095,6 @@ HdrHeap::unmarshal(int buf_length, int obj_type, HdrHeapObjImpl **found_obj, Ref
 inline bool
 HdrHeap::attach_str_heap(char *h_start, int h_len, RefCountObj *h_ref_obj, int *index)
 {
-  if (*index >= HDR_BUF_RONLY_HEAPS) {
-    return false;
-  }
-
   // Loop over existing entries to see if this one is already present
   for (int z = 0; z < *index; z++) {
     if (m_ronly_heap[z].m_heap_start == h_start) {
@@ -988,6 +1111,11 @@ HdrHeap::attach_str_heap(char *h_start, int h_len, RefCountObj *h_ref_obj, int *
     }
   }
 
+  // A heap already attached needs no slot, see inherit_string_heaps()
+  if (*index >= HDR_BUF_RONLY_HEAPS) {
+    return false;
+  }
+
   m_ronly_heap[*index].m_ref_count_ptr = h_ref_obj;
   m_ronly_heap[*index].m_heap_start    = h_start;
   m_ronly_heap[*index].m_heap_len      = h_len;
@@ -997,6 +1125,17 @@ HdrHeap::attach_str_heap(char *h_start, int h_len, RefCountObj *h_ref_obj, int *
   return true;
 }
 
+bool
+HdrHeap::has_ronly_str_heap(const char *h_start) const
+{
+  for (const auto &i : m_ronly_heap) {
+    if (i.m_heap_start == h_start) {
+      return true;
+    }
+  }
+  return false;
+}
+
 // void HdrHeap::inhertit_string_heaps(const HdrHeap* inherit_from)
 //
 //    Inherits all of inherit_from's string heaps as read-only
@@ -1026,14 +1165,21 @@ HdrHeap::inherit_string_heaps(const HdrHeap *inherit_from)
     }
   }
 
-  // Find out if we have enough slots
+  // Find out if we have enough slots.  Heaps we already share
+  //  with inherit_from (a previous copy from the same cached
+  //  header, the intern heap) are attached once so they don't
+  //  need a slot
   if (inherit_from->m_read_write_heap) {
-    free_slots--;
+    if (!has_ronly_str_heap(((char *)inherit_from->m_read_write_heap.get()) + STR_HEAP_HDR_SIZE)) {
+      free_slots--;
+    }
     inherit_str_size = inherit_from->m_read_write_heap->m_heap_size;
   }
   for (index = 0; index < HDR_BUF_RONLY_HEAPS; index++) {
     if (inherit_from->m_ronly_heap[index].m_heap_start != nullptr) {
-      free_slots--;
+      if (!has_ronly_str_heap(inherit_from->m_ronly_heap[index].m_heap_start)) {
+        free_slots--;
+      }
       inherit_str_size += inherit_from->m_ronly_heap[index].m_heap_len;
     } else {
       // Heaps are allocated from the front of the array, so if
@@ -1279,4 +1425,67 @@ REGRESSION_TEST(HdrHeap_Coalesce)(RegressionTest *t, int /* atype ATS_UNUSED */,
   // Clean up
   heap->destroy();
 }
+REGRESSION_TEST(HdrHeap_Intern)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  *pstatus = REGRESSION_TEST_PASSED;
+  TestBox tb(t, pstatus);
+
+  hdr_heap_intern_init();
+
+  HTTPHdr cached;
+  int len;
+  cached.create(HTTP_TYPE_RESPONSE);
+  cached.value_set("Connection", 10, "close", 5);
+  cached.value_set("X-Test", 6, "not interned", 12);
+  cached.value_set("Keep-Alive", 10, "timeout=5", 9);
+
+  const char *v = cached.value_get("Connection", 10, &len);
+  tb.check(len == 5 && hdr_intern_str_heap->contains(v), "Checking that a common value is interned");
+  v = cached.value_get("X-Test", 6, &len);
+  tb.check(len == 12 && !hdr_intern_str_heap->contains(v), "Checking that an uncommon value is copied");
+
+  int lost = cached.m_heap->m_lost_string_space;
+  cached.value_set("Connection", 10, "keep-alive", 10);
+  tb.check(cached.m_heap->m_lost_string_space == lost, "Checking that replacing an interned value loses no space");
+
+  // Dropping fields leaves lost space, compacting must get rid of it and
+  //  of the intern heap slot while keeping the live strings intact
+  cached.field_delete("Connection", 10);
+  cached.field_delete("Keep-Alive", 10);
+
+  cached.m_heap->compact_str_heaps();
+  tb.check(cached.m_heap->m_lost_string_space == 0, "Checking that compacting drops lost string space");
+  tb.check(cached.m_heap->m_ronly_heap[0].m_heap_start == nullptr, "Checking that compacting leaves only the rw heap");
+  v = cached.value_get("X-Test", 6, &len);
+  tb.check(len == 12 && memcmp(v, "not interned", 12) == 0, "Checking that live strings survive compacting");
+
+  // Copying onto the same heap twice from the same source must share the
+  //  source string heap once, not burn a slot per copy
+  HTTPHdr hit;
+  hit.create(HTTP_TYPE_RESPONSE);
+  hit.copy(&cached);
+  hit.copy(&cached);
+  tb.check(hit.m_heap->m_ronly_heap[1].m_heap_start == nullptr, "Checking that repeated inherits share one slot");
+  v = hit.value_get("X-Test", 6, &len);
+  tb.check(len == 12 && cached.m_heap->m_read_write_heap->contains(v), "Checking that the copy shares the source strings");
+
+  // With every read only slot taken, copying again from a source
+  //  whose heap is already attached must not need a slot
+  HTTPHdr other[HDR_BUF_RONLY_HEAPS - 1];
+  for (auto &o : other) {
+    o.create(HTTP_TYPE_RESPONSE);
+    o.value_set("X-Other", 7, "not interned either", 19);
+    hit.m_heap->inherit_string_heaps(o.m_heap);
+  }
+  tb.check(hit.m_heap->m_ronly_heap[HDR_BUF_RONLY_HEAPS - 1].m_heap_start != nullptr, "Checking that every slot is taken");
+  hit.copy(&cached);
+  v = hit.value_get("X-Test", 6, &len);
+  tb.check(len == 12 && cached.m_heap->m_read_write_heap->contains(v), "Checking that a full heap still shares the source");
+
+  for (auto &o : other) {
+    o.destroy();
+  }
+  hit.destroy();
+  cached.destroy();
+}
 #endif
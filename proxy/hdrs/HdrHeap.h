@@ -158,6 +158,10 @@ public:
   }
 };
 
+// Process wide, never freed string heap holding the interned header
+//  values.  See HdrHeap::intern_str()
+extern HdrStrHeap *hdr_intern_str_heap;
+
 struct StrHeapDesc {
   StrHeapDesc();
   Ptr<RefCountObj> m_ref_count_ptr;
@@ -188,6 +192,7 @@ public:
   char *allocate_str(int nbytes);
   char *expand_str(const char *old_str, int old_len, int new_len);
   char *duplicate_str(const char *str, int nbytes);
+  const char *intern_str(const char *str, int nbytes);
   void free_string(const char *s, int len);
 
   // Marshalling
@@ -200,6 +205,7 @@ public:
   // One option - overload marshal_length to return this value if @a magic is HDR_BUF_MAGIC_MARSHALED.
 
   void inherit_string_heaps(const HdrHeap *inherit_from);
+  void compact_str_heaps();
   int attach_block(IOBufferBlock *b, const char *use_start);
   void set_ronly_str_heap_end(int slot, const char *end);
 
@@ -266,6 +272,7 @@ public:
   void evacuate_from_str_heaps(HdrStrHeap *new_heap);
   size_t required_space_for_evacuation();
   bool attach_str_heap(char *h_start, int h_len, RefCountObj *h_ref_obj, int *index);
+  bool has_ronly_str_heap(const char *h_start) const;
 
   /** Struct to prevent garbage collection on heaps.
       This bumps the reference count to the heap containing the pointer
@@ -305,7 +312,8 @@ public:
 inline void
 HdrHeap::free_string(const char *s, int len)
 {
-  if (s && len > 0) {
+  // Interned strings are shared by every heap, dropping one loses no space
+  if (s && len > 0 && !(hdr_intern_str_heap && hdr_intern_str_heap->contains(s))) {
     m_lost_string_space += len;
   }
 }
@@ -478,6 +486,7 @@ HdrHeapSDKHandle::set(const HdrHeapSDKHandle *from)
 }
 
 inkcoreapi HdrHeap *new_HdrHeap(int size = HDR_HEAP_DEFAULT_SIZE);
+void hdr_heap_intern_init();
 
 void hdr_heap_test();
 #endif
@@ -653,6 +653,7 @@ mime_init()
     init = 0;
 
     hdrtoken_init();
+    hdr_heap_intern_init();
     day_names_dfa = new DFA;
     day_names_dfa->compile(day_names, SIZEOF(day_names), RE_CASE_INSENSITIVE);
 
@@ -2117,7 +2118,8 @@ mime_field_value_set(HdrHeap *heap, MIMEHdrImpl *mh, MIMEField *field, const cha
   heap->free_string(field->m_ptr_value, field->m_len_value);
 
   if (must_copy_string && value) {
-    field->m_ptr_value = heap->duplicate_str(value, length);
+    const char *interned = heap->intern_str(value, length);
+    field->m_ptr_value   = interned ? interned : heap->duplicate_str(value, length);
   } else {
     field->m_ptr_value = value;
   }
@@ -29,6 +29,7 @@
 #include "HdrHeap.h"
 #include "ts/INK_MD5.h"
 #include "ts/MMH.h"
+#include "ts/Murmur3.h"
 #include "MIME.h"
 #include "ts/TsBuffer.h"
 
@@ -76,7 +77,11 @@ struct URLImpl : public HdrHeapObjImpl {
   // 6 bytes
 
   uint32_t m_clean : 1;
-  // 8 bytes + 1 bit, will result in padding
+  // Bumped whenever a component changes, so a user can tell whether the URL is
+  // still the one it looked at. It lives in what was padding, so it is narrow,
+  // which is enough to tell a URL from its own recent past.
+  uint32_t m_generation : 15;
+  // 8 bytes + 16 bits, will result in padding
 
   // Marshaling Functions
   int marshal(MarshalXlate *str_xlate, int num_xlate);
@@ -105,6 +110,7 @@ public:
     UNSPECIFIED,
     MD5,
     MMH,
+    MURMUR3,
   }; ///< What type of hash we really are.
   static HashType Setting;
 
@@ -34,6 +34,8 @@
 #include "HttpSM.h"
 #include "HttpDebugNames.h"
 
+#include <unordered_map>
+
 #define SM_REMEMBER(sm, e, r)                          \
   {                                                    \
     sm->history.push_back(MakeSourceLocation(), e, r); \
@@ -45,6 +47,43 @@
     Debug("http_cache", "[%" PRId64 "] [%s, %s]", master_sm->sm_id, #state_name, HttpDebugNames::get_event_name(event)); \
   }
 
+namespace
+{
+struct CollapseHash {
+  size_t
+  operator()(const CryptoHash &h) const
+  {
+    return h.fold();
+  }
+};
+
+// A key some HttpCacheSM holds the write lock for, and the SMs that got
+// ECACHE_DOC_BUSY on it and are waiting to be told to retry the read.
+struct CollapseEntry {
+  HttpCacheSM *writer = nullptr;
+  DLL<HttpCacheSM, HttpCacheSM::Link_collapse_link> waiters;
+};
+
+// The table is split by key so that open_write and close on unrelated
+// objects don't serialize on one lock, like HttpSMList is by sm_id.
+const int COLLAPSE_BUCKETS = 61;
+
+struct CollapseBucket {
+  CollapseBucket() { ink_mutex_init(&mutex); }
+  ink_mutex mutex;
+  std::unordered_map<CryptoHash, CollapseEntry, CollapseHash> table;
+};
+
+CollapseBucket collapse_buckets[COLLAPSE_BUCKETS];
+
+inline CollapseBucket &
+collapse_bucket(const CryptoHash &key)
+{
+  // fold() is what the bucket's map hashes on, use other bits here
+  return collapse_buckets[key.u32[3] % COLLAPSE_BUCKETS];
+}
+}
+
 HttpCacheAction::HttpCacheAction() : sm(nullptr)
 {
 }
@@ -56,6 +95,7 @@ HttpCacheAction::cancel(Continuation *c)
   ink_assert(this->cancelled == 0);
 
   this->cancelled = 1;
+  sm->collapse_leave(nullptr);
   if (sm->pending_action) {
     sm->pending_action->cancel();
   }
@@ -81,7 +121,13 @@ HttpCacheSM::HttpCacheSM()
     open_write_tries(0),
     lookup_url(nullptr),
     lookup_max_recursive(0),
-    current_lookup_level(0)
+    current_lookup_level(0),
+    collapse_writer(false),
+    collapse_pending(false),
+    collapse_waiting(false),
+    collapse_thread(nullptr),
+    collapse_wake(nullptr),
+    collapse_timeout(nullptr)
 {
 }
 
@@ -109,7 +155,9 @@ HttpCacheSM::HttpCacheSM()
 //     decided to retry the open read. we scheduled the event
 //     processor to call us back after n msecs so that we can
 //     reissue the open_read. this is the call from the event
-//     processor.
+//     processor. if the writer is another HttpCacheSM we
+//     instead waited on it, and this is either the writer
+//     waking us up or the fallback timeout.
 //
 //////////////////////////////////////////////////////////////////////////
 int
@@ -138,7 +186,9 @@ HttpCacheSM::state_cache_open_read(int event, void *data)
       if (open_read_tries <= master_sm->t_state.txn_conf->max_cache_open_read_retries) {
         // Retry to read; maybe the update finishes in time
         open_read_cb = false;
-        do_schedule_in();
+        if (!collapse_wait(cache_key.hash)) {
+          do_schedule_in();
+        }
       } else {
         // Give up; the update didn't finish in time
         // HttpSM will inform HttpTransact to 'proxy-only'
@@ -161,6 +211,11 @@ HttpCacheSM::state_cache_open_read(int event, void *data)
                         "retrying cache open read...",
           master_sm->sm_id, open_read_tries);
 
+    if (collapse_leave(static_cast<Event *>(data))) {
+      // The writer is taking longer than our whole retry budget, this
+      // is the last attempt before going to origin.
+      open_read_tries = master_sm->t_state.txn_conf->max_cache_open_read_retries;
+    }
     do_cache_open_read(cache_key);
     break;
 
@@ -184,11 +239,15 @@ HttpCacheSM::state_cache_open_write(int event, void *data)
     ink_assert(cache_write_vc == nullptr);
     cache_write_vc = (CacheVConnection *)data;
     open_write_cb  = true;
+    collapse_register(cache_key.hash);
     master_sm->handleEvent(event, data);
     break;
 
   case CACHE_EVENT_OPEN_WRITE_FAILED:
-    if (open_write_tries <= master_sm->t_state.txn_conf->max_cache_open_write_retries) {
+    // A rejection by the admission filter is final, and retrying would count
+    // the request again.
+    if ((intptr_t)data != -ECACHE_NOT_ADMITTED &&
+        open_write_tries <= master_sm->t_state.txn_conf->max_cache_open_write_retries) {
       // Retry open write;
       open_write_cb = false;
       do_schedule_in();
@@ -238,6 +297,124 @@ HttpCacheSM::do_schedule_in()
   return;
 }
 
+void
+HttpCacheSM::collapse_register(const CryptoHash &key)
+{
+  if (collapse_writer) {
+    if (collapse_key == key) {
+      return;
+    }
+    collapse_wake_waiters();
+  }
+
+  CollapseBucket &bucket = collapse_bucket(key);
+  ink_scoped_mutex_lock lock(bucket.mutex);
+  auto r = bucket.table.emplace(key, CollapseEntry());
+
+  // With multiple writers allowed only the first one is waited on
+  if (r.second) {
+    r.first->second.writer = this;
+    collapse_writer        = true;
+    collapse_key           = key;
+  }
+}
+
+void
+HttpCacheSM::collapse_wake_waiters()
+{
+  CollapseBucket &bucket = collapse_bucket(collapse_key);
+  ink_scoped_mutex_lock lock(bucket.mutex);
+  auto spot = bucket.table.find(collapse_key);
+  HttpCacheSM *waiter;
+
+  ink_assert(spot != bucket.table.end() && spot->second.writer == this);
+  collapse_writer = false;
+  while ((waiter = spot->second.waiters.pop()) != nullptr) {
+    // The waiter can't run its handler until we drop the bucket lock, so
+    // it always sees collapse_wake set.
+    waiter->collapse_waiting = false;
+    waiter->collapse_wake    = waiter->collapse_thread->schedule_imm(waiter, EVENT_INTERVAL);
+    HTTP_INCREMENT_DYN_STAT(http_cache_collapsed_wakeups_stat);
+  }
+  bucket.table.erase(spot);
+}
+
+//////////////////////////////////////////////////////////////////////////
+//
+//  HttpCacheSM::collapse_wait()
+//
+//  The read found the document locked by a writer. If that writer is
+//  another HttpCacheSM, park on it: it schedules EVENT_INTERVAL to us as
+//  soon as it has written the headers or given up, so we retry exactly
+//  once instead of every cache_open_read_retry_time ms. A timeout for
+//  the rest of the retry budget covers writers that are not HttpCacheSMs
+//  or that take longer than we would have polled. Returns false if there
+//  is nobody to wait on and the caller should poll as before.
+//
+//////////////////////////////////////////////////////////////////////////
+bool
+HttpCacheSM::collapse_wait(const CryptoHash &key)
+{
+  ink_assert(!collapse_pending);
+  {
+    CollapseBucket &bucket = collapse_bucket(key);
+    ink_scoped_mutex_lock lock(bucket.mutex);
+    auto spot = bucket.table.find(key);
+
+    if (spot == bucket.table.end() || spot->second.writer == this) {
+      return false;
+    }
+    spot->second.waiters.push(this);
+    collapse_key     = key;
+    collapse_thread  = mutex->thread_holding;
+    collapse_wake    = nullptr;
+    collapse_waiting = true;
+  }
+
+  int retries      = master_sm->t_state.txn_conf->max_cache_open_read_retries - open_read_tries + 1;
+  collapse_pending = true;
+  collapse_timeout = mutex->thread_holding->schedule_in(
+    this, HRTIME_MSECONDS(std::max(retries, 1) * master_sm->t_state.txn_conf->cache_open_read_retry_time));
+  HTTP_INCREMENT_DYN_STAT(http_cache_collapsed_waits_stat);
+
+  return true;
+}
+
+bool
+HttpCacheSM::collapse_leave(Event *e)
+{
+  bool timed_out = false;
+
+  if (!collapse_pending) {
+    return false;
+  }
+  collapse_pending = false;
+
+  if (collapse_timeout == e) {
+    timed_out = true;
+    HTTP_INCREMENT_DYN_STAT(http_cache_collapsed_timeouts_stat);
+  } else {
+    collapse_timeout->cancel();
+  }
+  collapse_timeout = nullptr;
+
+  CollapseBucket &bucket = collapse_bucket(collapse_key);
+  ink_scoped_mutex_lock lock(bucket.mutex);
+  if (collapse_waiting) {
+    auto spot = bucket.table.find(collapse_key);
+
+    ink_assert(spot != bucket.table.end());
+    spot->second.waiters.remove(this);
+    collapse_waiting = false;
+  }
+  if (collapse_wake && collapse_wake != e) {
+    collapse_wake->cancel();
+  }
+  collapse_wake = nullptr;
+
+  return timed_out;
+}
+
 Action *
 HttpCacheSM::do_cache_open_read(const HttpCacheKey &key)
 {
@@ -357,3 +534,70 @@ HttpCacheSM::open_write(const HttpCacheKey *key, URL *url, HTTPHdr *request, Cac
     return &captive_action;
   }
 }
+
+#if TS_HAS_TESTS
+#include "ts/TestBox.h"
+
+static void
+collapse_test_sm(HttpSM *sm, HttpCacheSM *cache_sm)
+{
+  sm->init();
+  sm->mutex = new_ProxyMutex();
+  cache_sm->init(sm, sm->mutex);
+}
+
+REGRESSION_TEST(HttpCacheSM_collapse)(RegressionTest *t, int /* level */, int *pstatus)
+{
+  TestBox box(t, pstatus);
+  EThread *ethread = this_ethread();
+  HttpSM writer_sm, reader_sm;
+  HttpCacheSM writer, reader;
+  CryptoHash key, other_key;
+
+  box = REGRESSION_TEST_PASSED;
+
+  collapse_test_sm(&writer_sm, &writer);
+  collapse_test_sm(&reader_sm, &reader);
+  key.u64[0]       = 0x0123456789abcdefULL;
+  key.u64[1]       = 0xfedcba9876543210ULL;
+  other_key.u64[0] = key.u64[0];
+  other_key.u64[1] = key.u64[1] + 1;
+
+  SCOPED_MUTEX_LOCK(writer_lock, writer_sm.mutex, ethread);
+  SCOPED_MUTEX_LOCK(reader_lock, reader_sm.mutex, ethread);
+
+  box.check(!reader.collapse_wait(key), "waited without a writer");
+
+  writer.collapse_register(key);
+  box.check(writer.collapse_writer, "writer not registered");
+  box.check(!writer.collapse_wait(key), "writer waited on itself");
+  box.check(!reader.collapse_wait(other_key), "waited on a different key");
+
+  // Wait, then wake from the writer
+  box.check(reader.collapse_wait(key), "did not wait on the writer");
+  box.check(reader.collapse_waiting && reader.collapse_timeout != nullptr, "waiter not parked");
+  writer.collapse_release();
+  box.check(!writer.collapse_writer, "writer still registered after release");
+  box.check(!reader.collapse_waiting && reader.collapse_wake != nullptr, "waiter not woken");
+  box.check(!reader.collapse_leave(nullptr), "wake reported as timeout");
+  box.check(reader.collapse_wake == nullptr && reader.collapse_timeout == nullptr, "events left after leaving");
+  box.check(!reader.collapse_wait(key), "key still locked after release");
+
+  // Cancel, the writer must not wake us afterwards
+  writer.collapse_register(key);
+  box.check(reader.collapse_wait(key), "did not wait on the writer again");
+  box.check(!reader.collapse_leave(nullptr), "cancel reported as timeout");
+  box.check(!reader.collapse_waiting && !reader.collapse_pending, "waiter still parked after cancel");
+  writer.collapse_release();
+  box.check(reader.collapse_wake == nullptr, "cancelled waiter was woken");
+
+  // Timeout, the writer never releases in time
+  writer.collapse_register(key);
+  box.check(reader.collapse_wait(key), "did not wait on the writer a third time");
+  Event *timeout = reader.collapse_timeout;
+  box.check(reader.collapse_leave(timeout), "timeout not reported");
+  timeout->cancel();
+  writer.collapse_release();
+  box.check(reader.collapse_wake == nullptr, "timed out waiter was woken");
+}
+#endif
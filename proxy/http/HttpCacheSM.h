@@ -38,6 +38,7 @@
 #include "URL.h"
 #include "HTTP.h"
 #include "HttpConfig.h"
+#include "ts/Regression.h"
 
 class HttpSM;
 class HttpCacheSM;
@@ -150,6 +151,7 @@ public:
   inline void
   abort_write()
   {
+    collapse_release();
     if (cache_write_vc) {
       HTTP_DECREMENT_DYN_STAT(http_current_cache_connections_stat);
       cache_write_vc->do_io_close(); // abort
@@ -159,6 +161,7 @@ public:
   inline void
   close_write()
   {
+    collapse_release();
     if (cache_write_vc) {
       HTTP_DECREMENT_DYN_STAT(http_current_cache_connections_stat);
       cache_write_vc->do_io_close();
@@ -181,10 +184,34 @@ public:
     //   records its stats
     close_read();
     abort_write();
+    collapse_leave(nullptr);
   }
 
+  // Wake every state machine parked on our write lock, called once the
+  // object is readable (or will never be) so they can retry the open read.
+  void
+  collapse_release()
+  {
+    if (collapse_writer) {
+      collapse_wake_waiters();
+    }
+  }
+
+  // Stop waiting on another SM's write lock. e is the event being handled,
+  // if any, returns true if that was the fallback timeout.
+  bool collapse_leave(Event *e);
+
+  // Request coalescing: while this SM holds the write lock for a key, other
+  // SMs getting ECACHE_DOC_BUSY for it wait here instead of polling.
+  LINK(HttpCacheSM, collapse_link);
+
+  friend void RegressionTest_HttpCacheSM_collapse(RegressionTest *, int, int *);
+
 private:
   void do_schedule_in();
+  void collapse_register(const CryptoHash &key);
+  bool collapse_wait(const CryptoHash &key);
+  void collapse_wake_waiters();
   Action *do_cache_open_read(const HttpCacheKey &);
 
   int state_cache_open_read(int event, void *data);
@@ -211,6 +238,15 @@ private:
   // to keep track of multiple cache lookups
   int lookup_max_recursive;
   int current_lookup_level;
+
+  // Request coalescing state, see collapse_wait()
+  bool collapse_writer;  // we own the collapse table entry for collapse_key
+  bool collapse_pending; // we are waiting on another writer
+  bool collapse_waiting; // still on the writer's waiter list (bucket lock)
+  CryptoHash collapse_key;
+  EThread *collapse_thread;
+  Event *collapse_wake;    // writer's wake up (bucket lock)
+  Event *collapse_timeout; // fallback if the writer never wakes us
 };
 
 #endif
@@ -49,6 +49,7 @@
   REC_RegisterConfigUpdateFunc(_n, http_config_cb, NULL)
 
 RecRawStatBlock *http_rsb;
+RecHistogramBlock *http_rhb;
 #define HTTP_CLEAR_DYN_STAT(x)          \
   do {                                  \
     RecSetRawStatSum(http_rsb, x, 0);   \
@@ -491,6 +492,13 @@ register_stat_callbacks()
   RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.cache_read_error", RECD_COUNTER, RECP_PERSISTENT,
                      (int)http_cache_read_error_stat, RecRawStatSyncCount);
 
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.cache_collapsed_waits", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_cache_collapsed_waits_stat, RecRawStatSyncCount);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.cache_collapsed_wakeups", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_cache_collapsed_wakeups_stat, RecRawStatSyncCount);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.cache_collapsed_timeouts", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_cache_collapsed_timeouts_stat, RecRawStatSyncCount);
+
   /////////////////////////////////////////
   // Bandwidth Savings Transaction Stats //
   /////////////////////////////////////////
@@ -862,6 +870,15 @@ register_stat_callbacks()
                      (int)http_sm_start_time_stat, RecRawStatSyncSum);
   RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.milestone.sm_finish", RECD_COUNTER, RECP_PERSISTENT,
                      (int)http_sm_finish_time_stat, RecRawStatSyncSum);
+
+  // Latency histograms, in microseconds
+  if (http_rhb) {
+    RecRegisterHistogram(http_rhb, RECT_PROCESS, "proxy.process.http.latency.ttfb", (int)http_ttfb_histogram);
+    RecRegisterHistogram(http_rhb, RECT_PROCESS, "proxy.process.http.latency.origin_connect", (int)http_origin_connect_histogram);
+    RecRegisterHistogram(http_rhb, RECT_PROCESS, "proxy.process.http.latency.cache_lookup", (int)http_cache_lookup_histogram);
+    RecRegisterHistogram(http_rhb, RECT_PROCESS, "proxy.process.http.latency.total_transaction",
+                         (int)http_total_transaction_histogram);
+  }
 }
 
 ////////////////////////////////////////////////////////////////
@@ -873,6 +890,7 @@ void
 HttpConfig::startup()
 {
   http_rsb = RecAllocateRawStatBlock((int)http_stat_count);
+  http_rhb = RecAllocateHistogramBlock((int)http_histogram_count);
   register_stat_callbacks();
 
   HttpConfigParams &c = m_master;
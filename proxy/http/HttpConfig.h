@@ -179,6 +179,9 @@ enum {
   http_cache_miss_uncacheable_stat,
   http_cache_miss_ims_stat,
   http_cache_read_error_stat,
+  http_cache_collapsed_waits_stat,
+  http_cache_collapsed_wakeups_stat,
+  http_cache_collapsed_timeouts_stat,
 
   // bandwidth savings stats
   http_tcp_hit_count_stat,
@@ -319,7 +322,17 @@ enum {
   http_stat_count
 };
 
+enum {
+  http_ttfb_histogram,
+  http_origin_connect_histogram,
+  http_cache_lookup_histogram,
+  http_total_transaction_histogram,
+
+  http_histogram_count
+};
+
 extern RecRawStatBlock *http_rsb;
+extern RecHistogramBlock *http_rhb;
 
 /* Stats should only be accessed using these macros */
 #define HTTP_INCREMENT_DYN_STAT(x) RecIncrRawStat(http_rsb, this_ethread(), (int)x, 1)
@@ -336,6 +349,8 @@ extern RecRawStatBlock *http_rsb;
 #define HTTP_READ_DYN_SUM(x, S) RecGetRawStatSum(http_rsb, (int)x, &S) // This aggregates threads too
 #define HTTP_READ_GLOBAL_DYN_SUM(x, S) RecGetGlobalRawStatSum(http_rsb, (int)x, &S)
 
+#define HTTP_HISTOGRAM_RECORD(x, y) RecHistogramRecord(http_rhb, this_ethread(), (int)x, (int64_t)y)
+
 /////////////////////////////////////////////////////////////
 //
 // struct HttpConfigPortRange
@@ -2351,6 +2351,14 @@ HttpSM::state_cache_open_write(int event, void *data)
       t_state.cache_info.write_lock_state  = HttpTransact::CACHE_WL_FAIL;
       break;
     }
+    // Not admitted to the cache: nobody else holds the lock, just go to the
+    // origin without writing, whatever the fail action says.
+    if ((intptr_t)data == -ECACHE_NOT_ADMITTED) {
+      DebugSM("http", "[%" PRId64 "] cache write not admitted", sm_id);
+      t_state.cache_open_write_fail_action = HttpTransact::CACHE_WL_FAIL_ACTION_DEFAULT;
+      t_state.cache_info.write_lock_state  = HttpTransact::CACHE_WL_FAIL;
+      break;
+    }
     if (t_state.txn_conf->cache_open_write_fail_action == HttpTransact::CACHE_WL_FAIL_ACTION_DEFAULT) {
       t_state.cache_info.write_lock_state = HttpTransact::CACHE_WL_FAIL;
       break;
@@ -5744,6 +5752,8 @@ HttpSM::perform_cache_write_action()
       ink_assert(transform_cache_sm.cache_write_vc == nullptr);
       transform_cache_sm.cache_write_vc = cache_sm.cache_write_vc;
       cache_sm.cache_write_vc           = nullptr;
+      // Anybody waiting on our write lock goes back to polling
+      cache_sm.collapse_release();
     }
     break;
 
@@ -6098,6 +6108,8 @@ HttpSM::setup_cache_write_transfer(HttpCacheSM *c_sm, VConnection *source_vc, HT
 
   c_sm->cache_write_vc->set_http_info(store_info);
   store_info->clear();
+  // The headers are in, readers can now join as read-while-write
+  c_sm->collapse_release();
 
   tunnel.add_consumer(c_sm->cache_write_vc, source_vc, &HttpSM::tunnel_handler_cache_write, HT_CACHE_WRITE, name, skip_bytes);
 
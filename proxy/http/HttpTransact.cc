@@ -8655,6 +8655,23 @@ HttpTransact::update_size_and_time_stats(State *s, ink_hrtime total_time, ink_hr
   HTTP_SUM_DYN_STAT(http_dns_lookup_end_time_stat, milestones.difference_msec(TS_MILESTONE_SM_START, TS_MILESTONE_DNS_LOOKUP_END));
   HTTP_SUM_DYN_STAT(http_sm_start_time_stat, milestones.difference_msec(TS_MILESTONE_SM_START, TS_MILESTONE_SM_START));
   HTTP_SUM_DYN_STAT(http_sm_finish_time_stat, milestones.difference_msec(TS_MILESTONE_SM_START, TS_MILESTONE_SM_FINISH));
+
+  // update latency histograms, only for the phases this transaction went through
+  if (http_rhb) {
+    if (milestones[TS_MILESTONE_UA_BEGIN_WRITE]) {
+      HTTP_HISTOGRAM_RECORD(http_ttfb_histogram,
+                            ink_hrtime_to_usec(milestones.elapsed(TS_MILESTONE_SM_START, TS_MILESTONE_UA_BEGIN_WRITE)));
+    }
+    if (milestones[TS_MILESTONE_SERVER_CONNECT] && milestones[TS_MILESTONE_SERVER_CONNECT_END]) {
+      HTTP_HISTOGRAM_RECORD(http_origin_connect_histogram,
+                            ink_hrtime_to_usec(milestones.elapsed(TS_MILESTONE_SERVER_CONNECT, TS_MILESTONE_SERVER_CONNECT_END)));
+    }
+    if (milestones[TS_MILESTONE_CACHE_OPEN_READ_BEGIN] && milestones[TS_MILESTONE_CACHE_OPEN_READ_END]) {
+      HTTP_HISTOGRAM_RECORD(http_cache_lookup_histogram, ink_hrtime_to_usec(milestones.elapsed(TS_MILESTONE_CACHE_OPEN_READ_BEGIN,
+                                                                                                TS_MILESTONE_CACHE_OPEN_READ_END)));
+    }
+    HTTP_HISTOGRAM_RECORD(http_total_transaction_histogram, ink_hrtime_to_usec(total_time));
+  }
 }
 
 void
@@ -952,6 +952,7 @@ public:
         pCongestionEntry->put(), pCongestionEntry = NULL;
       }
 
+      request_data.clear_match_string();
       url_map.clear();
       arena.reset();
       unmapped_url.clear();
@@ -30,6 +30,7 @@
 #include "HTTP.h"
 #include "HttpCompat.h"
 #include "ts/InkErrno.h"
+#include "ts/HashFNV.h"
 
 /**
   Find the pointer and length of an etag, after stripping off any leading
@@ -194,6 +195,10 @@ HttpTransactCache::SelectFromAlternates(CacheHTTPInfoVector *cache_vector, HTTPH
     return 0;
   }
 
+  if (alt_count > 1 && (best_index = SelectExactAlternate(cache_vector, client_request, http_config_params)) >= 0) {
+    return best_index;
+  }
+
   for (int i = 0; i < alt_count; i++) {
     float Q;
     CacheHTTPInfo *obj       = cache_vector->get(i);
@@ -268,6 +273,128 @@ HttpTransactCache::SelectFromAlternates(CacheHTTPInfoVector *cache_vector, HTTPH
   }
 }
 
+/**
+  Find the alternate stored for a request with the same selecting fields
+  as client_request, without scoring the others.
+
+  Alternates keep a signature of the request they were written for (see
+  calculate_vary_signature), so this is one pass of integer compares over
+  the vector. The signature of client_request is taken against the Vary of
+  the first alternate that has one, an object whose alternates disagree on
+  Vary only matches those that agree with that one. Of several alternates
+  with the signature the most recently received wins, and it still has to
+  pass calculate_quality_of_match so nothing the full scoring would refuse
+  is served.
+
+  Plugins on the select alternate hook see every alternate, PURGE takes any
+  of them, and the default Vary headers select on fields the signature
+  doesn't cover, so in those cases this always misses.
+
+  @return index in cache alternates vector, or -1 to score them all.
+
+*/
+int
+HttpTransactCache::SelectExactAlternate(CacheHTTPInfoVector *cache_vector, HTTPHdr *client_request,
+                                        OverridableHttpConfigParams *http_config_params)
+{
+  uint32_t signature = HTTPCacheAlt::NO_VARY_SIGNATURE;
+  time_t best_time   = 0;
+  int best_index     = -1;
+
+  if (http_config_params->cache_enable_default_vary_headers || client_request->method_get_wksidx() == HTTP_WKSIDX_PURGE ||
+      http_global_hooks->get(TS_HTTP_SELECT_ALT_HOOK)) {
+    return -1;
+  }
+
+  for (int i = 0; i < cache_vector->count(); i++) {
+    CacheHTTPInfo *obj = cache_vector->get(i);
+
+    if (obj->vary_signature_get() == HTTPCacheAlt::NO_VARY_SIGNATURE || obj->object_key_get() == zero_key) {
+      continue;
+    }
+    if (signature == HTTPCacheAlt::NO_VARY_SIGNATURE) {
+      signature = calculate_vary_signature(client_request, obj->response_get());
+    }
+    if (obj->vary_signature_get() == signature && (best_index < 0 || obj->response_received_time_get() >= best_time)) {
+      best_time  = obj->response_received_time_get();
+      best_index = i;
+    }
+  }
+
+  if (best_index >= 0) {
+    CacheHTTPInfo *obj = cache_vector->get(best_index);
+    if (calculate_quality_of_match(http_config_params, client_request, obj->request_get(), obj->response_get()) > 0.0) {
+      Debug("http_match", "[SelectExactAlternate] alternate # %d matches by signature %08x", best_index, signature);
+      return best_index;
+    }
+  }
+  return -1;
+}
+
+// Field presence and values in request, so that a missing field differs
+// from an empty one.
+static void
+vary_signature_update(ATSHash32FNV1a &hash, HTTPHdr *request, const char *name, int name_len)
+{
+  MIMEField *field = request->field_find(name, name_len);
+  uint8_t present  = field != nullptr;
+
+  hash.update(&present, sizeof(present));
+  for (; field != nullptr; field = field->m_next_dup) {
+    int len;
+    const char *value = field->value_get(&len);
+    hash.update(value, len, ATSHash::nocase());
+    hash.update(",", 1);
+  }
+}
+
+/**
+  Hash of the fields of request that select among alternates: the Accept
+  fields, which calculate_quality_of_match looks at, and the fields named
+  by the Vary of response. Values are compared as they were received
+  (ignoring case only), so two requests with the same signature almost
+  always match each other exactly, while equivalent requests spelled
+  differently just don't share one.
+
+  A request for an alternate is hashed against that alternate's response
+  when it is written, and a client request against a cached response when
+  it is looked up.
+
+  @return the signature, or HTTPCacheAlt::NO_VARY_SIGNATURE if response
+  has Vary: *.
+
+*/
+uint32_t
+HttpTransactCache::calculate_vary_signature(HTTPHdr *request, HTTPHdr *response)
+{
+  ATSHash32FNV1a hash;
+
+  vary_signature_update(hash, request, MIME_FIELD_ACCEPT, MIME_LEN_ACCEPT);
+  vary_signature_update(hash, request, MIME_FIELD_ACCEPT_CHARSET, MIME_LEN_ACCEPT_CHARSET);
+  vary_signature_update(hash, request, MIME_FIELD_ACCEPT_ENCODING, MIME_LEN_ACCEPT_ENCODING);
+  vary_signature_update(hash, request, MIME_FIELD_ACCEPT_LANGUAGE, MIME_LEN_ACCEPT_LANGUAGE);
+
+  if (response->presence(MIME_PRESENCE_VARY)) {
+    StrList vary_list;
+    response->value_get_comma_list(MIME_FIELD_VARY, MIME_LEN_VARY, &vary_list);
+
+    for (Str *field = vary_list.head; field != nullptr; field = field->next) {
+      if (field->len == 0) {
+        continue;
+      }
+      if (field->str[0] == '*' && field->len == 1) {
+        return HTTPCacheAlt::NO_VARY_SIGNATURE;
+      }
+      const char *name = hdrtoken_string_to_wks(field->str, field->len);
+      vary_signature_update(hash, request, name ? name : field->str, field->len);
+    }
+  }
+
+  hash.final();
+  // Keep the reserved value for alternates that can't be matched.
+  return hash.get() == HTTPCacheAlt::NO_VARY_SIGNATURE ? 0 : hash.get();
+}
+
 /**
   For cached req/res and incoming req, return quality of match.
 
@@ -60,6 +60,11 @@ public:
   static int SelectFromAlternates(CacheHTTPInfoVector *cache_vector_data, HTTPHdr *client_request,
                                   OverridableHttpConfigParams *cache_lookup_http_config_params);
 
+  static int SelectExactAlternate(CacheHTTPInfoVector *cache_vector_data, HTTPHdr *client_request,
+                                  OverridableHttpConfigParams *cache_lookup_http_config_params);
+
+  static uint32_t calculate_vary_signature(HTTPHdr *request, HTTPHdr *response);
+
   static float calculate_quality_of_match(OverridableHttpConfigParams *http_config_params, HTTPHdr *client_request,
                                           HTTPHdr *obj_client_request, HTTPHdr *obj_origin_server_response);
 
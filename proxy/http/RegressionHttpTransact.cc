@@ -22,8 +22,10 @@
  */
 
 #include "ts/Regression.h"
+#include "ts/TestBox.h"
 #include "HttpTransact.h"
 #include "HttpSM.h"
+#include "P_CacheHttp.h"
 
 void
 forceLinkRegressionHttpTransact()
@@ -136,3 +138,149 @@ REGRESSION_TEST(HttpTransact_handle_request)(RegressionTest * /* t */, int /* le
   // To be added..
   *pstatus = REGRESSION_TEST_PASSED;
 }
+
+static void
+parse_hdr(HTTPHdr *hdr, HTTPType type, const char *text)
+{
+  HTTPParser parser;
+  const char *start = text;
+
+  hdr->create(type);
+  http_parser_init(&parser);
+  if (type == HTTP_TYPE_REQUEST) {
+    hdr->parse_req(&parser, &start, text + strlen(text), true);
+  } else {
+    hdr->parse_resp(&parser, &start, text + strlen(text), true);
+  }
+  http_parser_clear(&parser);
+}
+
+static uint32_t
+vary_signature(const char *request, const char *response)
+{
+  HTTPHdr req, resp;
+  uint32_t signature;
+
+  parse_hdr(&req, HTTP_TYPE_REQUEST, request);
+  parse_hdr(&resp, HTTP_TYPE_RESPONSE, response);
+  signature = HttpTransactCache::calculate_vary_signature(&req, &resp);
+  req.destroy();
+  resp.destroy();
+  return signature;
+}
+
+// Adds an alternate written for request, signed the way the cache signs it.
+static void
+add_alternate(CacheHTTPInfoVector *vector, const char *request, const char *response, time_t received)
+{
+  CacheHTTPInfo info;
+  HTTPHdr req, resp;
+  INK_MD5 key;
+
+  parse_hdr(&req, HTTP_TYPE_REQUEST, request);
+  parse_hdr(&resp, HTTP_TYPE_RESPONSE, response);
+  info.create();
+  info.request_set(&req);
+  info.response_set(&resp);
+  info.request_sent_time_set(received);
+  info.response_received_time_set(received);
+  key.u64[0] = vector->count() + 1;
+  key.u64[1] = 0;
+  info.object_key_set(key);
+  info.vary_signature_set(HttpTransactCache::calculate_vary_signature(&req, &resp));
+  vector->insert(&info);
+  req.destroy();
+  resp.destroy();
+}
+
+static int
+select_exact(CacheHTTPInfoVector *vector, const char *request)
+{
+  HTTPHdr req;
+  HttpConfigParams *params = HttpConfig::acquire();
+  int index;
+
+  parse_hdr(&req, HTTP_TYPE_REQUEST, request);
+  index = HttpTransactCache::SelectExactAlternate(vector, &req, &params->oride);
+  HttpConfig::release(params);
+  req.destroy();
+  return index;
+}
+
+REGRESSION_TEST(HttpTransactCache_vary_signature)(RegressionTest *t, int /* level */, int *pstatus)
+{
+  TestBox box(t, pstatus);
+  const char *plain = "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\n\r\n";
+  const char *by_ua = "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nVary: User-Agent\r\n\r\n";
+
+  *pstatus = REGRESSION_TEST_PASSED;
+
+  box.check(vary_signature("GET / HTTP/1.1\r\nHost: a.com\r\n\r\n", plain) ==
+              vary_signature("GET /other HTTP/1.1\r\nHost: b.com\r\nCookie: c\r\n\r\n", plain),
+            "fields nothing varies on are ignored");
+  box.check(vary_signature("GET / HTTP/1.1\r\nHost: a.com\r\n\r\n", plain) !=
+              vary_signature("GET / HTTP/1.1\r\nHost: a.com\r\nAccept-Language:\r\n\r\n", plain),
+            "a missing field differs from an empty one");
+  box.check(vary_signature("GET / HTTP/1.1\r\nHost: a.com\r\nUser-Agent:\r\n\r\n", by_ua) !=
+              vary_signature("GET / HTTP/1.1\r\nHost: a.com\r\n\r\n", by_ua),
+            "a missing Vary field differs from an empty one");
+  box.check(vary_signature("GET / HTTP/1.1\r\nHost: a.com\r\nAccept-Encoding: gzip\r\nAccept-Encoding: br\r\n\r\n", plain) ==
+              vary_signature("GET / HTTP/1.1\r\nHost: a.com\r\nAccept-Encoding: gzip,br\r\n\r\n", plain),
+            "duplicate fields hash like their joined value");
+  box.check(vary_signature("GET / HTTP/1.1\r\nHost: a.com\r\nAccept-Encoding: gzip\r\nAccept-Encoding: br\r\n\r\n", plain) !=
+              vary_signature("GET / HTTP/1.1\r\nHost: a.com\r\nAccept-Encoding: gzip\r\n\r\n", plain),
+            "every duplicate is hashed");
+  box.check(vary_signature("GET / HTTP/1.1\r\nHost: a.com\r\nAccept-Encoding: GZIP\r\n\r\n", plain) ==
+              vary_signature("GET / HTTP/1.1\r\nHost: a.com\r\nAccept-Encoding: gzip\r\n\r\n", plain),
+            "values are compared ignoring case");
+  box.check(vary_signature("GET / HTTP/1.1\r\nHost: a.com\r\nUser-Agent: a\r\n\r\n", by_ua) !=
+              vary_signature("GET / HTTP/1.1\r\nHost: a.com\r\nUser-Agent: b\r\n\r\n", by_ua),
+            "fields named by Vary are hashed");
+  box.check(vary_signature("GET / HTTP/1.1\r\nHost: a.com\r\n\r\n", "HTTP/1.1 200 OK\r\nVary: *\r\n\r\n") ==
+              HTTPCacheAlt::NO_VARY_SIGNATURE,
+            "Vary: * has no signature");
+  box.check(vary_signature("GET / HTTP/1.1\r\nHost: a.com\r\n\r\n", "HTTP/1.1 200 OK\r\nVary: User-Agent, *\r\n\r\n") ==
+              HTTPCacheAlt::NO_VARY_SIGNATURE,
+            "Vary: * in a list has no signature");
+
+  CacheHTTPInfoVector vector;
+
+  // Alternates by encoding, the newest of two with the same signature wins.
+  const char *by_ae = "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nVary: Accept-Encoding\r\n\r\n";
+  add_alternate(&vector, "GET / HTTP/1.1\r\nHost: a.com\r\nAccept-Encoding: gzip\r\n\r\n", by_ae, 100);
+  add_alternate(&vector, "GET / HTTP/1.1\r\nHost: a.com\r\n\r\n", by_ae, 100);
+  add_alternate(&vector, "GET / HTTP/1.1\r\nHost: a.com\r\nAccept-Encoding: gzip\r\n\r\n", by_ae, 200);
+  box.check(select_exact(&vector, "GET / HTTP/1.1\r\nHost: a.com\r\nAccept-Encoding: gzip\r\n\r\n") == 2,
+            "the newest alternate with the signature is selected");
+  box.check(select_exact(&vector, "GET / HTTP/1.1\r\nHost: a.com\r\n\r\n") == 1, "a request without the field selects its alternate");
+  box.check(select_exact(&vector, "GET / HTTP/1.1\r\nHost: a.com\r\nAccept-Encoding: br\r\n\r\n") == -1,
+            "an unknown signature falls back to scoring");
+  vector.clear();
+
+  // Vary: * is never matched by signature.
+  add_alternate(&vector, "GET / HTTP/1.1\r\nHost: a.com\r\n\r\n", "HTTP/1.1 200 OK\r\nVary: *\r\n\r\n", 100);
+  add_alternate(&vector, "GET / HTTP/1.1\r\nHost: a.com\r\n\r\n", "HTTP/1.1 200 OK\r\nVary: *\r\n\r\n", 200);
+  box.check(select_exact(&vector, "GET / HTTP/1.1\r\nHost: a.com\r\n\r\n") == -1, "Vary: * alternates are scored");
+  vector.clear();
+
+  // Alternates whose Vary differs, the client is signed against the first.
+  add_alternate(&vector, "GET / HTTP/1.1\r\nHost: a.com\r\nUser-Agent: a\r\n\r\n", by_ua, 100);
+  add_alternate(&vector, "GET / HTTP/1.1\r\nHost: a.com\r\nCookie: c\r\n\r\n",
+                "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nVary: Cookie\r\n\r\n", 100);
+  box.check(select_exact(&vector, "GET / HTTP/1.1\r\nHost: a.com\r\nUser-Agent: a\r\nCookie: c\r\n\r\n") == 0,
+            "an alternate agreeing with the first Vary is matched");
+  box.check(select_exact(&vector, "GET / HTTP/1.1\r\nHost: a.com\r\nUser-Agent: b\r\nCookie: c\r\n\r\n") == -1,
+            "an alternate with another Vary is left to scoring");
+  vector.clear();
+
+  // A signature collision is still refused by calculate_quality_of_match.
+  const char *by_al = "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Language: fr\r\nVary: Accept-Language\r\n\r\n";
+  add_alternate(&vector, "GET / HTTP/1.1\r\nHost: a.com\r\nAccept-Language: fr\r\n\r\n", by_al, 100);
+  add_alternate(&vector, "GET / HTTP/1.1\r\nHost: a.com\r\nAccept-Language: fr\r\n\r\n", by_al, 100);
+  vector.get(0)->vary_signature_set(vary_signature("GET / HTTP/1.1\r\nHost: a.com\r\nAccept-Language: de\r\n\r\n", by_al));
+  box.check(select_exact(&vector, "GET / HTTP/1.1\r\nHost: a.com\r\nAccept-Language: fr\r\n\r\n") == 1,
+            "the genuine alternate is matched");
+  box.check(select_exact(&vector, "GET / HTTP/1.1\r\nHost: a.com\r\nAccept-Language: de\r\n\r\n") == -1,
+            "a colliding signature the match quality rejects is not served");
+  vector.clear();
+}
@@ -42,7 +42,7 @@ UrlMappingPathIndex::Insert(url_mapping *mapping)
   trie = _GetTrie(&(mapping->fromURL), scheme_idx, port);
 
   if (!trie) {
-    trie = new UrlMappingTrie();
+    trie = new UrlMappingTrie(m_arena);
     m_tries.insert(UrlMappingGroup::value_type(UrlMappingTrieKey(scheme_idx, port), trie));
     Debug("UrlMappingPathIndex::Insert", "Created new trie for scheme index, port combo <%d, %d>", scheme_idx, port);
   }
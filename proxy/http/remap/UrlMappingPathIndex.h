@@ -34,7 +34,8 @@
 class UrlMappingPathIndex
 {
 public:
-  UrlMappingPathIndex() {}
+  /// Trie nodes are allocated from @a arena, which must outlive this index.
+  explicit UrlMappingPathIndex(Arena *arena = nullptr) : m_arena(arena) {}
   virtual ~UrlMappingPathIndex();
   bool Insert(url_mapping *mapping);
   url_mapping *Search(URL *request_url, int request_port, bool normal_search = true) const;
@@ -60,6 +61,7 @@ private:
 
   typedef std::map<UrlMappingTrieKey, UrlMappingTrie *> UrlMappingGroup;
   UrlMappingGroup m_tries;
+  Arena *m_arena;
 
   // make copy-constructor and assignment operator private
   // till we properly implement them
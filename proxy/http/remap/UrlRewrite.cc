@@ -591,6 +591,7 @@ UrlRewrite::_addToStore(MappingsStore &store, url_mapping *new_mapping, RegexMap
 
   new_mapping->setRank(count); // Use the mapping rules number count for rank
   if (is_cur_mapping_regex) {
+    reg_map->filter_id = store.regex_filter.add(src_host);
     store.regex_list.enqueue(reg_map);
     retval = true;
   } else {
@@ -702,6 +703,12 @@ UrlRewrite::BuildTable(const char *path)
     return 3;
   }
 
+  forward_mappings.regex_filter.compile();
+  reverse_mappings.regex_filter.compile();
+  permanent_redirects.regex_filter.compile();
+  temporary_redirects.regex_filter.compile();
+  forward_mappings_with_recv_port.regex_filter.compile();
+
   // Destroy unused tables
   if (num_rules_forward == 0) {
     forward_mappings.hash_lookup = ink_hash_table_destroy(forward_mappings.hash_lookup);
@@ -754,7 +761,7 @@ UrlRewrite::TableInsert(InkHashTable *h_table, url_mapping *mapping, const char
       return false;
     }
   } else {
-    ht_contents = new UrlMappingPathIndex();
+    ht_contents = new UrlMappingPathIndex(&_index_arena);
     ink_hash_table_insert(h_table, src_host, ht_contents);
   }
   if (!ht_contents->Insert(mapping)) {
@@ -796,7 +803,7 @@ UrlRewrite::_mappingLookup(MappingsStore &mappings, URL *request_url, int reques
     mapping_container.set(mapping);
     retval = true;
   }
-  if (_regexMappingLookup(mappings.regex_list, request_url, request_port, request_host_lower, request_host_len, rank_ceiling,
+  if (_regexMappingLookup(mappings, request_url, request_port, request_host_lower, request_host_len, rank_ceiling,
                           mapping_container)) {
     Debug("url_rewrite", "Using regex mapping with rank %d", (mapping_container.getMapping())->getRank());
     retval = true;
@@ -853,7 +860,7 @@ lOverFlow:
 }
 
 bool
-UrlRewrite::_regexMappingLookup(RegexMappingList &regex_mappings, URL *request_url, int request_port, const char *request_host,
+UrlRewrite::_regexMappingLookup(MappingsStore &mappings, URL *request_url, int request_port, const char *request_host,
                                 int request_host_len, int rank_ceiling, UrlMappingContainer &mapping_container)
 {
   bool retval = false;
@@ -878,8 +885,11 @@ UrlRewrite::_regexMappingLookup(RegexMappingList &regex_mappings, URL *request_u
     request_scheme_len = hdrtoken_wks_to_length(request_scheme);
   }
 
+  // One pass over the host finds the regexes that can possibly match, only those get executed.
+  RegexPrefilter::Candidates candidates(mappings.regex_filter, request_host, request_host_len);
+
   // Loop over the entire linked list, or until we're satisfied
-  forl_LL(RegexMapping, list_iter, regex_mappings)
+  forl_LL(RegexMapping, list_iter, mappings.regex_list)
   {
     int reg_map_rank = list_iter->url_map->getRank();
 
@@ -907,6 +917,11 @@ UrlRewrite::_regexMappingLookup(RegexMappingList &regex_mappings, URL *request_u
       continue;
     }
 
+    if (!candidates.test(list_iter->filter_id)) {
+      Debug("url_rewrite_regex", "Skipping regex with rank %d as host lacks its required literal", reg_map_rank);
+      continue;
+    }
+
     int matches_info[MAX_REGEX_SUBS * 3];
     bool match_result = list_iter->regular_expression.exec(request_host, request_host_len, matches_info, countof(matches_info));
 
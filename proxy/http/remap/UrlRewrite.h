@@ -28,6 +28,7 @@
 #include "UrlMapping.h"
 #include "HttpTransact.h"
 #include "ts/Regex.h"
+#include "ts/Arena.h"
 
 #define URL_REMAP_FILTER_NONE 0x00000000
 #define URL_REMAP_FILTER_REFERER 0x00000001      /* enable "referer" header validation */
@@ -90,6 +91,9 @@ public:
     int substitution_markers[MAX_REGEX_SUBS];
     int substitution_ids[MAX_REGEX_SUBS];
 
+    // index of the host regex in the store's prefilter
+    int filter_id;
+
     LINK(RegexMapping, link);
   };
 
@@ -98,6 +102,7 @@ public:
   struct MappingsStore {
     InkHashTable *hash_lookup;
     RegexMappingList regex_list;
+    RegexPrefilter regex_filter;
     bool
     empty()
     {
@@ -177,11 +182,12 @@ public:
 
 private:
   bool _valid;
+  Arena _index_arena; ///< Path index nodes for all the stores, released with the table.
 
   bool _mappingLookup(MappingsStore &mappings, URL *request_url, int request_port, const char *request_host, int request_host_len,
                       UrlMappingContainer &mapping_container);
   url_mapping *_tableLookup(InkHashTable *h_table, URL *request_url, int request_port, char *request_host, int request_host_len);
-  bool _regexMappingLookup(RegexMappingList &regex_mappings, URL *request_url, int request_port, const char *request_host,
+  bool _regexMappingLookup(MappingsStore &mappings, URL *request_url, int request_port, const char *request_host,
                            int request_host_len, int rank_ceiling, UrlMappingContainer &mapping_container);
   int _expandSubstitutions(int *matches_info, const RegexMapping *reg_map, const char *matched_string, char *dest_buf,
                            int dest_buf_size);
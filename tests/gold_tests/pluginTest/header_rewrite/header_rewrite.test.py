@@ -51,6 +51,11 @@ ts.Disk.remap_config.AddLine(
 ts.Disk.remap_config.AddLine(
     'map http://www.example.com:8080 http://127.0.0.1:{0}'.format(server.Variables.Port)
 )
+ts.Setup.CopyAs('rules/rule_expand.conf', Test.RunDirectory)
+ts.Disk.remap_config.AddLine(
+    'map http://www.example.org http://127.0.0.1:{0} @plugin=header_rewrite.so @pparam={1}/rule_expand.conf'.format(
+        server.Variables.Port, Test.RunDirectory)
+)
 
 # call localhost straight
 tr = Test.AddTestRun()
@@ -63,4 +68,13 @@ tr.Processes.Default.StartBefore(Test.Processes.ts)
 tr.Processes.Default.Streams.stderr = "gold/header_rewrite-303.gold"
 tr.StillRunningAfter = server
 
+# %<...> is only expanded by the operators that take variables
+tr = Test.AddTestRun()
+tr.Processes.Default.Command = 'curl --proxy 127.0.0.1:{0} "http://www.example.org" -H "Proxy-Connection: keep-alive" --verbose'.format(
+    ts.Variables.port)
+tr.Processes.Default.ReturnCode = 0
+tr.Processes.Default.Streams.stderr = "gold/header_rewrite-expand.gold"
+tr.StillRunningAfter = server
+tr.StillRunningAfter = ts
+
 ts.Streams.All = "gold/header_rewrite-tag.gold"
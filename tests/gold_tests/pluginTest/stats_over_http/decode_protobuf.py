@@ -0,0 +1,64 @@
+'''
+Print the metric families of a delimited Prometheus protobuf stream read from stdin
+'''
+#  Licensed to the Apache Software Foundation (ASF) under one
+#  or more contributor license agreements.  See the NOTICE file
+#  distributed with this work for additional information
+#  regarding copyright ownership.  The ASF licenses this file
+#  to you under the Apache License, Version 2.0 (the
+#  "License"); you may not use this file except in compliance
+#  with the License.  You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+#  Unless required by applicable law or agreed to in writing, software
+#  distributed under the License is distributed on an "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#  See the License for the specific language governing permissions and
+#  limitations under the License.
+
+import struct
+import sys
+
+
+def varint(buf, pos):
+    value = shift = 0
+    while True:
+        b = buf[pos]
+        pos += 1
+        value |= (b & 0x7f) << shift
+        shift += 7
+        if b < 0x80:
+            return value, pos
+
+
+def fields(buf):
+    pos = 0
+    while pos < len(buf):
+        key, pos = varint(buf, pos)
+        wire = key & 7
+        if wire == 0:
+            value, pos = varint(buf, pos)
+        elif wire == 1:
+            value = struct.unpack('<d', buf[pos:pos + 8])[0]
+            pos += 8
+        elif wire == 2:
+            n, pos = varint(buf, pos)
+            value = buf[pos:pos + n]
+            pos += n
+        else:
+            raise ValueError('unexpected wire type {0}'.format(wire))
+        yield key >> 3, value
+
+
+TYPES = {0: 'counter', 1: 'gauge', 3: 'untyped'}
+
+data = sys.stdin.buffer.read()
+pos = 0
+while pos < len(data):
+    n, pos = varint(data, pos)
+    family = dict(fields(data[pos:pos + n]))
+    pos += n
+    metric = dict(fields(family[4]))
+    value = dict(fields(list(metric.values())[0]))[1]
+    print('{0} {1} {2:g}'.format(family[1].decode(), TYPES[family[3]], value))
@@ -0,0 +1,65 @@
+'''
+'''
+#  Licensed to the Apache Software Foundation (ASF) under one
+#  or more contributor license agreements.  See the NOTICE file
+#  distributed with this work for additional information
+#  regarding copyright ownership.  The ASF licenses this file
+#  to you under the Apache License, Version 2.0 (the
+#  "License"); you may not use this file except in compliance
+#  with the License.  You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+#  Unless required by applicable law or agreed to in writing, software
+#  distributed under the License is distributed on an "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#  See the License for the specific language governing permissions and
+#  limitations under the License.
+
+import os
+Test.Summary = '''
+Test the output formats of the stats_over_http plugin
+'''
+# need Curl
+Test.SkipUnless(
+    Condition.HasProgram("curl", "Curl need to be installed on system for this test to work")
+)
+Test.ContinueOnFail = True
+# Define default ATS
+ts = Test.MakeATSProcess("ts")
+
+ts.Disk.plugin_config.AddLine('stats_over_http.so _stats')
+# Registers plugin.collide.a.b_c, plugin.collide.a_b.c and plugin.collide.a_b_c
+Test.prepare_plugin(os.path.join(Test.TestDirectory, 'collide_stats.c'), ts)
+ts.Setup.CopyAs('decode_protobuf.py', Test.RunDirectory)
+
+stats = 'curl --silent --proxy 127.0.0.1:{0} "http://127.0.0.1:{0}/_stats?prefix=plugin.collide.{{0}}"'.format(ts.Variables.port)
+
+# JSON, with the X-Stats-Generation header
+tr = Test.AddTestRun()
+tr.Processes.Default.Command = stats.format('').replace('--silent', '--silent --include')
+tr.Processes.Default.ReturnCode = 0
+tr.Processes.Default.StartBefore(Test.Processes.ts)
+tr.Processes.Default.Streams.stdout = "gold/json.gold"
+tr.StillRunningAfter = ts
+
+# Prometheus text, the colliding names get a suffix in registration order
+tr = Test.AddTestRun()
+tr.Processes.Default.Command = stats.format('&format=prometheus')
+tr.Processes.Default.ReturnCode = 0
+tr.Processes.Default.Streams.stdout = "gold/prometheus.gold"
+tr.StillRunningAfter = ts
+
+# Prometheus protobuf
+tr = Test.AddTestRun()
+tr.Processes.Default.Command = stats.format('&format=protobuf') + ' | python3 {0}/decode_protobuf.py'.format(Test.RunDirectory)
+tr.Processes.Default.ReturnCode = 0
+tr.Processes.Default.Streams.stdout = "gold/protobuf.gold"
+tr.StillRunningAfter = ts
+
+# A generation from before a restart, or from another server, returns everything
+tr = Test.AddTestRun()
+tr.Processes.Default.Command = stats.format('&format=prometheus&since=99999999999999999')
+tr.Processes.Default.ReturnCode = 0
+tr.Processes.Default.Streams.stdout = "gold/prometheus.gold"
+tr.StillRunningAfter = ts